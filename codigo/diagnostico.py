@@ -0,0 +1,39 @@
+"""Envia um comando de diagnóstico ao tabuleiro e imprime a resposta JSON.
+
+Uso:
+    python diagnostico.py COM5 rastro > rastro.json       (Bluetooth ou serial USB)
+    python diagnostico.py socket://localhost:5000 rastro   (simulador com --canal tcp:5000)
+
+O arquivo do comando "rastro" abre em chrome://tracing ou em https://ui.perfetto.dev.
+Feche o main.py antes: a porta só pode ser aberta por um programa de cada vez.
+"""
+import sys
+import serial
+
+TEMPO_LIMITE_S = 10
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__, file=sys.stderr)
+        return 1
+
+    porta, comando = sys.argv[1], sys.argv[2]
+
+    with serial.serial_for_url(porta, 9600, timeout=TEMPO_LIMITE_S) as conexao:
+        conexao.reset_input_buffer()
+        conexao.write(f'?{comando}\n'.encode())
+
+        #Mensagens de lance que chegarem antes da resposta são ignoradas
+        while True:
+            linha = conexao.readline().decode(errors='ignore').strip()
+            if not linha:
+                print('sem resposta do tabuleiro', file=sys.stderr)
+                return 1
+            if linha.startswith('{'):
+                print(linha)
+                return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,49 @@
+"""Gera src/pagina_web.h com a página ao vivo (assets/pagina/index.html) já comprimida, para o painel do firmware.
+
+Uso:
+    python pagina_web.py
+
+O arquivo gerado guarda a resposta HTTP inteira (cabeçalho e corpo em gzip) num vetor const, que fica na flash: o
+painel a envia como está, sem cópia nem compressão no ESP32. Rode de novo depois de mudar a página e faça o commit do
+pagina_web.h junto.
+"""
+import gzip
+import os
+
+PASTA = os.path.dirname(os.path.abspath(__file__))
+ORIGEM = os.path.join(PASTA, 'assets', 'pagina', 'index.html')
+DESTINO = os.path.join(PASTA, 'src', 'pagina_web.h')
+BYTES_POR_LINHA = 20
+
+
+def main():
+    with open(ORIGEM, 'rb') as arquivo:
+        pagina = arquivo.read()
+
+    corpo = gzip.compress(pagina, compresslevel=9, mtime=0)  #mtime=0: a mesma página gera o mesmo arquivo
+    cabecalho = ('HTTP/1.1 200 OK\r\n'
+                 'Content-Type: text/html; charset=utf-8\r\n'
+                 'Content-Encoding: gzip\r\n'
+                 f'Content-Length: {len(corpo)}\r\n'
+                 'Cache-Control: no-cache\r\n'
+                 'Connection: close\r\n'
+                 '\r\n').encode()
+    resposta = cabecalho + corpo
+
+    linhas = [', '.join(f'0x{b:02x}' for b in resposta[i:i + BYTES_POR_LINHA]) for i in range(0, len(resposta), BYTES_POR_LINHA)]
+
+    with open(DESTINO, 'w', newline='\n') as arquivo:
+        arquivo.write('//Gerado por pagina_web.py a partir de assets/pagina/index.html; não edite à mão\n')
+        arquivo.write(f'//Resposta HTTP completa: {len(cabecalho)} bytes de cabeçalho e {len(corpo)} de corpo em gzip '
+                      f'({len(pagina)} sem compressão)\n')
+        arquivo.write('#pragma once\n\n#include <stdint.h>\n#include <stddef.h>\n\n')
+        arquivo.write('static const uint8_t resposta_pagina[] = {\n')
+        arquivo.write(',\n'.join('  ' + linha for linha in linhas))
+        arquivo.write('\n};\n\n')
+        arquivo.write('static const size_t tamanho_resposta_pagina = sizeof(resposta_pagina);\n')
+
+    print(f'{DESTINO}: {len(resposta)} bytes ({len(pagina)} da página, {len(corpo)} em gzip)')
+
+
+if __name__ == '__main__':
+    main()
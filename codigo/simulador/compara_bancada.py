@@ -0,0 +1,54 @@
+"""Compara dois resultados do microbenchmark (tix_bancada ou ambiente "bancada" no ESP32).
+
+Uso: python compara_bancada.py antes.json depois.json
+
+Os arquivos podem ser a saída completa da serial: o primeiro objeto JSON encontrado é usado.
+"""
+import json
+import sys
+
+
+def carrega(caminho):
+    with open(caminho, encoding='utf-8', errors='ignore') as arquivo:
+        texto = arquivo.read()
+    inicio = texto.index('{"versao"')
+    resultado, _ = json.JSONDecoder().raw_decode(texto[inicio:])
+    return resultado
+
+
+def variacao(antes, depois):
+    if antes == 0:
+        return '   n/a'
+    return f'{(depois - antes) * 100 / antes:+6.1f}%'
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+
+    antes = carrega(sys.argv[1])
+    depois = carrega(sys.argv[2])
+
+    if antes['alvo'] != depois['alvo']:
+        print(f"Aviso: alvos diferentes ({antes['alvo']} x {depois['alvo']})")
+
+    print(f"{'funcao':<26}{'mediana ciclos':>28}{'p99 us':>28}{'alocacoes':>16}")
+    print(f"{'':<26}{antes['versao'] + ' -> ' + depois['versao']:>28}")
+
+    funcoes_depois = {funcao['nome']: funcao for funcao in depois['funcoes']}
+    for funcao in antes['funcoes']:
+        nova = funcoes_depois.get(funcao['nome'])
+        if nova is None:
+            continue
+        if 'erro' in funcao or 'erro' in nova:
+            print(f"{funcao['nome']:<26}erro: {funcao.get('erro', nova.get('erro'))}")
+            continue
+        ciclos = f"{funcao['ciclos']['mediana']} -> {nova['ciclos']['mediana']} {variacao(funcao['ciclos']['mediana'], nova['ciclos']['mediana'])}"
+        us = f"{funcao['us']['p99']} -> {nova['us']['p99']} {variacao(funcao['us']['p99'], nova['us']['p99'])}"
+        alocacoes = f"{funcao['alocacoes_por_chamada']:.2f} -> {nova['alocacoes_por_chamada']:.2f}"
+        print(f"{funcao['nome']:<26}{ciclos:>28}{us:>28}{alocacoes:>16}")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,492 @@
+//Harness de fuzz determinístico para a máquina de estados do loop() (menus, partida e cronômetro)
+//
+//Cada passo sorteia o estado dos botões, movimentos e leituras espúrias nas casas e a resposta do host
+//a cada mensagem enviada, executa uma iteração do loop() e confere as invariantes abaixo. A mesma semente
+//reproduz exatamente a mesma sequência, então uma falha é reproduzida com "--semente S --passos N".
+//
+//Uso:
+//  tix_fuzz [--semente S] [--sementes K] [--passos N] [--protocolo-livre] [--rastro] [--minimo-passos-s V]
+//
+//  --sementes K        Executa as sementes S..S+K-1, cada uma em um processo novo (estado global limpo)
+//  --protocolo-livre   Também envia respostas sem o enquadramento "[...]" e deixa de responder às vezes,
+//                      situações em que o AguardaMensagem() atual fica bloqueado indefinidamente
+//  --rastro            Mostra as entradas de cada passo (use junto com a semente que falhou)
+//  --minimo-passos-s V Também falha se a vazão total ficar abaixo de V passos por segundo (ctest: TIX_FUZZ_MINIMO_PASSOS_S)
+//
+//Invariantes verificadas após cada passo:
+//  - opcao_selecionada é um estado tratado pelo switch do loop() e posicao_seta está dentro das linhas do menu,
+//    com a seta desenhada no LCD na mesma linha
+//  - turno só muda em uma iteração em que o jogador da vez apertou o relógio (ou quando a partida é reiniciada,
+//    com o lance automático ligado ou com os acordes de desfazer e refazer)
+//    e a seta do LCD aponta para o jogador da vez
+//  - millis() nunca volta, os tempos restantes nunca passam do tempo configurado e, fora dos acordes de desfazer e
+//    refazer, nunca aumentam durante a partida e diminuem no máximo um segundo por segundo decorrido
+//  - o loop() não faz nenhuma alocação dinâmica de memória (todas as estruturas são reservadas antes do setup())
+#include "hal_sim.h"
+#include "alocacoes.h"
+#include "automatico.h"
+#include "menus.h"
+
+#include <Arduino.h>
+
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+
+void setup();
+void loop();
+
+//Estado interno do firmware observado pelas invariantes
+extern bool turno;
+extern bool primeiro_loop;
+extern unsigned int opcao_selecionada;
+extern unsigned int posicao_seta;
+extern unsigned int tempo_configurado;
+extern unsigned int tempo_restante_pretas;
+extern unsigned int tempo_restante_brancas;
+
+//Valores do switch do loop() em main.cpp
+#define ESTADO_MENU_INICIAL 100
+#define ESTADO_JOGADOR_VS_JOGADOR 0
+#define ESTADO_INICIAR_JOGADOR_VS_JOGADOR 10
+#define ESTADO_MENU_CONFIGURAR_TEMPO 11
+#define ESTADO_ALTERNAR_LANCE_AUTOMATICO 12
+#define ESTADO_VOLTAR_JOGADOR_VS_JOGADOR 13
+#define ESTADO_CONTINUAR 30
+#define ESTADO_ENCERRAR_PARTIDA 31
+#define ESTADO_CONFIGURAR_TEMPO 40
+#define ESTADO_VOLTAR_CONFIGURAR_TEMPO 41
+#define ESTADO_JOGAR_NOVAMENTE 52
+#define ESTADO_VOLTAR_FIM_PARTIDA 53
+#define ESTADO_MENU_PAUSE 200
+#define ESTADO_MENU_FIM_PARTIDA 300
+#define ESTADO_MENU_DIAGNOSTICO 400
+#define ESTADO_MENU_CALIBRACAO 500
+#define ESTADO_MENU_CONFERE_TABULEIRO 600
+
+//Os valores são escritos à mão para a invariante não depender do que ela confere; uma renumeração dos menus quebra a
+//compilação aqui, em vez de deixar o fuzz conferindo estados que não existem mais
+static_assert(ESTADO_MENU_INICIAL == MENU_INICIAL && ESTADO_JOGADOR_VS_JOGADOR == JOGADOR_VS_JOGADOR &&
+              ESTADO_INICIAR_JOGADOR_VS_JOGADOR == INICIAR_JOGADOR_VS_JOGADOR &&
+              ESTADO_MENU_CONFIGURAR_TEMPO == MENU_CONFIGURAR_TEMPO &&
+              ESTADO_ALTERNAR_LANCE_AUTOMATICO == ALTERNAR_LANCE_AUTOMATICO &&
+              ESTADO_VOLTAR_JOGADOR_VS_JOGADOR == LINHA_VOLTAR_JOGADOR_VS_JOGADOR + 10 && ESTADO_CONTINUAR == CONTINUAR &&
+              ESTADO_ENCERRAR_PARTIDA == LINHA_ENCERRAR_PARTIDA + 30 && ESTADO_CONFIGURAR_TEMPO == CONFIGURAR_TEMPO &&
+              ESTADO_VOLTAR_CONFIGURAR_TEMPO == VOLTAR_CONFIGURAR_TEMPO && ESTADO_JOGAR_NOVAMENTE == JOGAR_NOVAMENTE &&
+              ESTADO_VOLTAR_FIM_PARTIDA == LINHA_VOLTAR_FIM_PARTIDA + 50 && ESTADO_MENU_PAUSE == MENU_PAUSE &&
+              ESTADO_MENU_FIM_PARTIDA == MENU_FIM_PARTIDA && ESTADO_MENU_DIAGNOSTICO == MENU_DIAGNOSTICO &&
+              ESTADO_MENU_CALIBRACAO == MENU_CALIBRACAO && ESTADO_MENU_CONFERE_TABULEIRO == MENU_CONFERE_TABULEIRO,
+              "Estados do fuzz diferentes dos menus do firmware (menus.h)");
+
+#define PINO_BOTAO_ESQUERDA 15
+#define PINO_BOTAO_CENTRO 4
+#define PINO_BOTAO_DIREITA 5
+
+#define BOTAO_ESQUERDA 1
+#define BOTAO_CENTRO 2
+#define BOTAO_DIREITA 4
+
+static const uint8_t pinos_casas[8] = {34, 35, 32, 33, 25, 26, 27, 14};
+static const uint16_t leituras_pecas[7] = {4095, 1980, 2880, 3380, 0, 511, 1424};
+
+struct Aleatorio
+{
+  uint64_t estado;
+
+  uint64_t Proximo()
+  {
+    uint64_t z = (estado += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  uint32_t Ate(uint32_t limite)
+  {
+    return (uint32_t)(((Proximo() >> 32) * limite) >> 32);
+  }
+
+  bool Chance(uint32_t porcentagem)
+  {
+    return Ate(100) < porcentagem;
+  }
+};
+
+static Aleatorio aleatorio;
+static uint64_t passos_em_partida = 0;
+static uint64_t mensagens_ao_host = 0;
+static uint64_t trocas_de_turno = 0;
+static bool protocolo_livre = false;
+static bool rastro = false;
+static uint64_t passo_atual = 0;
+
+static const char *respostas_enquadradas[] = {"[1, 0]", "[1, 0]", "[1, 0]", "[1, 0]", "[0, 0]", "[0, 0]", "[1, 1]", "[1, 2]", "[1, 3]", "[1]", "[]", "[0, 3]", "[1, 9]"};
+static const char *respostas_livres[] = {"1, 0]", "lixo", "[1, 0", "\r\n", ""};
+
+static void Responde(const std::string &linha)
+{
+  std::string resposta;
+  mensagens_ao_host++;
+
+  if(protocolo_livre && aleatorio.Chance(15))
+    resposta = respostas_livres[aleatorio.Ate(sizeof(respostas_livres) / sizeof(respostas_livres[0]))];
+  else if(aleatorio.Chance(10))
+  {
+    //Resposta enquadrada com conteúdo arbitrário
+    resposta = "[";
+    for(uint32_t i = 0, tamanho = aleatorio.Ate(8); i < tamanho; i++)
+      resposta += (char)(' ' + aleatorio.Ate(94));
+    resposta += "]";
+  }
+  else
+    resposta = respostas_enquadradas[aleatorio.Ate(sizeof(respostas_enquadradas) / sizeof(respostas_enquadradas[0]))];
+
+  if(rastro)
+    printf("  passo %llu: host recebeu \"%s\" e respondeu \"%s\"\n", (unsigned long long)passo_atual, linha.c_str(), resposta.c_str());
+
+  SimEnviaAoFirmware(resposta);
+}
+
+static bool EstadoDePartida(unsigned int estado)
+{
+  return estado == ESTADO_INICIAR_JOGADOR_VS_JOGADOR || estado == ESTADO_CONTINUAR || estado == ESTADO_JOGAR_NOVAMENTE;
+}
+
+//Linhas válidas para a seta em cada menu, devolve false para estados sem seta de navegação
+static bool LinhasDoMenu(unsigned int estado, unsigned int &primeira, unsigned int &ultima)
+{
+  switch(estado)
+  {
+    case ESTADO_JOGADOR_VS_JOGADOR:
+    case ESTADO_VOLTAR_CONFIGURAR_TEMPO:
+      primeira = 0;
+      ultima = 3;
+      return true;
+
+    case ESTADO_MENU_PAUSE:
+    case ESTADO_MENU_CONFIGURAR_TEMPO:
+      primeira = 0;
+      ultima = 1;
+      return true;
+
+    case ESTADO_MENU_FIM_PARTIDA:
+      primeira = 2;
+      ultima = 3;
+      return true;
+
+    case ESTADO_MENU_INICIAL:
+    case ESTADO_VOLTAR_JOGADOR_VS_JOGADOR:
+    case ESTADO_ENCERRAR_PARTIDA:
+    case ESTADO_VOLTAR_FIM_PARTIDA:
+      primeira = 0;
+      ultima = 0;
+      return true;
+  }
+
+  return false;
+}
+
+static bool EstadoValido(unsigned int estado)
+{
+  unsigned int primeira, ultima;
+  return LinhasDoMenu(estado, primeira, ultima) || EstadoDePartida(estado) || estado == ESTADO_CONFIGURAR_TEMPO ||
+         estado == ESTADO_MENU_DIAGNOSTICO || estado == ESTADO_MENU_CALIBRACAO || estado == ESTADO_ALTERNAR_LANCE_AUTOMATICO ||
+         estado == ESTADO_MENU_CONFERE_TABULEIRO;
+}
+
+struct Observacao
+{
+  unsigned long tempo_ms;
+  unsigned int estado;
+  bool turno;
+  unsigned int tempo_brancas;
+  unsigned int tempo_pretas;
+};
+
+static Observacao Observa()
+{
+  return {millis(), opcao_selecionada, turno, tempo_restante_brancas, tempo_restante_pretas};
+}
+
+static int Falha(uint64_t semente, const char *descricao)
+{
+  printf("FALHA semente %llu passo %llu: %s\n", (unsigned long long)semente, (unsigned long long)passo_atual, descricao);
+  printf("  opcao_selecionada=%u posicao_seta=%u primeiro_loop=%d turno=%d tempo_configurado=%u brancas=%u pretas=%u millis=%lu\n",
+         opcao_selecionada, posicao_seta, primeiro_loop, turno, tempo_configurado, tempo_restante_brancas, tempo_restante_pretas, millis());
+  for(unsigned int linha = 0; linha < LCD_LINHAS; linha++)
+    printf("  |%s|\n", SimLcdLinha(linha).c_str());
+  printf("  reproduzir: tix_fuzz --semente %llu --passos %llu --rastro%s\n", (unsigned long long)semente, (unsigned long long)passo_atual + 1, protocolo_livre ? " --protocolo-livre" : "");
+  return 1;
+}
+
+static int ConfereInvariantes(uint64_t semente, const Observacao &antes, const Observacao &depois, unsigned int botoes)
+{
+  char descricao[160];
+
+  if(!EstadoValido(depois.estado))
+  {
+    snprintf(descricao, sizeof(descricao), "opcao_selecionada = %u não é tratada pelo loop()", depois.estado);
+    return Falha(semente, descricao);
+  }
+
+  unsigned int primeira, ultima;
+  if(!primeiro_loop && LinhasDoMenu(depois.estado, primeira, ultima) && depois.estado != ESTADO_MENU_INICIAL)
+  {
+    if(posicao_seta < primeira || posicao_seta > ultima)
+      return Falha(semente, "posicao_seta fora das linhas do menu");
+
+    if(SimLcdCaractere(0, posicao_seta) != '>')
+      return Falha(semente, "seta do menu não está desenhada na linha de posicao_seta");
+  }
+
+  if(depois.tempo_ms < antes.tempo_ms)
+    return Falha(semente, "millis() voltou no tempo");
+
+  bool mesma_partida = (EstadoDePartida(antes.estado) || antes.estado == ESTADO_MENU_PAUSE) &&
+                       (EstadoDePartida(depois.estado) || depois.estado == ESTADO_MENU_PAUSE);
+
+  if(mesma_partida)
+  {
+    unsigned long segundos_decorridos = (depois.tempo_ms - antes.tempo_ms) / 1000 + 1;
+    bool acorde = botoes == (BOTAO_ESQUERDA | BOTAO_DIREITA) || botoes == (BOTAO_CENTRO | BOTAO_DIREITA); //Desfazer e refazer restauram os relógios
+
+    if(!acorde && (depois.tempo_brancas > antes.tempo_brancas || depois.tempo_pretas > antes.tempo_pretas))
+      return Falha(semente, "tempo restante aumentou durante a partida");
+
+    if(!acorde && (antes.tempo_brancas - depois.tempo_brancas > segundos_decorridos || antes.tempo_pretas - depois.tempo_pretas > segundos_decorridos))
+      return Falha(semente, "tempo restante diminuiu mais do que o tempo decorrido");
+
+    if(depois.tempo_brancas > tempo_configurado || depois.tempo_pretas > tempo_configurado)
+      return Falha(semente, "tempo restante maior que o tempo configurado");
+
+    bool apertou_relogio = (antes.turno && (botoes & BOTAO_DIREITA)) || (!antes.turno && (botoes & BOTAO_ESQUERDA));
+    if(depois.turno != antes.turno && !apertou_relogio && !acorde && JanelaLanceAutomatico() == 0)
+      return Falha(semente, "turno mudou sem o jogador da vez apertar o relógio");
+  }
+
+  if(EstadoDePartida(depois.estado) && !primeiro_loop)
+  {
+    char seta_brancas = SimLcdCaractere(10, 1);
+    char seta_pretas = SimLcdCaractere(9, 1);
+
+    if(depois.turno && (seta_brancas != '>' || seta_pretas == '<'))
+      return Falha(semente, "LCD não indica a vez das brancas");
+    if(!depois.turno && (seta_pretas != '<' || seta_brancas == '>'))
+      return Falha(semente, "LCD não indica a vez das pretas");
+  }
+
+  return 0;
+}
+
+//Tabuleiro físico simulado: índices em leituras_pecas (0 = vazio), na ordem inicial RB CB TB V V TP CP RP
+static const uint8_t posicao_inicial[8] = {6, 5, 4, 0, 0, 2, 3, 1};
+static uint8_t tabuleiro[8];
+static uint8_t tabuleiro_aceito[8]; //Posição na última troca de turno observada
+static int casa_com_interferencia = -1;
+
+static void AplicaTabuleiro()
+{
+  for(int i = 0; i < 8; i++)
+    SimDefineAnalogico(pinos_casas[i], leituras_pecas[tabuleiro[i]]);
+}
+
+static void SorteiaEntradas(unsigned int &botoes)
+{
+  //Na maior parte dos passos nenhum botão é acionado, como acontece durante a reflexão dos jogadores
+  botoes = aleatorio.Chance(55) ? 0 : 1 + aleatorio.Ate(7);
+
+  if(aleatorio.Chance(80) && (botoes & (botoes - 1))) //Combinações de botões são raras
+    botoes = 1u << aleatorio.Ate(3);
+
+  if(EstadoDePartida(opcao_selecionada) && botoes && aleatorio.Chance(50)) //Durante a partida o relógio é o botão mais usado
+    botoes = turno ? BOTAO_DIREITA : BOTAO_ESQUERDA;
+
+  SimDefineDigital(PINO_BOTAO_ESQUERDA, botoes & BOTAO_ESQUERDA ? LOW : HIGH);
+  SimDefineDigital(PINO_BOTAO_CENTRO, botoes & BOTAO_CENTRO ? LOW : HIGH);
+  SimDefineDigital(PINO_BOTAO_DIREITA, botoes & BOTAO_DIREITA ? LOW : HIGH);
+
+  if(casa_com_interferencia >= 0) //A interferência do passo anterior dura uma leitura só
+  {
+    SimDefineAnalogico(pinos_casas[casa_com_interferencia], leituras_pecas[tabuleiro[casa_com_interferencia]]);
+    casa_com_interferencia = -1;
+  }
+
+  if(aleatorio.Chance(25))
+  {
+    //Move uma peça para outra casa, capturando o que estiver nela
+    uint32_t origem = aleatorio.Ate(8);
+    uint32_t destino = aleatorio.Ate(8);
+
+    if(tabuleiro[origem] != 0 && origem != destino)
+    {
+      tabuleiro[destino] = tabuleiro[origem];
+      tabuleiro[origem] = 0;
+      AplicaTabuleiro();
+
+      if(rastro)
+        printf("  passo %llu: peça da casa %u para a casa %u\n", (unsigned long long)passo_atual, origem, destino);
+    }
+  }
+  else if(aleatorio.Chance(10))
+  {
+    //O jogador desfaz o que mexeu desde o último lance aceito
+    memcpy(tabuleiro, tabuleiro_aceito, sizeof(tabuleiro));
+    AplicaTabuleiro();
+  }
+  else if(aleatorio.Chance(5))
+  {
+    //Leitura espúria em uma casa (peça mal encaixada, mão sobre a casa)
+    casa_com_interferencia = aleatorio.Ate(8);
+    uint16_t leitura = aleatorio.Chance(50) ? leituras_pecas[aleatorio.Ate(7)] : aleatorio.Ate(4096);
+    SimDefineAnalogico(pinos_casas[casa_com_interferencia], leitura);
+
+    if(rastro)
+      printf("  passo %llu: interferência na casa %d = %u\n", (unsigned long long)passo_atual, casa_com_interferencia, leitura);
+  }
+
+  if(aleatorio.Chance(1))
+    SimDefineClienteConectado(aleatorio.Chance(80));
+
+  if(rastro && botoes)
+    printf("  passo %llu: botões%s%s%s\n", (unsigned long long)passo_atual, botoes & BOTAO_ESQUERDA ? " esquerda" : "",
+           botoes & BOTAO_CENTRO ? " centro" : "", botoes & BOTAO_DIREITA ? " direita" : "");
+}
+
+//Acompanha a partida para que o tabuleiro simulado volte à posição inicial quando uma nova partida começa
+static void AcompanhaPartida(const Observacao &antes)
+{
+  if(EstadoDePartida(opcao_selecionada) && !EstadoDePartida(antes.estado) && antes.estado != ESTADO_MENU_PAUSE && aleatorio.Chance(90))
+  {
+    memcpy(tabuleiro, posicao_inicial, sizeof(tabuleiro));
+    memcpy(tabuleiro_aceito, posicao_inicial, sizeof(tabuleiro));
+    AplicaTabuleiro();
+  }
+  else if(turno != antes.turno)
+    memcpy(tabuleiro_aceito, tabuleiro, sizeof(tabuleiro));
+}
+
+static int ExecutaSemente(uint64_t semente, uint64_t passos)
+{
+  aleatorio.estado = semente;
+
+  SimDefineRuidoAnalogico(aleatorio.Ate(120), semente);
+  SimDefineResponder(Responde);
+  SimDefineLimiteBloqueio(60 * 1000000ull);
+
+  memcpy(tabuleiro, posicao_inicial, sizeof(tabuleiro));
+  memcpy(tabuleiro_aceito, posicao_inicial, sizeof(tabuleiro));
+  AplicaTabuleiro();
+
+  try
+  {
+    setup();
+
+    for(passo_atual = 0; passo_atual < passos; passo_atual++)
+    {
+      unsigned int botoes;
+      SorteiaEntradas(botoes);
+
+      Observacao antes = Observa();
+      uint32_t alocacoes_antes = QuantidadeAlocacoes();
+      loop();
+
+      if(ConfereInvariantes(semente, antes, Observa(), botoes))
+        return 1;
+
+      if(QuantidadeAlocacoes() != alocacoes_antes)
+      {
+        char descricao[80];
+        snprintf(descricao, sizeof(descricao), "loop() fez %u alocações dinâmicas de memória", QuantidadeAlocacoes() - alocacoes_antes);
+        return Falha(semente, descricao);
+      }
+
+      passos_em_partida += EstadoDePartida(opcao_selecionada);
+      trocas_de_turno += antes.turno != turno;
+      AcompanhaPartida(antes);
+    }
+  }
+  catch(const SimTravado &travado)
+  {
+    char descricao[120];
+    snprintf(descricao, sizeof(descricao), "loop() bloqueado há %.0f s aguardando resposta do host", travado.tempo_us / 1e6);
+    return Falha(semente, descricao);
+  }
+
+  printf("semente %llu: %llu passos em partida, %llu mensagens ao host, %llu trocas de turno, %.0f s virtuais\n",
+         (unsigned long long)semente, (unsigned long long)passos_em_partida, (unsigned long long)mensagens_ao_host,
+         (unsigned long long)trocas_de_turno, SimTempoUs() / 1e6);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t semente = 1;
+  uint64_t sementes = 1;
+  uint64_t passos = 1000000;
+  double minimo_passos_s = 0;
+
+  for(int i = 1; i < argc; i++)
+  {
+    if(strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+      semente = strtoull(argv[++i], nullptr, 10);
+    else if(strcmp(argv[i], "--sementes") == 0 && i + 1 < argc)
+      sementes = strtoull(argv[++i], nullptr, 10);
+    else if(strcmp(argv[i], "--passos") == 0 && i + 1 < argc)
+      passos = strtoull(argv[++i], nullptr, 10);
+    else if(strcmp(argv[i], "--protocolo-livre") == 0)
+      protocolo_livre = true;
+    else if(strcmp(argv[i], "--rastro") == 0)
+      rastro = true;
+    else if(strcmp(argv[i], "--minimo-passos-s") == 0 && i + 1 < argc)
+      minimo_passos_s = strtod(argv[++i], nullptr);
+    else
+    {
+      fprintf(stderr, "uso: %s [--semente S] [--sementes K] [--passos N] [--protocolo-livre] [--rastro] [--minimo-passos-s V]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  auto inicio = std::chrono::steady_clock::now();
+  uint64_t falhas = 0;
+
+  for(uint64_t s = semente; s < semente + sementes; s++)
+  {
+    fflush(stdout);
+
+    //Cada semente roda em um processo filho para começar com as variáveis globais do firmware recém-inicializadas
+    pid_t filho = fork();
+    if(filho == 0)
+    {
+      int codigo = ExecutaSemente(s, passos);
+      fflush(stdout);
+      _exit(codigo);
+    }
+
+    int situacao;
+    waitpid(filho, &situacao, 0);
+
+    if(!WIFEXITED(situacao) || WEXITSTATUS(situacao) != 0)
+    {
+      if(!WIFEXITED(situacao))
+        printf("FALHA semente %llu: processo terminou com o sinal %d\n", (unsigned long long)s, WTERMSIG(situacao));
+      falhas++;
+    }
+  }
+
+  double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  double passos_s = sementes * passos / segundos;
+  printf("sementes: %llu, passos por semente: %llu, falhas: %llu, %.0f passos/s\n",
+         (unsigned long long)sementes, (unsigned long long)passos, (unsigned long long)falhas, passos_s);
+
+  if(passos_s < minimo_passos_s)
+  {
+    printf("FALHA vazão: %.0f passos/s, abaixo do mínimo de %.0f\n", passos_s, minimo_passos_s);
+    return 1;
+  }
+
+  return falhas ? 1 : 0;
+}
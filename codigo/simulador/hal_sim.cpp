@@ -0,0 +1,1207 @@
+//Implementação do hardware virtual usado pelos substitutos de shims/
+#include "hal_sim.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Preferences.h>
+#include <BluetoothSerial.h>
+#include <WiFi.h>
+#include <LiquidCrystal_I2C.h>
+
+#include <map>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <cstdarg>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define QUANTIDADE_PINOS 64
+#define TAMANHO_FIFO_UART 128 //FIFO de transmissão do UART do ESP32
+
+HardwareSerial Serial;
+TwoWire Wire;
+EspClass ESP;
+WiFiClass WiFi;
+
+//---------------------------------------------------------------- Relógio virtual
+
+static uint64_t tempo_us = 0;
+static double velocidade = 0;
+static double atraso_real_pendente_us = 0;
+static uint64_t limite_bloqueio_us = 0;
+static uint64_t inicio_bloqueio_us = 0;
+static uint64_t fim_ultima_espera_us = 0;
+static bool bloqueado = false;
+
+uint64_t SimTempoUs()
+{
+  return tempo_us;
+}
+
+void SimAvancaTempo(uint64_t avanco_us)
+{
+  tempo_us += avanco_us;
+
+  if(velocidade > 0)
+  {
+    atraso_real_pendente_us += avanco_us / velocidade;
+
+    if(atraso_real_pendente_us >= 1000) //Dorme em blocos para não pagar uma chamada de sistema a cada microssegundo virtual
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)atraso_real_pendente_us));
+      atraso_real_pendente_us = 0;
+    }
+  }
+}
+
+void SimDefineVelocidade(double nova_velocidade)
+{
+  velocidade = nova_velocidade;
+}
+
+void SimDefineLimiteBloqueio(uint64_t novo_limite_us)
+{
+  limite_bloqueio_us = novo_limite_us;
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(uint32_t)(tempo_us / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)(uint32_t)tempo_us;
+}
+
+void delay(uint32_t tempo_ms)
+{
+  SimAvancaTempo((uint64_t)tempo_ms * 1000);
+}
+
+void delayMicroseconds(uint32_t atraso_us)
+{
+  SimAvancaTempo(atraso_us);
+}
+
+uint32_t EspClass::getCycleCount()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//O heap do computador não tem relação com o do ESP32, então o simulador informa a memória de um ESP32 ocioso
+static uint32_t heap_livre = 300 * 1024;
+static uint32_t heap_maior_bloco = 110 * 1024;
+
+void SimDefineHeap(uint32_t livre, uint32_t maior_bloco)
+{
+  heap_livre = livre;
+  heap_maior_bloco = maior_bloco;
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+  return heap_livre;
+}
+
+uint32_t EspClass::getHeapSize()
+{
+  return 320 * 1024;
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+  return 300 * 1024;
+}
+
+uint32_t EspClass::getMaxAllocHeap()
+{
+  return heap_maior_bloco;
+}
+
+void EspClass::restart()
+{
+  fprintf(stderr, "tix_sim: ESP.restart()\n");
+  exit(3);
+}
+
+//---------------------------------------------------------------- Pinos
+
+static uint16_t valores_analogicos[QUANTIDADE_PINOS];
+static int8_t niveis_digitais[QUANTIDADE_PINOS];
+static uint8_t modos_pinos[QUANTIDADE_PINOS];
+static uint16_t amplitude_ruido = 0;
+static uint64_t estado_ruido = 0x9E3779B97F4A7C15ull;
+static uint64_t quantidade_tons = 0;
+static uint64_t quantidade_leituras_analogicas = 0;
+
+static uint64_t ProximoAleatorioRuido()
+{
+  //xorshift64*: determinístico e independente da biblioteca padrão
+  estado_ruido ^= estado_ruido >> 12;
+  estado_ruido ^= estado_ruido << 25;
+  estado_ruido ^= estado_ruido >> 27;
+  return estado_ruido * 0x2545F4914F6CDD1Dull;
+}
+
+void SimDefineAnalogico(uint8_t pino, uint16_t valor)
+{
+  if(pino < QUANTIDADE_PINOS)
+    valores_analogicos[pino] = valor > 4095 ? 4095 : valor;
+}
+
+void SimDefineRuidoAnalogico(uint16_t amplitude, uint64_t semente)
+{
+  amplitude_ruido = amplitude;
+  estado_ruido = semente ? semente : 0x9E3779B97F4A7C15ull;
+}
+
+void SimDefineDigital(uint8_t pino, int nivel)
+{
+  if(pino < QUANTIDADE_PINOS)
+    niveis_digitais[pino] = nivel ? HIGH : LOW;
+}
+
+int SimLeSaidaDigital(uint8_t pino)
+{
+  return pino < QUANTIDADE_PINOS && niveis_digitais[pino] == HIGH ? HIGH : LOW;
+}
+
+uint64_t SimQuantidadeTons()
+{
+  return quantidade_tons;
+}
+
+uint64_t SimQuantidadeLeiturasAnalogicas()
+{
+  return quantidade_leituras_analogicas;
+}
+
+void pinMode(uint8_t pino, uint8_t modo)
+{
+  if(pino >= QUANTIDADE_PINOS)
+    return;
+
+  modos_pinos[pino] = modo;
+
+  if(modo == INPUT_PULLUP && niveis_digitais[pino] < 0)
+    niveis_digitais[pino] = HIGH;
+}
+
+void digitalWrite(uint8_t pino, uint8_t valor)
+{
+  if(pino < QUANTIDADE_PINOS)
+    niveis_digitais[pino] = valor ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pino)
+{
+  if(pino >= QUANTIDADE_PINOS)
+    return LOW;
+
+  if(niveis_digitais[pino] < 0) //Pino nunca escrito: resistor de pull-up se configurado, senão nível baixo
+    return modos_pinos[pino] == INPUT_PULLUP ? HIGH : LOW;
+
+  return niveis_digitais[pino];
+}
+
+uint16_t analogRead(uint8_t pino)
+{
+  quantidade_leituras_analogicas++;
+  SimAvancaTempo(CUSTO_ANALOGREAD_US);
+
+  if(pino >= QUANTIDADE_PINOS)
+    return 0;
+
+  int valor = valores_analogicos[pino];
+
+  if(amplitude_ruido > 0)
+  {
+    valor += (int)(ProximoAleatorioRuido() % (2 * amplitude_ruido + 1)) - amplitude_ruido;
+    valor = valor < 0 ? 0 : (valor > 4095 ? 4095 : valor);
+  }
+
+  return valor;
+}
+
+void tone(uint8_t pino, unsigned int frequencia, unsigned long duracao)
+{
+  quantidade_tons++;
+}
+
+void noTone(uint8_t pino)
+{
+}
+
+static struct InicializaPinos
+{
+  InicializaPinos()
+  {
+    for(int i = 0; i < QUANTIDADE_PINOS; i++)
+      niveis_digitais[i] = -1;
+  }
+} inicializa_pinos;
+
+//---------------------------------------------------------------- LCD (HD44780 20x4 atrás de um PCF8574)
+
+static const uint8_t deslocamento_linhas[LCD_LINHAS] = {0x00, 0x40, 0x14, 0x54};
+static uint8_t ddram[0x80];
+static uint8_t endereco_ddram = 0;
+static bool luz_de_fundo = false;
+static uint64_t bytes_lcd = 0;
+static char glifos[8] = {'*', '!', '>', '<', '^', 'T', 'I', 'X'};
+
+static void LimpaDdram()
+{
+  memset(ddram, ' ', sizeof(ddram));
+  endereco_ddram = 0;
+}
+
+std::string SimLcdLinha(unsigned int linha)
+{
+  std::string texto(LCD_COLUNAS, ' ');
+
+  for(unsigned int coluna = 0; coluna < LCD_COLUNAS && linha < LCD_LINHAS; coluna++)
+    texto[coluna] = SimLcdCaractere(coluna, linha);
+
+  return texto;
+}
+
+char SimLcdCaractere(unsigned int coluna, unsigned int linha)
+{
+  if(coluna >= LCD_COLUNAS || linha >= LCD_LINHAS)
+    return ' ';
+
+  uint8_t caractere = ddram[deslocamento_linhas[linha] + coluna];
+  return caractere < 8 ? glifos[caractere] : (char)caractere;
+}
+
+bool SimLcdLuzDeFundo()
+{
+  return luz_de_fundo;
+}
+
+void SimDefineGlifos(const char novos_glifos[8])
+{
+  memcpy(glifos, novos_glifos, sizeof(glifos));
+}
+
+uint64_t SimLcdBytesEnviados()
+{
+  return bytes_lcd;
+}
+
+void LiquidCrystal_I2C::init()
+{
+  LimpaDdram();
+  SimAvancaTempo(50000); //Sequência de inicialização em 4 bits
+}
+
+void LiquidCrystal_I2C::backlight()
+{
+  luz_de_fundo = true;
+}
+
+void LiquidCrystal_I2C::noBacklight()
+{
+  luz_de_fundo = false;
+}
+
+void LiquidCrystal_I2C::clear()
+{
+  LimpaDdram();
+  bytes_lcd++;
+  SimAvancaTempo(CUSTO_LCD_CLEAR_US);
+}
+
+void LiquidCrystal_I2C::home()
+{
+  endereco_ddram = 0;
+  bytes_lcd++;
+  SimAvancaTempo(CUSTO_LCD_CLEAR_US);
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t coluna, uint8_t linha)
+{
+  if(linha >= LCD_LINHAS)
+    linha = LCD_LINHAS - 1;
+
+  endereco_ddram = (deslocamento_linhas[linha] + coluna) & 0x7F;
+  bytes_lcd++;
+  SimAvancaTempo(CUSTO_LCD_BYTE_US);
+}
+
+void LiquidCrystal_I2C::createChar(uint8_t posicao, uint8_t mapa[])
+{
+  bytes_lcd += 9;
+  SimAvancaTempo(9 * CUSTO_LCD_BYTE_US);
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t caractere)
+{
+  ddram[endereco_ddram] = caractere;
+
+  //No modo de duas linhas a DDRAM vai de 0x00 a 0x27 e de 0x40 a 0x67
+  endereco_ddram++;
+  if(endereco_ddram == 0x28)
+    endereco_ddram = 0x40;
+  else if(endereco_ddram >= 0x68)
+    endereco_ddram = 0x00;
+
+  bytes_lcd++;
+  SimAvancaTempo(CUSTO_LCD_BYTE_US);
+  return 1;
+}
+
+//---------------------------------------------------------------- Alocações do simulador
+
+static unsigned int profundidade_ignora_alocacoes = 0;
+
+SimIgnoraAlocacoes::SimIgnoraAlocacoes()
+{
+  profundidade_ignora_alocacoes++;
+}
+
+SimIgnoraAlocacoes::~SimIgnoraAlocacoes()
+{
+  profundidade_ignora_alocacoes--;
+}
+
+bool SimAlocacoesIgnoradas()
+{
+  return profundidade_ignora_alocacoes > 0;
+}
+
+//---------------------------------------------------------------- Serial USB de depuração
+
+static FILE *saida_depuracao = nullptr;
+static uint64_t bytes_depuracao = 0;
+static double ocupacao_fifo_uart = 0;
+static uint64_t tempo_fifo_uart_us = 0;
+static std::deque<char> entrada_serial_usb;
+static bool guarda_saida_depuracao = false; //Só depois da primeira entrada: as partidas longas não acumulam a saída
+static std::string saida_depuracao_guardada;
+
+void SimDefineSaidaDepuracao(FILE *saida)
+{
+  saida_depuracao = saida;
+}
+
+uint64_t SimBytesDepuracao()
+{
+  return bytes_depuracao;
+}
+
+void SimEnviaSerialUsb(const std::string &dados)
+{
+  entrada_serial_usb.insert(entrada_serial_usb.end(), dados.begin(), dados.end());
+  guarda_saida_depuracao = true;
+}
+
+std::string SimConsomeSaidaDepuracao()
+{
+  std::string saida;
+  saida.swap(saida_depuracao_guardada);
+  return saida;
+}
+
+int HardwareSerial::available()
+{
+  return entrada_serial_usb.size();
+}
+
+int HardwareSerial::read()
+{
+  if(entrada_serial_usb.empty())
+    return -1;
+
+  char caractere = entrada_serial_usb.front();
+  entrada_serial_usb.pop_front();
+  return (uint8_t)caractere;
+}
+
+int HardwareSerial::peek()
+{
+  return entrada_serial_usb.empty() ? -1 : (uint8_t)entrada_serial_usb.front();
+}
+
+void HardwareSerial::begin(unsigned long nova_taxa)
+{
+  taxa_transmissao = nova_taxa;
+}
+
+size_t HardwareSerial::write(uint8_t caractere)
+{
+  //Modela o FIFO do UART: a escrita só bloqueia quando o FIFO está cheio, drenando 10 bits por caractere
+  double tempo_caractere_us = 10e6 / taxa_transmissao;
+
+  ocupacao_fifo_uart -= (tempo_us - tempo_fifo_uart_us) / tempo_caractere_us;
+  if(ocupacao_fifo_uart < 0)
+    ocupacao_fifo_uart = 0;
+
+  if(ocupacao_fifo_uart >= TAMANHO_FIFO_UART)
+  {
+    double espera_us = (ocupacao_fifo_uart - TAMANHO_FIFO_UART + 1) * tempo_caractere_us;
+    SimAvancaTempo((uint64_t)espera_us + 1);
+    ocupacao_fifo_uart = TAMANHO_FIFO_UART - 1;
+  }
+
+  ocupacao_fifo_uart++;
+  tempo_fifo_uart_us = tempo_us;
+  bytes_depuracao++;
+
+  if(saida_depuracao)
+    fputc(caractere, saida_depuracao);
+  if(guarda_saida_depuracao)
+    saida_depuracao_guardada += (char)caractere;
+
+  return 1;
+}
+
+size_t Print::printf(const char *formato, ...)
+{
+  char buffer[256];
+  va_list argumentos;
+
+  va_start(argumentos, formato);
+  int tamanho = vsnprintf(buffer, sizeof(buffer), formato, argumentos);
+  va_end(argumentos);
+
+  if(tamanho < 0)
+    return 0;
+
+  return write((const uint8_t *)buffer, (size_t)tamanho < sizeof(buffer) ? tamanho : sizeof(buffer) - 1);
+}
+
+//---------------------------------------------------------------- Canal serial do host
+
+static int tipo_canal = CANAL_MEMORIA;
+static bool bluetooth_ativo = false;
+static bool wifi_ativo = false;
+static bool servidor_wifi_ativo = false;
+static int transporte_canal = SIM_TRANSPORTE_AUTOMATICO;
+static bool cliente_conectado = true;
+static std::string recebidos; //Dados do host ainda não lidos pelo firmware
+static size_t posicao_recebidos = 0;
+static std::string linha_enviada;
+static std::function<void(const std::string &)> responder;
+static int socket_servidor = -1;
+static int socket_cliente = -1;
+static esp_spp_cb_t callback_spp = nullptr;
+static bool conexao_notificada = false;
+static WiFiEventFuncCb callback_wifi = nullptr;
+static bool associacao_notificada = false;
+
+//Rádio pelo qual o host fala: o escolhido, ou o Bluetooth se ele estiver ligado
+static bool HostNoRadio(int transporte)
+{
+  int transporte_host = transporte_canal;
+  if(transporte_host == SIM_TRANSPORTE_AUTOMATICO)
+    transporte_host = bluetooth_ativo || !wifi_ativo ? SIM_TRANSPORTE_BLUETOOTH : SIM_TRANSPORTE_WIFI;
+
+  return transporte == transporte_host && (transporte == SIM_TRANSPORTE_BLUETOOTH ? bluetooth_ativo : wifi_ativo);
+}
+
+static bool EnlaceConectado()
+{
+  return tipo_canal == CANAL_TCP ? socket_cliente >= 0 : cliente_conectado;
+}
+
+//Gera ESP_SPP_SRV_OPEN_EVT / ESP_SPP_CLOSE_EVT quando a conexão do host muda, como a pilha Bluetooth do ESP32, e
+//os eventos de estação associada ou desassociada do ponto de acesso WiFi
+static void NotificaConexao()
+{
+  bool conectado = HostNoRadio(SIM_TRANSPORTE_BLUETOOTH) && EnlaceConectado();
+  bool associado = HostNoRadio(SIM_TRANSPORTE_WIFI) && EnlaceConectado();
+
+  if(conectado != conexao_notificada && callback_spp)
+  {
+    conexao_notificada = conectado;
+    esp_spp_cb_param_t parametro = {};
+    callback_spp(conectado ? ESP_SPP_SRV_OPEN_EVT : ESP_SPP_CLOSE_EVT, &parametro);
+  }
+
+  if(associado != associacao_notificada && callback_wifi)
+  {
+    associacao_notificada = associado;
+    WiFiEventInfo_t informacao = {};
+    callback_wifi(associado ? ARDUINO_EVENT_WIFI_AP_STACONNECTED : ARDUINO_EVENT_WIFI_AP_STADISCONNECTED, informacao);
+  }
+}
+
+//Servidor TCP sem bloqueio no loopback; o simulador termina se a porta já estiver em uso
+static int AbreServidorLocal(uint16_t porta, int fila)
+{
+  int servidor = socket(AF_INET, SOCK_STREAM, 0);
+
+  int reutilizar = 1;
+  setsockopt(servidor, SOL_SOCKET, SO_REUSEADDR, &reutilizar, sizeof(reutilizar));
+
+  sockaddr_in endereco = {};
+  endereco.sin_family = AF_INET;
+  endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  endereco.sin_port = htons(porta);
+
+  if(bind(servidor, (sockaddr *)&endereco, sizeof(endereco)) != 0 || listen(servidor, fila) != 0)
+  {
+    perror("tix_sim: servidor TCP");
+    exit(1);
+  }
+
+  fcntl(servidor, F_SETFL, O_NONBLOCK);
+  return servidor;
+}
+
+void SimDefineCanal(int tipo, uint16_t porta_tcp)
+{
+  tipo_canal = tipo;
+
+  if(tipo == CANAL_TCP)
+    socket_servidor = AbreServidorLocal(porta_tcp, 1);
+}
+
+void SimDefineResponder(std::function<void(const std::string &linha)> novo_responder)
+{
+  responder = novo_responder;
+}
+
+//Respostas atrasadas pela latência do canal em memória, em ordem de entrega
+static std::deque<std::pair<uint64_t, std::string>> pendentes;
+static uint32_t latencia_canal_us = 0;
+static uint32_t variacao_latencia_us = 0;
+static uint64_t estado_latencia = 0x2545F4914F6CDD1Dull;
+
+static void Acrescenta(const std::string &dados)
+{
+  if(posicao_recebidos == recebidos.size())
+  {
+    recebidos.clear();
+    posicao_recebidos = 0;
+  }
+
+  recebidos += dados;
+}
+
+static void EntregaPendentes()
+{
+  while(!pendentes.empty() && pendentes.front().first <= tempo_us)
+  {
+    Acrescenta(pendentes.front().second);
+    pendentes.pop_front();
+  }
+}
+
+void SimDefineLatenciaCanal(uint32_t latencia_us, uint32_t variacao_us)
+{
+  latencia_canal_us = latencia_us;
+  variacao_latencia_us = variacao_us;
+}
+
+void SimEnviaAoFirmware(const std::string &dados)
+{
+  if(tipo_canal != CANAL_MEMORIA || (latencia_canal_us == 0 && variacao_latencia_us == 0))
+  {
+    Acrescenta(dados);
+    return;
+  }
+
+  uint64_t entrega_us = tempo_us + latencia_canal_us;
+  if(variacao_latencia_us)
+  {
+    estado_latencia ^= estado_latencia << 13; //xorshift64: a sequência de atrasos é a mesma a cada execução
+    estado_latencia ^= estado_latencia >> 7;
+    estado_latencia ^= estado_latencia << 17;
+    entrega_us += estado_latencia % (variacao_latencia_us + 1);
+  }
+
+  //O canal preserva a ordem: uma resposta nunca ultrapassa a anterior
+  if(!pendentes.empty() && entrega_us < pendentes.back().first)
+    entrega_us = pendentes.back().first;
+
+  pendentes.emplace_back(entrega_us, dados);
+}
+
+void SimLimpaCanal()
+{
+  recebidos.clear();
+  posicao_recebidos = 0;
+  pendentes.clear();
+  linha_enviada.clear();
+}
+
+void SimDefineClienteConectado(bool conectado)
+{
+  cliente_conectado = conectado;
+  NotificaConexao();
+}
+
+void SimDefineTransporteCanal(int transporte)
+{
+  transporte_canal = transporte;
+  NotificaConexao();
+}
+
+static int DescritorEntrada()
+{
+  if(tipo_canal == CANAL_STDIO)
+    return STDIN_FILENO;
+  if(tipo_canal == CANAL_TCP)
+    return socket_cliente;
+  return -1;
+}
+
+static void AceitaClienteTcp()
+{
+  if(tipo_canal != CANAL_TCP || socket_cliente >= 0)
+    return;
+
+  socket_cliente = accept(socket_servidor, nullptr, nullptr);
+
+  if(socket_cliente >= 0)
+    fprintf(stderr, "tix_sim: host conectado via TCP\n");
+  NotificaConexao();
+}
+
+//Lê o que já estiver disponível no descritor externo, aguardando no máximo "espera_ms" de tempo real
+static void RecebeExterno(int espera_ms)
+{
+  AceitaClienteTcp();
+
+  int descritor = DescritorEntrada();
+  if(descritor < 0)
+  {
+    if(espera_ms > 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(espera_ms));
+    return;
+  }
+
+  pollfd evento = {descritor, POLLIN, 0};
+  if(poll(&evento, 1, espera_ms) <= 0)
+    return;
+
+  char buffer[256];
+  ssize_t lidos = read(descritor, buffer, sizeof(buffer));
+
+  if(lidos > 0)
+    SimEnviaAoFirmware(std::string(buffer, lidos));
+  else if(tipo_canal == CANAL_TCP)
+  {
+    close(socket_cliente);
+    socket_cliente = -1;
+    fprintf(stderr, "tix_sim: host desconectou\n");
+    NotificaConexao();
+  }
+}
+
+static size_t EscreveCanal(const uint8_t *buffer, size_t tamanho)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  if(tipo_canal == CANAL_STDIO)
+  {
+    fwrite(buffer, 1, tamanho, stdout);
+    fflush(stdout);
+    return tamanho;
+  }
+
+  if(tipo_canal == CANAL_TCP)
+  {
+    if(socket_cliente >= 0)
+      send(socket_cliente, buffer, tamanho, MSG_NOSIGNAL);
+    return tamanho;
+  }
+
+  for(size_t i = 0; i < tamanho; i++)
+  {
+    if(buffer[i] == '\n')
+    {
+      if(responder)
+        responder(linha_enviada);
+      linha_enviada.clear();
+    }
+    else if(buffer[i] != '\r')
+      linha_enviada += (char)buffer[i];
+  }
+
+  return tamanho;
+}
+
+static int DisponivelCanal()
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  EntregaPendentes();
+
+  if(tipo_canal != CANAL_MEMORIA && posicao_recebidos == recebidos.size())
+    RecebeExterno(0);
+
+  return recebidos.size() - posicao_recebidos;
+}
+
+static int LeCanal(int transporte, bool consome)
+{
+  if(!DisponivelCanal() || !HostNoRadio(transporte))
+    return -1;
+
+  return (uint8_t)recebidos[consome ? posicao_recebidos++ : posicao_recebidos];
+}
+
+bool BluetoothSerial::begin(const char *nome, bool mestre)
+{
+  bluetooth_ativo = true;
+  NotificaConexao();
+  return true;
+}
+
+void BluetoothSerial::end()
+{
+  bluetooth_ativo = false;
+  NotificaConexao();
+}
+
+esp_err_t BluetoothSerial::register_callback(esp_spp_cb_t callback)
+{
+  callback_spp = callback;
+  conexao_notificada = false;
+  NotificaConexao();
+  return ESP_OK;
+}
+
+bool BluetoothSerial::hasClient()
+{
+  if(!HostNoRadio(SIM_TRANSPORTE_BLUETOOTH))
+    return false;
+
+  AceitaClienteTcp();
+  return EnlaceConectado();
+}
+
+size_t BluetoothSerial::write(uint8_t caractere)
+{
+  return write(&caractere, 1);
+}
+
+size_t BluetoothSerial::write(const uint8_t *buffer, size_t tamanho)
+{
+  return HostNoRadio(SIM_TRANSPORTE_BLUETOOTH) ? EscreveCanal(buffer, tamanho) : 0;
+}
+
+int BluetoothSerial::available()
+{
+  int disponiveis = DisponivelCanal(); //Também aceita o host pelo TCP
+  return HostNoRadio(SIM_TRANSPORTE_BLUETOOTH) ? disponiveis : 0;
+}
+
+int BluetoothSerial::read()
+{
+  return LeCanal(SIM_TRANSPORTE_BLUETOOTH, true);
+}
+
+int BluetoothSerial::peek()
+{
+  return LeCanal(SIM_TRANSPORTE_BLUETOOTH, false);
+}
+
+//---------------------------------------------------------------- WiFi
+
+bool WiFiClass::softAP(const char *ssid, const char *senha)
+{
+  wifi_ativo = true;
+  NotificaConexao();
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool desliga_radio)
+{
+  wifi_ativo = false;
+  NotificaConexao();
+  return true;
+}
+
+void WiFiClass::onEvent(WiFiEventFuncCb callback)
+{
+  callback_wifi = callback;
+  associacao_notificada = false;
+  NotificaConexao();
+}
+
+#define PORTA_HOST_WIFI 5000 //PORTA_WIFI do main.cpp: o servidor que atende o canal do host
+
+static std::map<uint16_t, int> servidores_redirecionados; //Porta do firmware -> servidor no loopback
+
+void SimRedirecionaPortaWifi(uint16_t porta_firmware, uint16_t porta_local)
+{
+  servidores_redirecionados[porta_firmware] = AbreServidorLocal(porta_local, 8);
+}
+
+WiFiServer::WiFiServer(uint16_t porta, uint8_t maximo_clientes) : porta(porta)
+{
+}
+
+void WiFiServer::begin()
+{
+  ativo = true;
+  if(porta == PORTA_HOST_WIFI)
+    servidor_wifi_ativo = true;
+}
+
+void WiFiServer::end()
+{
+  ativo = false;
+  if(porta == PORTA_HOST_WIFI)
+    servidor_wifi_ativo = false;
+}
+
+WiFiClient WiFiServer::available()
+{
+  auto redirecionado = servidores_redirecionados.find(porta);
+  if(redirecionado != servidores_redirecionados.end()) //Enquanto fechado, as conexões esperam na fila do servidor
+  {
+    int descritor = ativo ? accept(redirecionado->second, nullptr, nullptr) : -1;
+    if(descritor >= 0)
+      fcntl(descritor, F_SETFL, O_NONBLOCK);
+    return WiFiClient(descritor >= 0, descritor);
+  }
+
+  if(porta != PORTA_HOST_WIFI) //Outra porta sem redirecionamento: ninguém conecta
+    return WiFiClient();
+
+  AceitaClienteTcp();
+  return WiFiClient(servidor_wifi_ativo && HostNoRadio(SIM_TRANSPORTE_WIFI) && EnlaceConectado());
+}
+
+void WiFiClient::stop()
+{
+  if(descritor >= 0)
+    close(descritor);
+  descritor = -1;
+  aceito = false;
+}
+
+uint8_t WiFiClient::connected()
+{
+  if(descritor >= 0)
+  {
+    char caractere;
+    ssize_t recebidos = recv(descritor, &caractere, 1, MSG_PEEK | MSG_DONTWAIT);
+    return recebidos > 0 || (recebidos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+  }
+
+  return aceito && servidor_wifi_ativo && HostNoRadio(SIM_TRANSPORTE_WIFI) && EnlaceConectado();
+}
+
+size_t WiFiClient::write(uint8_t caractere)
+{
+  return write(&caractere, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t tamanho)
+{
+  if(descritor >= 0)
+  {
+    ssize_t enviados = send(descritor, buffer, tamanho, MSG_NOSIGNAL | MSG_DONTWAIT);
+    return enviados > 0 ? enviados : 0;
+  }
+
+  return connected() ? EscreveCanal(buffer, tamanho) : 0;
+}
+
+int WiFiClient::available()
+{
+  if(descritor >= 0)
+  {
+    char buffer[256];
+    ssize_t recebidos = recv(descritor, buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
+    return recebidos > 0 ? recebidos : 0;
+  }
+
+  int disponiveis = DisponivelCanal();
+  return HostNoRadio(SIM_TRANSPORTE_WIFI) ? disponiveis : 0;
+}
+
+int WiFiClient::read()
+{
+  if(descritor >= 0)
+  {
+    unsigned char caractere;
+    return recv(descritor, &caractere, 1, MSG_DONTWAIT) == 1 ? caractere : -1;
+  }
+
+  return LeCanal(SIM_TRANSPORTE_WIFI, true);
+}
+
+int WiFiClient::peek()
+{
+  if(descritor >= 0)
+  {
+    unsigned char caractere;
+    return recv(descritor, &caractere, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? caractere : -1;
+  }
+
+  return LeCanal(SIM_TRANSPORTE_WIFI, false);
+}
+
+//---------------------------------------------------------------- Stream
+
+int Stream::timedRead()
+{
+  uint64_t inicio_us = tempo_us;
+
+  if(tempo_us != fim_ultima_espera_us) //O firmware fez outra coisa desde a última espera, então não está travado
+    bloqueado = false;
+
+  while(true)
+  {
+    int caractere = read();
+
+    if(caractere >= 0)
+    {
+      bloqueado = false;
+      return caractere;
+    }
+
+    uint64_t decorrido_us = tempo_us - inicio_us;
+    if(decorrido_us >= (uint64_t)tempo_limite * 1000)
+    {
+      fim_ultima_espera_us = tempo_us;
+      return -1;
+    }
+
+    if(!bloqueado)
+    {
+      bloqueado = true;
+      inicio_bloqueio_us = inicio_us;
+    }
+
+    if(limite_bloqueio_us && tempo_us - inicio_bloqueio_us >= limite_bloqueio_us)
+    {
+      bloqueado = false;
+      throw SimTravado{tempo_us - inicio_bloqueio_us};
+    }
+
+    uint64_t restante_us = (uint64_t)tempo_limite * 1000 - decorrido_us;
+
+    if(this == &Serial)
+      SimAvancaTempo(restante_us);
+    else if(tipo_canal == CANAL_MEMORIA) //Nada muda no canal em memória até a próxima resposta atrasada
+      SimAvancaTempo(pendentes.empty() ? restante_us : std::min(restante_us, pendentes.front().first - tempo_us));
+    else
+    {
+      //Espera real pelo host externo, o relógio virtual acompanha o tempo real decorrido
+      auto inicio_real = std::chrono::steady_clock::now();
+      RecebeExterno(velocidade > 0 ? (int)(restante_us / 1000 / velocidade) : 10);
+      uint64_t real_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - inicio_real).count();
+      SimAvancaTempo(std::min(restante_us, std::max<uint64_t>(real_us, 1000)));
+    }
+  }
+}
+
+String Stream::readStringUntil(char terminador)
+{
+  String texto;
+  int caractere = timedRead();
+
+  while(caractere >= 0 && caractere != terminador)
+  {
+    texto += (char)caractere;
+    caractere = timedRead();
+  }
+
+  return texto;
+}
+
+String Stream::readString()
+{
+  String texto;
+  int caractere = timedRead();
+
+  while(caractere >= 0)
+  {
+    texto += (char)caractere;
+    caractere = timedRead();
+  }
+
+  return texto;
+}
+
+size_t Stream::readBytes(char *buffer, size_t tamanho)
+{
+  size_t lidos = 0;
+
+  while(lidos < tamanho)
+  {
+    int caractere = timedRead();
+    if(caractere < 0)
+      break;
+    buffer[lidos++] = (char)caractere;
+  }
+
+  return lidos;
+}
+
+size_t Stream::readBytesUntil(char terminador, char *buffer, size_t tamanho)
+{
+  size_t lidos = 0;
+
+  while(lidos < tamanho)
+  {
+    int caractere = timedRead();
+    if(caractere < 0 || caractere == terminador)
+      break;
+    buffer[lidos++] = (char)caractere;
+  }
+
+  return lidos;
+}
+
+//---------------------------------------------------------------- NVS (Preferences)
+
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+
+bool Preferences::begin(const char *nome, bool somente_leitura_nvs, const char *particao)
+{
+  espaco = nome;
+  aberto = true;
+  somente_leitura = somente_leitura_nvs;
+  return true;
+}
+
+void Preferences::end()
+{
+  aberto = false;
+}
+
+bool Preferences::clear()
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  if(!aberto || somente_leitura)
+    return false;
+
+  nvs[espaco.c_str()].clear();
+  return true;
+}
+
+bool Preferences::remove(const char *chave)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  if(!aberto || somente_leitura)
+    return false;
+
+  return nvs[espaco.c_str()].erase(chave) > 0;
+}
+
+bool Preferences::isKey(const char *chave)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  return aberto && nvs[espaco.c_str()].count(chave) > 0;
+}
+
+size_t Preferences::getBytesLength(const char *chave)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  if(!isKey(chave))
+    return 0;
+
+  return nvs[espaco.c_str()][chave].size();
+}
+
+size_t Preferences::getBytes(const char *chave, void *buffer, size_t tamanho)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  size_t tamanho_valor = getBytesLength(chave);
+
+  if(tamanho_valor == 0 || tamanho_valor > tamanho)
+    return 0;
+
+  memcpy(buffer, nvs[espaco.c_str()][chave].data(), tamanho_valor);
+  return tamanho_valor;
+}
+
+size_t Preferences::putBytes(const char *chave, const void *buffer, size_t tamanho)
+{
+  SimIgnoraAlocacoes ignora_alocacoes;
+
+  if(!aberto || somente_leitura)
+    return 0;
+
+  const uint8_t *bytes = (const uint8_t *)buffer;
+  nvs[espaco.c_str()][chave].assign(bytes, bytes + tamanho);
+  return tamanho;
+}
+
+int32_t Preferences::getInt(const char *chave, int32_t valor_padrao)
+{
+  int32_t valor;
+  return getBytes(chave, &valor, sizeof(valor)) == sizeof(valor) ? valor : valor_padrao;
+}
+
+size_t Preferences::putInt(const char *chave, int32_t valor)
+{
+  return putBytes(chave, &valor, sizeof(valor));
+}
+
+uint32_t Preferences::getUInt(const char *chave, uint32_t valor_padrao)
+{
+  uint32_t valor;
+  return getBytes(chave, &valor, sizeof(valor)) == sizeof(valor) ? valor : valor_padrao;
+}
+
+size_t Preferences::putUInt(const char *chave, uint32_t valor)
+{
+  return putBytes(chave, &valor, sizeof(valor));
+}
+
+void SimCarregaNvs(const char *arquivo)
+{
+  //Formato: uma entrada por linha, "espaco chave bytes_em_hexadecimal"
+  FILE *entrada = fopen(arquivo, "r");
+  if(!entrada)
+    return;
+
+  char espaco[64], chave[64], hexadecimal[4096];
+
+  while(fscanf(entrada, "%63s %63s %4095s", espaco, chave, hexadecimal) == 3)
+  {
+    std::vector<uint8_t> &valor = nvs[espaco][chave];
+    valor.clear();
+
+    for(size_t i = 0; hexadecimal[i] && hexadecimal[i + 1]; i += 2)
+    {
+      char par[3] = {hexadecimal[i], hexadecimal[i + 1], '\0'};
+      valor.push_back((uint8_t)strtoul(par, nullptr, 16));
+    }
+  }
+
+  fclose(entrada);
+}
+
+void SimSalvaNvs(const char *arquivo)
+{
+  FILE *saida = fopen(arquivo, "w");
+  if(!saida)
+    return;
+
+  for(auto &espaco : nvs)
+    for(auto &entrada : espaco.second)
+    {
+      fprintf(saida, "%s %s ", espaco.first.c_str(), entrada.first.c_str());
+
+      for(uint8_t byte_valor : entrada.second)
+        fprintf(saida, "%02x", byte_valor);
+
+      fprintf(saida, "\n");
+    }
+
+  fclose(saida);
+}
@@ -0,0 +1,87 @@
+//Controle do hardware virtual do simulador: relógio, pinos, LCD, canal serial do host e NVS
+//O firmware é compilado sem alterações contra os substitutos em shims/ e o programa que o executa
+//(tix_sim, harness de fuzz, etc.) usa estas funções para estimular entradas e observar saídas
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <functional>
+
+#define LCD_COLUNAS 20
+#define LCD_LINHAS 4
+
+//Custos de tempo virtual aproximados das operações no ESP32 (em microssegundos)
+#define CUSTO_ANALOGREAD_US 10 //Conversão do ADC1/ADC2 com a API do Arduino
+#define CUSTO_LCD_BYTE_US 550 //Um caractere via PCF8574 a 100 kHz (duas metades de 4 bits com pulso de enable)
+#define CUSTO_LCD_CLEAR_US 2000 //Comando clear/home do HD44780
+
+//Backends possíveis para o canal serial do host (BluetoothSerial)
+#define CANAL_MEMORIA 0 //Respostas produzidas por um callback (host virtual, fuzz, benchmark)
+#define CANAL_STDIO 1 //Mensagens do firmware no stdout, respostas lidas do stdin
+#define CANAL_TCP 2 //Servidor TCP, permite ligar o main.py com SERIAL_PORT_NAME = 'socket://localhost:porta'
+
+//Rádio do firmware pelo qual o canal do host passa (mesma numeração de TRANSPORTE_... em src/latencia.h)
+#define SIM_TRANSPORTE_AUTOMATICO -1 //O Bluetooth se ele estiver ligado, senão o WiFi
+#define SIM_TRANSPORTE_BLUETOOTH 0
+#define SIM_TRANSPORTE_WIFI 1
+
+//Exceção lançada quando o firmware fica bloqueado mais do que o permitido aguardando o host
+struct SimTravado
+{
+  uint64_t tempo_us;
+};
+
+//Relógio virtual
+uint64_t SimTempoUs();
+void SimAvancaTempo(uint64_t tempo_us);
+void SimDefineVelocidade(double velocidade); //0 = o mais rápido possível, 1 = tempo real
+void SimDefineLimiteBloqueio(uint64_t tempo_us); //0 desativa o limite
+
+//Heap informado pelo ESP (o padrão é o de um ESP32 ocioso com Bluetooth)
+void SimDefineHeap(uint32_t livre, uint32_t maior_bloco);
+
+//Pinos
+void SimDefineAnalogico(uint8_t pino, uint16_t valor);
+void SimDefineRuidoAnalogico(uint16_t amplitude, uint64_t semente);
+void SimDefineDigital(uint8_t pino, int nivel);
+int SimLeSaidaDigital(uint8_t pino);
+uint64_t SimQuantidadeTons();
+uint64_t SimQuantidadeLeiturasAnalogicas();
+
+//LCD
+std::string SimLcdLinha(unsigned int linha); //Caracteres customizados aparecem como aproximações ASCII
+char SimLcdCaractere(unsigned int coluna, unsigned int linha);
+bool SimLcdLuzDeFundo();
+void SimDefineGlifos(const char glifos[8]); //Aproximação ASCII de cada caractere customizado (posições 0 a 7 da CGRAM)
+uint64_t SimLcdBytesEnviados();
+
+//Serial USB de depuração
+void SimDefineSaidaDepuracao(FILE *saida); //nullptr descarta a saída
+uint64_t SimBytesDepuracao();
+void SimEnviaSerialUsb(const std::string &dados); //Como digitado no monitor serial; a partir daí a saída é guardada
+std::string SimConsomeSaidaDepuracao(); //Saída guardada desde a chamada anterior
+
+//Canal serial do host (BluetoothSerial)
+void SimDefineCanal(int tipo, uint16_t porta_tcp = 0);
+void SimDefineResponder(std::function<void(const std::string &linha)> responder); //Chamado a cada linha enviada pelo firmware
+void SimEnviaAoFirmware(const std::string &dados);
+void SimLimpaCanal();
+void SimDefineClienteConectado(bool conectado);
+void SimDefineTransporteCanal(int transporte); //Rádio pelo qual o host fala: SIM_TRANSPORTE_...
+void SimDefineLatenciaCanal(uint32_t latencia_us, uint32_t variacao_us = 0); //Atraso das respostas no canal em memória (ida e volta do rádio)
+void SimRedirecionaPortaWifi(uint16_t porta_firmware, uint16_t porta_local); //WiFiServer(porta_firmware) escuta no loopback, em porta_local
+
+//Alocações feitas pelo próprio simulador (canal em memória, responder, NVS) não entram no QuantidadeAlocacoes()
+//do firmware, assim um loop() que não aloca nada no ESP32 também mostra zero alocações no computador
+class SimIgnoraAlocacoes
+{
+  public:
+    SimIgnoraAlocacoes();
+    ~SimIgnoraAlocacoes();
+};
+bool SimAlocacoesIgnoradas();
+
+//NVS
+void SimCarregaNvs(const char *arquivo);
+void SimSalvaNvs(const char *arquivo);
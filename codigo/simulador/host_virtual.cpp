@@ -0,0 +1,305 @@
+//Regras portadas das funções movement_rules, legal_move, is_king_attacked, etc. do main.py
+#include "host_virtual.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+static bool Vazia(const Posicao &posicao, int casa)
+{
+  return posicao[casa] == "V";
+}
+
+static char Cor(const Posicao &posicao, int casa)
+{
+  return Vazia(posicao, casa) ? '\0' : posicao[casa][1];
+}
+
+static char CorAdversaria(char cor)
+{
+  return cor == 'B' ? 'P' : 'B';
+}
+
+static bool MovimentoPermitido(const std::string &peca, int origem, int destino, const Posicao &posicao)
+{
+  if(origem == destino)
+    return false;
+
+  switch(peca[0])
+  {
+    case 'R':
+      return abs(destino - origem) == 1;
+
+    case 'C':
+      return abs(destino - origem) == 2;
+
+    case 'T':
+    {
+      int passo = destino > origem ? 1 : -1;
+
+      for(int i = origem + passo; i != destino; i += passo)
+        if(!Vazia(posicao, i))
+          return false;
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static int CasaDoRei(const Posicao &posicao, char cor)
+{
+  for(int i = 0; i < (int)posicao.size(); i++)
+    if(posicao[i][0] == 'R' && posicao[i][1] == cor)
+      return i;
+
+  return -1;
+}
+
+bool ReiAtacado(const Posicao &posicao, char cor)
+{
+  int casa_rei = CasaDoRei(posicao, cor);
+  if(casa_rei < 0)
+    return false;
+
+  Posicao sem_rei = posicao;
+  sem_rei[casa_rei] = "V";
+
+  for(int i = 0; i < (int)posicao.size(); i++)
+    if(Cor(posicao, i) == CorAdversaria(cor) && MovimentoPermitido(posicao[i], i, casa_rei, sem_rei))
+      return true;
+
+  return false;
+}
+
+bool LanceLegal(const Posicao &posicao, int origem, int destino)
+{
+  if(Vazia(posicao, origem) || !MovimentoPermitido(posicao[origem], origem, destino, posicao))
+    return false;
+
+  if(Cor(posicao, destino) == Cor(posicao, origem))
+    return false;
+
+  Posicao depois = posicao;
+  depois[destino] = depois[origem];
+  depois[origem] = "V";
+
+  return !ReiAtacado(depois, Cor(posicao, origem));
+}
+
+std::vector<Lance> LancesLegais(const Posicao &posicao, char cor)
+{
+  std::vector<Lance> lances;
+
+  for(int origem = 0; origem < (int)posicao.size(); origem++)
+    if(Cor(posicao, origem) == cor)
+      for(int destino = 0; destino < (int)posicao.size(); destino++)
+        if(LanceLegal(posicao, origem, destino))
+          lances.push_back({origem, destino});
+
+  return lances;
+}
+
+bool XequeMate(const Posicao &posicao, char cor)
+{
+  return ReiAtacado(posicao, cor) && LancesLegais(posicao, cor).empty();
+}
+
+bool Afogamento(const Posicao &posicao, char cor)
+{
+  return !ReiAtacado(posicao, cor) && LancesLegais(posicao, cor).empty();
+}
+
+bool MaterialInsuficiente(const Posicao &posicao)
+{
+  int pecas = 0;
+
+  for(const std::string &peca : posicao)
+    if(peca != "V")
+      pecas++;
+
+  return pecas == 2 && CasaDoRei(posicao, 'B') >= 0 && CasaDoRei(posicao, 'P') >= 0;
+}
+
+bool LeFen(const std::string &fen, Posicao &posicao, char &cor)
+{
+  static const std::string letras = "KNRknr";
+  static const char *const pecas[] = {"RB", "CB", "TB", "RP", "CP", "TP"};
+  Posicao lida;
+  size_t i = 0;
+
+  for(; i < fen.size() && fen[i] != ' '; i++)
+  {
+    if(fen[i] >= '1' && fen[i] <= '8')
+      lida.insert(lida.end(), fen[i] - '0', "V");
+    else if(letras.find(fen[i]) != std::string::npos)
+    {
+      std::string peca = pecas[letras.find(fen[i])];
+
+      for(const std::string &outra : lida)
+        if(outra == peca)
+          return false; //Cada peça existe uma vez só
+      lida.push_back(peca);
+    }
+    else
+      return false;
+  }
+
+  if(lida.size() != 8 || i + 2 != fen.size() || (fen[i + 1] != 'w' && fen[i + 1] != 'b'))
+    return false;
+
+  char vez = fen[i + 1] == 'w' ? 'B' : 'P';
+  if(CasaDoRei(lida, 'B') < 0 || CasaDoRei(lida, 'P') < 0 || ReiAtacado(lida, CorAdversaria(vez)) ||
+     LancesLegais(lida, vez).empty())
+    return false;
+
+  posicao = lida;
+  cor = vez;
+  return true;
+}
+
+std::string Fen(const Posicao &posicao, char cor)
+{
+  static const std::string letras = "KNRknr";
+  static const char *const pecas[] = {"RB", "CB", "TB", "RP", "CP", "TP"};
+  std::string fen;
+  int vazias = 0;
+
+  for(const std::string &peca : posicao)
+  {
+    if(peca == "V")
+    {
+      vazias++;
+      continue;
+    }
+
+    if(vazias > 0)
+      fen += (char)('0' + vazias);
+    vazias = 0;
+
+    for(int i = 0; i < 6; i++)
+      if(peca == pecas[i])
+        fen += letras[i];
+  }
+
+  if(vazias > 0)
+    fen += (char)('0' + vazias);
+
+  return fen + (cor == 'B' ? " w" : " b");
+}
+
+unsigned long HashFen(const std::string &fen)
+{
+  uint32_t hash = 2166136261u;
+
+  for(char c : fen)
+  {
+    hash ^= (uint8_t)c;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void HostVirtual::Reinicia()
+{
+  posicao = POSICAO_INICIAL;
+  cor_da_vez = 'B';
+  vencedor = '0';
+  historico.clear();
+  refaziveis.clear();
+  ultima_linha.clear();
+  ultima_resposta.clear();
+}
+
+std::string HostVirtual::ProcessaLinha(const std::string &linha)
+{
+  if(linha.compare(0, 6, "[\"t\", ") == 0) //Telemetria: o main.py só atualiza as telas, não responde
+    return "";
+
+  if(linha == ultima_linha) //Cada mensagem leva um número de sequência: a mesma linha é um reenvio depois de reconectar
+    return ultima_resposta;
+
+  ultima_resposta = ProcessaMensagem(linha);
+  ultima_linha = linha;
+  return ultima_resposta;
+}
+
+std::string HostVirtual::ProcessaMensagem(const std::string &linha)
+{
+  int origem, destino, tempo_restante, tempo_configurado;
+  char fen[16];
+
+  if(sscanf(linha.c_str(), " [\"fen\", \"%15[^\"]\"]", fen) == 1) //Posição adotada no tabuleiro antes da partida
+  {
+    if(!LeFen(fen, posicao, cor_da_vez))
+      return "[0, 0]";
+
+    vencedor = '0';
+    historico.clear();
+    refaziveis.clear();
+    return "[1, 0]";
+  }
+
+  char comando[8];
+  unsigned long hash;
+
+  if(sscanf(linha.c_str(), " [\"%7[a-z]\", %lu]", comando, &hash) == 2) //Desfazer ou refazer, com o hash da posição esperada
+  {
+    std::string nome = comando;
+    std::vector<Momento> &origem_momento = nome == "desfaz" ? historico : refaziveis;
+    std::vector<Momento> &destino_momento = nome == "desfaz" ? refaziveis : historico;
+
+    if((nome != "desfaz" && nome != "refaz") || origem_momento.empty() ||
+       HashFen(Fen(origem_momento.back().posicao, origem_momento.back().cor_da_vez)) != hash)
+      return "[0, 0]";
+
+    destino_momento.push_back({posicao, cor_da_vez});
+    posicao = origem_momento.back().posicao;
+    cor_da_vez = origem_momento.back().cor_da_vez;
+    origem_momento.pop_back();
+    return "[1, 0]";
+  }
+
+  if(sscanf(linha.c_str(), " [%d, %d, %d, %d]", &origem, &destino, &tempo_restante, &tempo_configurado) != 4)
+    return "";
+
+  //O main.py indexa listas do Python, onde -1 é a última casa
+  if(origem < -8 || origem > 7 || destino < -8 || destino > 7)
+    return "";
+  if(origem < 0)
+    origem += 8;
+  if(destino < 0)
+    destino += 8;
+
+  if(Vazia(posicao, origem) || Cor(posicao, origem) != cor_da_vez || !LanceLegal(posicao, origem, destino))
+  {
+    lances_recusados++;
+    return "[0, 0]";
+  }
+
+  if(tempo_restante == 0)
+  {
+    vencedor = cor_da_vez == 'B' ? '2' : '1';
+    return cor_da_vez == 'B' ? "[1, 2]" : "[1, 1]";
+  }
+
+  historico.push_back({posicao, cor_da_vez});
+  refaziveis.clear();
+
+  posicao[destino] = posicao[origem];
+  posicao[origem] = "V";
+  cor_da_vez = CorAdversaria(cor_da_vez);
+  lances_aceitos++;
+
+  vencedor = '0';
+  if(XequeMate(posicao, 'P'))
+    vencedor = '1';
+  else if(XequeMate(posicao, 'B'))
+    vencedor = '2';
+  else if(Afogamento(posicao, 'B') || Afogamento(posicao, 'P') || MaterialInsuficiente(posicao))
+    vencedor = '3';
+
+  return std::string("[1, ") + vencedor + "]";
+}
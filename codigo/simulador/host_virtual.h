@@ -0,0 +1,56 @@
+//Host virtual: reproduz no simulador o comportamento do main.py (regras do xadrez 1D e respostas ao tabuleiro)
+#pragma once
+
+#include <string>
+#include <vector>
+
+//Peças no formato usado pelo firmware: R = Rei, C = Cavalo, T = Torre, B = Brancas, P = Pretas, V = Vazio
+typedef std::vector<std::string> Posicao;
+
+struct Lance
+{
+  int origem;
+  int destino;
+};
+
+const Posicao POSICAO_INICIAL = {"RB", "CB", "TB", "V", "V", "TP", "CP", "RP"};
+
+bool LanceLegal(const Posicao &posicao, int origem, int destino);
+std::vector<Lance> LancesLegais(const Posicao &posicao, char cor);
+bool ReiAtacado(const Posicao &posicao, char cor);
+bool XequeMate(const Posicao &posicao, char cor);
+bool Afogamento(const Posicao &posicao, char cor);
+bool MaterialInsuficiente(const Posicao &posicao);
+bool LeFen(const std::string &fen, Posicao &posicao, char &cor); //"KNR2rnk w": casas 0 a 7 e a cor da vez
+std::string Fen(const Posicao &posicao, char cor);
+unsigned long HashFen(const std::string &fen); //FNV-1a de 32 bits, o mesmo de src/historico.h
+
+struct HostVirtual
+{
+  struct Momento
+  {
+    Posicao posicao;
+    char cor_da_vez;
+  };
+
+  Posicao posicao = POSICAO_INICIAL;
+  char cor_da_vez = 'B';
+  std::vector<Momento> historico; //Posição antes de cada lance aceito, como o move_history do main.py
+  std::vector<Momento> refaziveis;
+  unsigned int lances_aceitos = 0;
+  unsigned int lances_recusados = 0;
+  char vencedor = '0'; //Mesmo código enviado ao tabuleiro: 0 = continua, 1 = brancas, 2 = pretas, 3 = empate
+  std::string ultima_linha; //Para responder de novo, sem reprocessar, uma mensagem reenviada
+  std::string ultima_resposta;
+
+  void Reinicia();
+
+  //Processa uma linha "[origem, destino, tempo_restante, tempo_configurado, seq, inicio_vez_us, instante_us, restante_ms, vez_ms]",
+  //"["fen", "KNR2rnk w"]", "["desfaz", hash, seq, instante_us]" ou "["refaz", hash, seq, instante_us]" enviada pelo
+  //tabuleiro e devolve a resposta exatamente como o main.py a escreve na serial (sem quebra de linha), ou "" se a
+  //linha for ignorada (como os quadros de telemetria "["t", ...]")
+  std::string ProcessaLinha(const std::string &linha);
+
+private:
+  std::string ProcessaMensagem(const std::string &linha);
+};
@@ -0,0 +1,38 @@
+//Substituto do cabeçalho Arduino.h para compilar o firmware no computador (simulador)
+//Os pinos, o relógio e as portas seriais são implementados em hal_sim.cpp e controlados por hal_sim.h
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+#include "WString.h"
+#include "Print.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+void pinMode(uint8_t pino, uint8_t modo);
+void digitalWrite(uint8_t pino, uint8_t valor);
+int digitalRead(uint8_t pino);
+uint16_t analogRead(uint8_t pino);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t tempo_ms);
+void delayMicroseconds(uint32_t tempo_us);
+
+void tone(uint8_t pino, unsigned int frequencia, unsigned long duracao = 0);
+void noTone(uint8_t pino);
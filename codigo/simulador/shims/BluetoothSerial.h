@@ -0,0 +1,41 @@
+//Substituto da biblioteca BluetoothSerial (SPP) para o simulador
+//Os dados trafegam pelo canal configurado em hal_sim.h (memória, stdin/stdout ou TCP)
+#pragma once
+
+#include "Print.h"
+
+//Só os eventos do SPP que o firmware trata; o simulador os gera quando o host conecta ou desconecta
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef enum
+{
+  ESP_SPP_CLOSE_EVT = 27,
+  ESP_SPP_SRV_OPEN_EVT = 34
+} esp_spp_cb_event_t;
+
+typedef union
+{
+  int nao_usado;
+} esp_spp_cb_param_t;
+
+typedef void (*esp_spp_cb_t)(esp_spp_cb_event_t evento, esp_spp_cb_param_t *parametro);
+
+class BluetoothSerial : public Stream
+{
+  public:
+    bool begin(const char *nome = "ESP32", bool mestre = false);
+    bool begin(const String &nome) { return begin(nome.c_str()); }
+    void end();
+    bool hasClient();
+    esp_err_t register_callback(esp_spp_cb_t callback);
+
+    size_t write(uint8_t caractere) override;
+    size_t write(const uint8_t *buffer, size_t tamanho) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    void flush() {}
+};
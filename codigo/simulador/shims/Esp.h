@@ -0,0 +1,19 @@
+//Substituto do objeto ESP (EspClass) do núcleo do ESP32 para o simulador
+#pragma once
+
+#include <cstdint>
+
+class EspClass
+{
+  public:
+    uint32_t getCycleCount(); //No simulador conta nanossegundos reais, ou seja, um "processador" de 1000 MHz
+    uint32_t getCpuFreqMHz() { return 1000; }
+    const char *getChipModel() { return "simulador"; }
+    uint32_t getFreeHeap();
+    uint32_t getHeapSize();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    void restart();
+};
+
+extern EspClass ESP;
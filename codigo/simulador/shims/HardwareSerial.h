@@ -0,0 +1,24 @@
+//Substituto da porta serial USB (Serial) do ESP32 para o simulador
+#pragma once
+
+#include "Print.h"
+
+class HardwareSerial : public Stream
+{
+  public:
+    void begin(unsigned long taxa_transmissao);
+    void end() {}
+
+    size_t write(uint8_t caractere) override;
+    using Print::write;
+
+    int available() override; //Entrada dada por SimEnviaSerialUsb
+    int read() override;
+    int peek() override;
+
+    operator bool() const { return true; }
+
+    unsigned long taxa_transmissao = 115200;
+};
+
+extern HardwareSerial Serial;
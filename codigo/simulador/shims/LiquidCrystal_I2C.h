@@ -0,0 +1,27 @@
+//Substituto da biblioteca LiquidCrystal_I2C para o simulador
+//Os caracteres são gravados em um buffer virtual de 20x4 consultado por hal_sim.h
+#pragma once
+
+#include "Print.h"
+
+class LiquidCrystal_I2C : public Print
+{
+  public:
+    LiquidCrystal_I2C(uint8_t endereco, uint8_t colunas, uint8_t linhas) : colunas(colunas), linhas(linhas) {}
+
+    void init();
+    void begin() { init(); }
+    void backlight();
+    void noBacklight();
+    void clear();
+    void home();
+    void setCursor(uint8_t coluna, uint8_t linha);
+    void createChar(uint8_t posicao, uint8_t mapa[]);
+
+    size_t write(uint8_t caractere) override;
+    using Print::write;
+
+  private:
+    uint8_t colunas;
+    uint8_t linhas;
+};
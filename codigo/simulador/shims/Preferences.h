@@ -0,0 +1,30 @@
+//Substituto da biblioteca Preferences (NVS do ESP32) para o simulador, mantém os dados em memória
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "WString.h"
+
+class Preferences
+{
+  public:
+    bool begin(const char *nome, bool somente_leitura = false, const char *particao = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char *chave);
+    bool isKey(const char *chave);
+
+    int32_t getInt(const char *chave, int32_t valor_padrao = 0);
+    size_t putInt(const char *chave, int32_t valor);
+    uint32_t getUInt(const char *chave, uint32_t valor_padrao = 0);
+    size_t putUInt(const char *chave, uint32_t valor);
+    size_t getBytesLength(const char *chave);
+    size_t getBytes(const char *chave, void *buffer, size_t tamanho);
+    size_t putBytes(const char *chave, const void *buffer, size_t tamanho);
+
+  private:
+    String espaco;
+    bool aberto = false;
+    bool somente_leitura = true;
+};
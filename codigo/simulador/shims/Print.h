@@ -0,0 +1,94 @@
+//Substituto das classes Print e Stream do núcleo Arduino para o simulador
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t caractere) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t tamanho)
+    {
+      size_t escritos = 0;
+      while(tamanho--)
+        escritos += write(*buffer++);
+      return escritos;
+    }
+    size_t write(const char *texto) { return texto ? write((const uint8_t *)texto, strlen(texto)) : 0; }
+    size_t write(int caractere) { return write((uint8_t)caractere); }
+
+    size_t print(const char *texto) { return write(texto); }
+    size_t print(const String &texto) { return write((const uint8_t *)texto.c_str(), texto.length()); }
+    size_t print(char caractere) { return write((uint8_t)caractere); }
+    size_t print(unsigned char valor, int base = DEC) { return print((unsigned long)valor, base); }
+    size_t print(int valor, int base = DEC) { return print((long)valor, base); }
+    size_t print(unsigned int valor, int base = DEC) { return print((unsigned long)valor, base); }
+    size_t print(long valor, int base = DEC)
+    {
+      if(base == DEC && valor < 0)
+        return write('-') + print((unsigned long)(-valor), base);
+      return print((unsigned long)valor, base);
+    }
+    size_t print(unsigned long valor, int base = DEC)
+    {
+      char buffer[8 * sizeof(long) + 1];
+      char *cursor = &buffer[sizeof(buffer) - 1];
+      *cursor = '\0';
+
+      if(base < 2)
+        base = 10;
+
+      do
+      {
+        unsigned long digito = valor % base;
+        *--cursor = digito < 10 ? '0' + digito : 'A' + digito - 10;
+        valor /= base;
+      } while(valor);
+
+      return write(cursor);
+    }
+    size_t print(double valor, int casas_decimais = 2)
+    {
+      char buffer[40];
+      snprintf(buffer, sizeof(buffer), "%.*f", casas_decimais, valor);
+      return write(buffer);
+    }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T &valor) { size_t escritos = print(valor); return escritos + println(); }
+    template <typename T> size_t println(const T &valor, int formato) { size_t escritos = print(valor, formato); return escritos + println(); }
+
+    size_t printf(const char *formato, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print
+{
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long tempo_limite_ms) { tempo_limite = tempo_limite_ms; }
+    unsigned long getTimeout() const { return tempo_limite; }
+
+    String readStringUntil(char terminador);
+    String readString();
+    size_t readBytes(char *buffer, size_t tamanho);
+    size_t readBytesUntil(char terminador, char *buffer, size_t tamanho);
+
+  protected:
+    //Lê um caractere aguardando até o tempo limite (no relógio virtual do simulador), devolve -1 se esgotar
+    int timedRead();
+
+    unsigned long tempo_limite = 1000;
+};
@@ -0,0 +1,4 @@
+//No simulador a classe Stream é declarada junto com a Print
+#pragma once
+
+#include "Print.h"
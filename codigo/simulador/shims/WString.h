@@ -0,0 +1,72 @@
+//Substituto da classe String do núcleo Arduino para a compilação no computador (simulador)
+//Implementa apenas o subconjunto utilizado pelo firmware, com a mesma semântica do núcleo do ESP32
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+class String
+{
+  public:
+    String() {}
+    String(const char *texto) : dados(texto ? texto : "") {}
+    String(const std::string &texto) : dados(texto) {}
+    String(char caractere) : dados(1, caractere) {}
+    String(int valor) : dados(std::to_string(valor)) {}
+    String(unsigned int valor) : dados(std::to_string(valor)) {}
+    String(long valor) : dados(std::to_string(valor)) {}
+    String(unsigned long valor) : dados(std::to_string(valor)) {}
+
+    unsigned int length() const { return dados.length(); }
+    const char *c_str() const { return dados.c_str(); }
+    bool reserve(unsigned int tamanho) { dados.reserve(tamanho); return true; }
+    long toInt() const { return strtol(dados.c_str(), nullptr, 10); }
+
+    //Assim como no núcleo Arduino, o acesso fora dos limites não é um erro: a leitura devolve '\0'
+    char operator[](unsigned int indice) const { return indice < dados.length() ? dados[indice] : '\0'; }
+    char &operator[](unsigned int indice)
+    {
+      static char fora_dos_limites;
+      fora_dos_limites = '\0';
+      return indice < dados.length() ? dados[indice] : fora_dos_limites;
+    }
+    char charAt(unsigned int indice) const { return (*this)[indice]; }
+
+    int indexOf(char caractere, unsigned int inicio = 0) const
+    {
+      size_t posicao = dados.find(caractere, inicio);
+      return posicao == std::string::npos ? -1 : (int)posicao;
+    }
+    String substring(unsigned int inicio) const { return inicio < dados.length() ? String(dados.substr(inicio)) : String(); }
+    String substring(unsigned int inicio, unsigned int fim) const
+    {
+      if(inicio > fim || inicio >= dados.length())
+        return String();
+      return String(dados.substr(inicio, fim - inicio));
+    }
+
+    String &operator+=(const String &texto) { dados += texto.dados; return *this; }
+    String &operator+=(const char *texto) { dados += texto; return *this; }
+    String &operator+=(char caractere) { dados += caractere; return *this; }
+    String &operator+=(unsigned char valor) { dados += std::to_string(valor); return *this; }
+    String &operator+=(int valor) { dados += std::to_string(valor); return *this; }
+    String &operator+=(unsigned int valor) { dados += std::to_string(valor); return *this; }
+    String &operator+=(long valor) { dados += std::to_string(valor); return *this; }
+    String &operator+=(unsigned long valor) { dados += std::to_string(valor); return *this; }
+    bool concat(const String &texto) { dados += texto.dados; return true; }
+
+    bool operator==(const String &outra) const { return dados == outra.dados; }
+    bool operator==(const char *texto) const { return dados == texto; }
+    bool operator!=(const String &outra) const { return dados != outra.dados; }
+    bool operator!=(const char *texto) const { return dados != texto; }
+    bool equals(const String &outra) const { return dados == outra.dados; }
+
+    explicit operator bool() const { return true; }
+
+  private:
+    std::string dados;
+};
+
+inline String operator+(const String &a, const String &b) { String resultado = a; resultado += b; return resultado; }
+inline String operator+(const String &a, const char *b) { String resultado = a; resultado += b; return resultado; }
@@ -0,0 +1,71 @@
+//Substituto da biblioteca WiFi (ponto de acesso e servidor TCP) para o simulador
+//O cliente aceito pelo WiFiServer usa o mesmo canal do host que o BluetoothSerial (hal_sim.h), quando o host está
+//no WiFi: por padrão, nas variantes sem Bluetooth, ou depois de SimDefineTransporteCanal(SIM_TRANSPORTE_WIFI).
+//Um servidor numa porta redirecionada por SimRedirecionaPortaWifi() aceita conexões TCP de verdade no loopback, e
+//seus clientes usam o socket (fd()) como no ESP32; nas outras portas, fora a do host, ninguém conecta.
+#pragma once
+
+#include "Print.h"
+
+//Só os eventos do ponto de acesso que o firmware trata; o simulador os gera quando o host associa ou sai
+typedef enum
+{
+  ARDUINO_EVENT_WIFI_AP_STACONNECTED = 14,
+  ARDUINO_EVENT_WIFI_AP_STADISCONNECTED = 15
+} arduino_event_id_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+
+typedef union
+{
+  int nao_usado;
+} WiFiEventInfo_t;
+
+typedef void (*WiFiEventFuncCb)(WiFiEvent_t evento, WiFiEventInfo_t informacao);
+
+class WiFiClient : public Stream
+{
+  public:
+    WiFiClient() {}
+    explicit WiFiClient(bool aceito, int descritor = -1) : aceito(aceito), descritor(descritor) {}
+
+    uint8_t connected();
+    void stop();
+    int fd() const { return descritor; }
+    operator bool() { return aceito; }
+
+    size_t write(uint8_t caractere) override;
+    size_t write(const uint8_t *buffer, size_t tamanho) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+  private:
+    bool aceito = false;
+    int descritor = -1; //Socket de uma porta redirecionada; -1 no canal do host
+};
+
+class WiFiServer
+{
+  public:
+    explicit WiFiServer(uint16_t porta, uint8_t maximo_clientes = 4);
+    void begin();
+    void end();
+    WiFiClient available(); //Cliente aceito se o host está associado ao ponto de acesso
+
+  private:
+    uint16_t porta;
+    bool ativo = false;
+};
+
+class WiFiClass
+{
+  public:
+    bool softAP(const char *ssid, const char *senha = nullptr);
+    bool softAPdisconnect(bool desliga_radio = false);
+    void onEvent(WiFiEventFuncCb callback);
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,13 @@
+//Substituto da biblioteca Wire (I2C) para o simulador
+#pragma once
+
+#include <cstdint>
+
+class TwoWire
+{
+  public:
+    bool begin(int pino_sda = -1, int pino_scl = -1, uint32_t frequencia = 0) { return true; }
+    void setClock(uint32_t frequencia) {}
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,36 @@
+//Executa no computador o mesmo microbenchmark que o ambiente "bancada" do platformio.ini executa no ESP32
+//Os ciclos são nanossegundos reais do computador e os microssegundos são do relógio virtual, ou seja,
+//o tempo que as operações de LCD, ADC e serial levariam no tabuleiro segundo os custos de hal_sim.h
+//
+//Uso: tix_bancada > resultado.json
+#include "hal_sim.h"
+#include "bancada.h"
+
+#include <Arduino.h>
+
+void setup();
+
+class SaidaPadrao : public Print
+{
+  public:
+    size_t write(uint8_t caractere) override
+    {
+      return fputc(caractere, stdout) == EOF ? 0 : 1;
+    }
+    using Print::write;
+};
+
+int main()
+{
+  SaidaPadrao saida;
+
+  SimDefineSaidaDepuracao(nullptr);
+  setup();
+  if(!ExecutaBancada(saida))
+  {
+    fprintf(stderr, "tix_bancada: alguma função não pôde ser medida (veja \"erro\" no resultado)\n");
+    return 1;
+  }
+
+  return 0;
+}
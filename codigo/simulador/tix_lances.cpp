@@ -0,0 +1,137 @@
+//Repassa sequências de eventos das casas escritas à mão pelo reconhecedor de lances (src/reconhecedor.h)
+//
+//Uso: tix_lances [lances.txt]   (sem argumento, lê o lances.txt ao lado deste arquivo)
+//
+//Cada caso começa com "posicao" e termina com "espera"; "#" inicia comentário:
+//  posicao RB CB TB V V TP CP RP           Posição do início da vez
+//  vez <brancas|pretas>                   Jogador da vez (padrão: brancas)
+//  evento <ms> <casa> <antes> <depois>     Troca da peça estável de uma casa
+//  lida RB CB V TB V TP CP RP              Posição lida no relógio (padrão: a que os eventos formam)
+//  espera <resultado> [origem destino] [retrato]
+//                                          reconhecido, sem_lance, incompleto ou ambiguo; "retrato" se só a
+//                                          posição lida pôde ser usada
+//A saída mostra cada caso que falhou e o total; o código de saída é 1 se algum falhou.
+#include "reconhecedor.h"
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#ifndef TIX_LANCES_PADRAO
+#define TIX_LANCES_PADRAO "lances.txt"
+#endif
+
+static bool LePeca(const std::string &nome, Peca &peca)
+{
+  for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+    if(nome == NomePeca((Peca)i))
+    {
+      peca = (Peca)i;
+      return true;
+    }
+
+  return false;
+}
+
+static bool LePosicao(const std::vector<std::string> &partes, EstadoTabuleiro &posicao)
+{
+  if(partes.size() != QUANTIDADE_CASAS + 1)
+    return false;
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    if(!LePeca(partes[i + 1], posicao[i]))
+      return false;
+
+  return true;
+}
+
+static void AplicaEvento(EstadoTabuleiro &posicao, uint8_t casa, Peca depois)
+{
+  if(casa < QUANTIDADE_CASAS)
+    posicao[casa] = depois;
+}
+
+int main(int argc, char **argv)
+{
+  const char *caminho = argc > 1 ? argv[1] : TIX_LANCES_PADRAO;
+  FILE *entrada = fopen(caminho, "r");
+
+  if(!entrada)
+  {
+    fprintf(stderr, "tix_lances: não foi possível abrir %s\n", caminho);
+    return 2;
+  }
+
+  char linha[256];
+  unsigned int numero_linha = 0, casos = 0, falhas = 0;
+  EstadoTabuleiro formada = ESTADO_INICIAL, lida = ESTADO_INICIAL;
+  bool vez_brancas = true, lida_definida = false;
+
+  while(fgets(linha, sizeof(linha), entrada))
+  {
+    numero_linha++;
+
+    char *comentario = strchr(linha, '#');
+    if(comentario)
+      *comentario = '\0';
+
+    std::vector<std::string> partes;
+    for(char *parte = strtok(linha, " \t\r\n"); parte; parte = strtok(nullptr, " \t\r\n"))
+      partes.push_back(parte);
+
+    if(partes.empty())
+      continue;
+
+    const std::string &comando = partes[0];
+    Peca antes, depois;
+
+    if(comando == "posicao" && LePosicao(partes, formada))
+    {
+      IniciaReconhecimento(formada);
+      vez_brancas = true;
+      lida_definida = false;
+    }
+    else if(comando == "vez" && partes.size() == 2 && (partes[1] == "brancas" || partes[1] == "pretas"))
+      vez_brancas = partes[1] == "brancas";
+    else if(comando == "evento" && partes.size() == 5 && LePeca(partes[3], antes) && LePeca(partes[4], depois))
+    {
+      uint8_t casa = strtoul(partes[2].c_str(), nullptr, 10);
+
+      RegistraEventoCasa(strtoul(partes[1].c_str(), nullptr, 10), casa, antes, depois);
+      AplicaEvento(formada, casa, depois);
+    }
+    else if(comando == "lida" && LePosicao(partes, lida))
+      lida_definida = true;
+    else if(comando == "espera" && partes.size() >= 2)
+    {
+      LanceReconhecido lance = ReconheceLance(lida_definida ? lida : formada, vez_brancas);
+      bool retrato = partes.back() == "retrato";
+      size_t argumentos = partes.size() - (retrato ? 1 : 0);
+      int origem = argumentos >= 4 ? atoi(partes[2].c_str()) : -1;
+      int destino = argumentos >= 4 ? atoi(partes[3].c_str()) : -1;
+      bool confere = partes[1] == NomeResultadoLance(lance.resultado) && lance.pelo_retrato == retrato &&
+                     (argumentos < 4 || (lance.origem == origem && lance.destino == destino));
+
+      casos++;
+      if(!confere)
+      {
+        falhas++;
+        printf("linha %u: esperado %s %d %d%s, obtido %s %d %d%s\n", numero_linha, partes[1].c_str(), origem, destino,
+               retrato ? " retrato" : "", NomeResultadoLance(lance.resultado), lance.origem, lance.destino,
+               lance.pelo_retrato ? " retrato" : "");
+      }
+    }
+    else
+    {
+      fprintf(stderr, "tix_lances: linha %u inválida: %s\n", numero_linha, comando.c_str());
+      fclose(entrada);
+      return 2;
+    }
+  }
+
+  fclose(entrada);
+  printf("casos: %u, falhas: %u\n", casos, falhas);
+  return falhas ? 1 : 0;
+}
@@ -0,0 +1,554 @@
+//Executa o firmware do TiX no computador sobre o hardware virtual de hal_sim.h
+//
+//Uso:
+//  tix_sim --partidas 100 [--semente 1] [--ruido 40]      Joga partidas completas contra o host virtual
+//  tix_sim --script roteiro.txt                           Executa um roteiro de comandos (ou "-" para o stdin)
+//  tix_sim --canal tcp:5000 --velocidade 1 --script -     Conecta o main.py com SERIAL_PORT_NAME = 'socket://localhost:5000'
+//  tix_sim --partidas 10 --latencia 40:200                 Respostas do host virtual atrasadas de 40 a 240 ms
+//  tix_sim_wifi --painel 8080 --espectadores 3 --partidas 5
+//                                                         Página ao vivo em http://localhost:8080/, com 3 espectadores
+//                                                         simulados no fluxo de eventos; no fim, o "?painel"
+//
+//Comandos do roteiro (um por linha, "#" inicia comentário):
+//  tabuleiro RB CB TB V V TP CP RP   Posiciona as peças nas oito casas
+//  casa <indice> <peca>              Posiciona uma peça em uma casa
+//  analogico <pino> <valor>          Define a leitura crua de um pino analógico
+//  ruido <amplitude>                 Ruído uniforme somado às leituras analógicas
+//  botao <esquerda|centro|direita> [iteracoes]   Mantém o botão acionado durante as iterações do loop()
+//  segura <botao> / solta <botao>    Aciona ou libera um botão sem executar o loop()
+//  loop [n]                          Executa n iterações do loop()
+//  espera <ms>                       Executa o loop() até o relógio virtual avançar "ms"
+//  host <virtual|nenhum>             Liga ou desliga o host virtual (respostas do main.py)
+//  cliente <conectado|desconectado>  Conecta ou desconecta o host do rádio (eventos do SPP ou do ponto de acesso)
+//  transporte <bluetooth|wifi|automatico>   Rádio pelo qual o host fala (variante com os dois rádios)
+//  envia <texto>                     Entrega um texto ao firmware pelo canal serial do host
+//  serial [texto]                    Digita uma linha (o resto da linha do roteiro, com os espaços) na serial USB;
+//                                    sem texto, só o Enter
+//  lcd                               Mostra o conteúdo do LCD
+//  confere <texto>                   Encerra o roteiro com falha se nenhuma linha do LCD contiver o texto (o resto da
+//                                    linha do roteiro, com os espaços)
+//  nao_confere <texto>               Encerra o roteiro com falha se alguma linha do LCD contiver o texto
+//  confere_serial <texto>            Encerra o roteiro com falha se a serial USB não escreveu o texto desde o último
+//                                    confere_serial
+//  tempo                             Mostra o relógio virtual
+//  heap <livre> <maior_bloco>        Bytes informados por ESP.getFreeHeap() e ESP.getMaxAllocHeap()
+#include "hal_sim.h"
+#include "host_virtual.h"
+#include "registro.h"
+#include "comandos.h"
+#include "painel.h"
+
+#include <Arduino.h>
+
+#include <map>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+void setup();
+void loop();
+
+static const uint8_t pinos_casas[8] = {34, 35, 32, 33, 25, 26, 27, 14};
+static const std::map<std::string, uint8_t> pinos_botoes = {{"esquerda", 15}, {"centro", 4}, {"direita", 5}};
+
+//Leitura nominal do divisor de tensão para cada peça (mesmos valores medidos no protótipo)
+static const std::map<std::string, uint16_t> leituras_pecas = {
+  {"V", 4095}, {"RP", 1980}, {"TP", 2880}, {"CP", 3380}, {"TB", 0}, {"CB", 511}, {"RB", 1424}
+};
+
+static HostVirtual host;
+static bool host_ativo = true;
+static uint64_t iteracoes_loop = 0;
+
+//No ESP32 os registros são escritos por uma tarefa própria; aqui são escritos após cada loop(), fora do relógio virtual
+class SaidaRegistro : public Print
+{
+  public:
+    FILE *arquivo = nullptr;
+
+    size_t write(uint8_t caractere) override
+    {
+      return arquivo && fputc(caractere, arquivo) != EOF ? 1 : 0;
+    }
+    using Print::write;
+};
+
+static SaidaRegistro saida_registro;
+
+//Navegadores simulados no fluxo de eventos do painel, pelo loopback
+struct Espectador
+{
+  int descritor;
+  std::string pendente; //Ainda sem a linha em branco que fecha o evento
+  std::string ultimo_evento;
+  unsigned int eventos;
+  uint64_t bytes;
+};
+
+static std::vector<Espectador> espectadores;
+
+struct Aleatorio
+{
+  uint64_t estado;
+
+  uint64_t Proximo()
+  {
+    //splitmix64: mesma sequência em qualquer plataforma para uma mesma semente
+    uint64_t z = (estado += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+  unsigned int Entre(unsigned int minimo, unsigned int maximo)
+  {
+    return minimo + Proximo() % (maximo - minimo + 1);
+  }
+};
+
+//Conectados antes do setup(): esperam na fila do servidor até o firmware abrir o painel
+static void ConectaEspectadores(unsigned int quantidade, uint16_t porta)
+{
+  static const char pedido[] = "GET /eventos HTTP/1.1\r\nHost: 192.168.4.1\r\nAccept: text/event-stream\r\n\r\n";
+
+  for(unsigned int i = 0; i < quantidade; i++)
+  {
+    int descritor = socket(AF_INET, SOCK_STREAM, 0);
+
+    sockaddr_in endereco = {};
+    endereco.sin_family = AF_INET;
+    endereco.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    endereco.sin_port = htons(porta);
+
+    if(connect(descritor, (sockaddr *)&endereco, sizeof(endereco)) != 0)
+    {
+      perror("tix_sim: espectador");
+      exit(1);
+    }
+
+    send(descritor, pedido, sizeof(pedido) - 1, MSG_NOSIGNAL);
+    fcntl(descritor, F_SETFL, O_NONBLOCK);
+    espectadores.push_back({descritor, "", "", 0, 0});
+  }
+}
+
+static void DrenaEspectadores()
+{
+  char recebidos[1024];
+
+  for(Espectador &espectador : espectadores)
+  {
+    ssize_t tamanho;
+    while((tamanho = recv(espectador.descritor, recebidos, sizeof(recebidos), MSG_DONTWAIT)) > 0)
+    {
+      espectador.bytes += tamanho;
+      espectador.pendente.append(recebidos, tamanho);
+
+      size_t fim;
+      while((fim = espectador.pendente.find("\n\n")) != std::string::npos)
+      {
+        if(espectador.pendente.compare(0, 6, "data: ") == 0) //O primeiro bloco é o cabeçalho HTTP
+        {
+          espectador.ultimo_evento = espectador.pendente.substr(6, fim - 6);
+          espectador.eventos++;
+        }
+        espectador.pendente.erase(0, fim + 2);
+      }
+    }
+  }
+}
+
+static void MostraEspectadores()
+{
+  for(size_t i = 0; i < espectadores.size(); i++)
+    fprintf(stderr, "espectador %zu: %u eventos, %llu bytes, ultimo: %s\n", i, espectadores[i].eventos,
+            (unsigned long long)espectadores[i].bytes, espectadores[i].ultimo_evento.c_str());
+
+  ExecutaComando("?painel", saida_registro);
+}
+
+static void ExecutaLoop(unsigned int iteracoes = 1)
+{
+  for(unsigned int i = 0; i < iteracoes; i++)
+  {
+    loop();
+    iteracoes_loop++;
+
+    if(saida_registro.arquivo)
+      DrenaRegistro(saida_registro);
+    if(!espectadores.empty())
+      DrenaEspectadores();
+  }
+}
+
+static void PosicionaPeca(int casa, const std::string &peca)
+{
+  auto leitura = leituras_pecas.find(peca);
+
+  if(casa < 0 || casa > 7 || leitura == leituras_pecas.end())
+  {
+    fprintf(stderr, "tix_sim: casa ou peça inválida: %d %s\n", casa, peca.c_str());
+    return;
+  }
+
+  SimDefineAnalogico(pinos_casas[casa], leitura->second);
+}
+
+static void PosicionaTabuleiro(const Posicao &posicao)
+{
+  for(int i = 0; i < 8; i++)
+    PosicionaPeca(i, posicao[i]);
+}
+
+static void PressionaBotao(const std::string &botao, unsigned int iteracoes = 1)
+{
+  SimDefineDigital(pinos_botoes.at(botao), LOW);
+  ExecutaLoop(iteracoes);
+  SimDefineDigital(pinos_botoes.at(botao), HIGH);
+}
+
+static void MostraLcd(FILE *saida)
+{
+  fprintf(saida, "+--------------------+\n");
+  for(unsigned int linha = 0; linha < LCD_LINHAS; linha++)
+    fprintf(saida, "|%s|\n", SimLcdLinha(linha).c_str());
+  fprintf(saida, "+--------------------+\n");
+}
+
+static bool LcdContem(const char *texto)
+{
+  for(unsigned int linha = 0; linha < LCD_LINHAS; linha++)
+    if(SimLcdLinha(linha).find(texto) != std::string::npos)
+      return true;
+
+  return false;
+}
+
+static void ConfiguraHost()
+{
+  SimDefineResponder([](const std::string &linha)
+  {
+    if(linha.compare(0, 1, "{") == 0 || linha.compare(0, 6, "[\"t\", ") == 0) //Resposta a um comando de diagnóstico (envia ?rastro) ou telemetria
+    {
+      printf("%s\n", linha.c_str());
+      return;
+    }
+
+    if(!host_ativo)
+      return;
+
+    std::string resposta = host.ProcessaLinha(linha);
+    if(!resposta.empty())
+      SimEnviaAoFirmware(resposta);
+  });
+}
+
+static int ExecutaRoteiro(FILE *entrada)
+{
+  char linha[512];
+
+  while(fgets(linha, sizeof(linha), entrada))
+  {
+    char *comentario = strchr(linha, '#');
+    if(comentario)
+      *comentario = '\0';
+
+    std::string original = linha;
+    std::vector<std::string> partes;
+    for(char *parte = strtok(linha, " \t\r\n"); parte; parte = strtok(nullptr, " \t\r\n"))
+      partes.push_back(parte);
+
+    if(partes.empty())
+      continue;
+
+    const std::string &comando = partes[0];
+    unsigned int argumento = partes.size() > 1 ? strtoul(partes[1].c_str(), nullptr, 10) : 1;
+
+    if(comando == "tabuleiro" && partes.size() == 9)
+      PosicionaTabuleiro(Posicao(partes.begin() + 1, partes.end()));
+    else if(comando == "casa" && partes.size() == 3)
+      PosicionaPeca(argumento, partes[2]);
+    else if(comando == "analogico" && partes.size() == 3)
+      SimDefineAnalogico(argumento, strtoul(partes[2].c_str(), nullptr, 10));
+    else if(comando == "ruido")
+      SimDefineRuidoAnalogico(argumento, 1);
+    else if((comando == "botao" || comando == "segura" || comando == "solta") && partes.size() >= 2 && pinos_botoes.count(partes[1]))
+    {
+      if(comando == "botao")
+        PressionaBotao(partes[1], partes.size() > 2 ? strtoul(partes[2].c_str(), nullptr, 10) : 1);
+      else
+        SimDefineDigital(pinos_botoes.at(partes[1]), comando == "segura" ? LOW : HIGH);
+    }
+    else if(comando == "loop")
+      ExecutaLoop(argumento);
+    else if(comando == "espera")
+    {
+      uint64_t fim_us = SimTempoUs() + (uint64_t)argumento * 1000;
+      while(SimTempoUs() < fim_us)
+        ExecutaLoop();
+    }
+    else if(comando == "host" && partes.size() == 2)
+    {
+      host_ativo = partes[1] == "virtual";
+      host.Reinicia();
+    }
+    else if(comando == "cliente" && partes.size() == 2 && (partes[1] == "conectado" || partes[1] == "desconectado"))
+      SimDefineClienteConectado(partes[1] == "conectado");
+    else if(comando == "transporte" && partes.size() == 2 && (partes[1] == "bluetooth" || partes[1] == "wifi" || partes[1] == "automatico"))
+      SimDefineTransporteCanal(partes[1] == "bluetooth" ? SIM_TRANSPORTE_BLUETOOTH : partes[1] == "wifi" ? SIM_TRANSPORTE_WIFI : SIM_TRANSPORTE_AUTOMATICO);
+    else if(comando == "envia" && partes.size() >= 2)
+    {
+      std::string texto = partes[1];
+      for(size_t i = 2; i < partes.size(); i++)
+        texto += " " + partes[i];
+      SimEnviaAoFirmware(texto);
+    }
+    else if(comando == "serial")
+    {
+      size_t inicio = original.find(comando) + comando.size() + 1;
+      size_t fim = original.find_last_not_of("\r\n") + 1;
+      SimEnviaSerialUsb((fim > inicio ? original.substr(inicio, fim - inicio) : std::string()) + "\n");
+    }
+    else if(comando == "lcd")
+      MostraLcd(stdout);
+    else if((comando == "confere" || comando == "nao_confere") && partes.size() >= 2)
+    {
+      size_t inicio = original.find(comando) + comando.size() + 1;
+      std::string texto = original.substr(inicio, original.find_last_not_of(" \t\r\n") + 1 - inicio);
+
+      if(LcdContem(texto.c_str()) != (comando == "confere"))
+      {
+        fprintf(stderr, "tix_sim: o LCD %s \"%s\"\n", comando == "confere" ? "não mostra" : "mostra", texto.c_str());
+        MostraLcd(stderr);
+        return 1;
+      }
+    }
+    else if(comando == "confere_serial" && partes.size() >= 2)
+    {
+      size_t inicio = original.find(comando) + comando.size() + 1;
+      std::string texto = original.substr(inicio, original.find_last_not_of(" \t\r\n") + 1 - inicio);
+      std::string saida = SimConsomeSaidaDepuracao();
+
+      if(saida.find(texto) == std::string::npos)
+      {
+        fprintf(stderr, "tix_sim: a serial USB não escreveu \"%s\"; escreveu:\n%s", texto.c_str(), saida.c_str());
+        return 1;
+      }
+    }
+    else if(comando == "tempo")
+      printf("%.3f s\n", SimTempoUs() / 1e6);
+    else if(comando == "heap" && partes.size() == 3)
+      SimDefineHeap(argumento, strtoul(partes[2].c_str(), nullptr, 10));
+    else
+    {
+      fprintf(stderr, "tix_sim: comando inválido: %s\n", comando.c_str());
+      return 1;
+    }
+
+    fflush(stdout);
+  }
+
+  return 0;
+}
+
+//Navega até a tela de jogo e joga partidas com lances legais aleatórios até o fim (mate, empate ou tempo)
+static int JogaPartidas(unsigned int partidas, uint64_t semente, bool mostra_lcd)
+{
+  Aleatorio aleatorio = {semente};
+  unsigned int resultados[4] = {0, 0, 0, 0}; //Brancas, pretas, empate, interrompida
+  unsigned int lances_totais = 0;
+
+  ExecutaLoop(); //Menu inicial
+  PressionaBotao("centro"); //Jogador X Jogador
+  ExecutaLoop();
+  PressionaBotao("centro"); //Iniciar
+
+  for(unsigned int partida = 0; partida < partidas; partida++)
+  {
+    host.Reinicia();
+    SimLimpaCanal();
+    Posicao posicao = POSICAO_INICIAL;
+    PosicionaTabuleiro(posicao);
+    ExecutaLoop();
+
+    for(unsigned int lance = 0; lance < 1000 && !LcdContem("Vitoria") && !LcdContem("Empate"); lance++)
+    {
+      ExecutaLoop(aleatorio.Entre(0, 20)); //Tempo de reflexão
+
+      if(LcdContem("Vitoria") || LcdContem("Empate"))
+        break;
+
+      std::vector<Lance> lances = LancesLegais(posicao, host.cor_da_vez);
+      if(lances.empty())
+        break;
+
+      Lance escolhido = lances[aleatorio.Proximo() % lances.size()];
+      posicao[escolhido.destino] = posicao[escolhido.origem];
+      posicao[escolhido.origem] = "V";
+      PosicionaTabuleiro(posicao);
+
+      unsigned int aceitos = host.lances_aceitos;
+      PressionaBotao(host.cor_da_vez == 'B' ? "direita" : "esquerda");
+
+      if(host.lances_aceitos == aceitos && host.vencedor == '0') //Lance recusado, o jogador reconfere o tabuleiro e tenta de novo
+      {
+        posicao = host.posicao;
+        PosicionaTabuleiro(posicao);
+      }
+      else
+        lances_totais++;
+    }
+
+    ExecutaLoop();
+
+    if(mostra_lcd)
+      MostraLcd(stdout);
+
+    if(LcdContem("Vitoria Brancas"))
+      resultados[0]++;
+    else if(LcdContem("Vitoria Pretas"))
+      resultados[1]++;
+    else if(LcdContem("Empate"))
+      resultados[2]++;
+    else
+      resultados[3]++;
+
+    PressionaBotao("centro"); //Jogar novamente
+  }
+
+  printf("partidas: %u (brancas %u, pretas %u, empates %u, interrompidas %u)\n", partidas, resultados[0], resultados[1], resultados[2], resultados[3]);
+  printf("lances: %u\n", lances_totais);
+
+  return resultados[3] ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+  unsigned int partidas = 0;
+  uint64_t semente = 1;
+  unsigned int ruido = 0;
+  bool mostra_lcd = false;
+  const char *roteiro = nullptr;
+  const char *arquivo_nvs = nullptr;
+  uint16_t porta_painel = 0;
+  unsigned int quantidade_espectadores = 0;
+
+  for(int i = 1; i < argc; i++)
+  {
+    std::string opcao = argv[i];
+    const char *valor = i + 1 < argc ? argv[i + 1] : "";
+
+    if(opcao == "--partidas")
+      partidas = strtoul(argv[++i], nullptr, 10);
+    else if(opcao == "--semente")
+      semente = strtoull(argv[++i], nullptr, 10);
+    else if(opcao == "--ruido")
+      ruido = strtoul(argv[++i], nullptr, 10);
+    else if(opcao == "--script")
+      roteiro = argv[++i];
+    else if(opcao == "--nvs")
+      arquivo_nvs = argv[++i];
+    else if(opcao == "--velocidade")
+      SimDefineVelocidade(strtod(argv[++i], nullptr));
+    else if(opcao == "--latencia")
+    {
+      char *variacao = nullptr;
+      unsigned long latencia_ms = strtoul(argv[++i], &variacao, 10);
+      SimDefineLatenciaCanal(latencia_ms * 1000, *variacao == ':' ? strtoul(variacao + 1, nullptr, 10) * 1000 : 0);
+    }
+    else if(opcao == "--depuracao")
+    {
+      SimDefineSaidaDepuracao(stderr);
+      saida_registro.arquivo = stderr;
+    }
+    else if(opcao == "--lcd")
+      mostra_lcd = true;
+    else if(opcao == "--painel")
+      porta_painel = strtoul(argv[++i], nullptr, 10);
+    else if(opcao == "--espectadores")
+      quantidade_espectadores = strtoul(argv[++i], nullptr, 10);
+    else if(opcao == "--canal" && strncmp(valor, "tcp:", 4) == 0)
+      SimDefineCanal(CANAL_TCP, strtoul(argv[++i] + 4, nullptr, 10));
+    else if(opcao == "--canal" && strcmp(valor, "stdio") == 0)
+    {
+      SimDefineCanal(CANAL_STDIO);
+      i++;
+    }
+    else
+    {
+      fprintf(stderr, "uso: %s [--partidas N] [--semente S] [--ruido A] [--script arquivo|-] [--canal stdio|tcp:porta] [--velocidade X] [--latencia ms[:variacao]] [--nvs arquivo] [--depuracao] [--lcd] [--painel porta [--espectadores N]]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  if(quantidade_espectadores && !porta_painel)
+  {
+    fprintf(stderr, "tix_sim: --espectadores precisa de --painel\n");
+    return 1;
+  }
+
+  if(porta_painel)
+  {
+    SimRedirecionaPortaWifi(PORTA_PAINEL, porta_painel);
+    ConectaEspectadores(quantidade_espectadores, porta_painel);
+  }
+
+  if(arquivo_nvs)
+    SimCarregaNvs(arquivo_nvs);
+
+  SimDefineRuidoAnalogico(ruido, semente);
+  SimDefineLimiteBloqueio(60 * 1000000ull); //Um minuto virtual sem resposta do host é considerado travamento
+  ConfiguraHost();
+  PosicionaTabuleiro(POSICAO_INICIAL);
+
+  auto inicio = std::chrono::steady_clock::now();
+  int retorno = 0;
+
+  try
+  {
+    setup();
+
+    if(roteiro)
+    {
+      FILE *entrada = strcmp(roteiro, "-") == 0 ? stdin : fopen(roteiro, "r");
+      if(!entrada)
+      {
+        perror(roteiro);
+        return 1;
+      }
+      retorno = ExecutaRoteiro(entrada);
+    }
+    else if(partidas)
+      retorno = JogaPartidas(partidas, semente, mostra_lcd);
+  }
+  catch(const SimTravado &travado)
+  {
+    fprintf(stderr, "tix_sim: firmware bloqueado por %.1f s aguardando o host (t = %.3f s)\n", travado.tempo_us / 1e6, SimTempoUs() / 1e6);
+    MostraLcd(stderr);
+    retorno = 2;
+  }
+
+  double tempo_real = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+  double tempo_virtual = SimTempoUs() / 1e6;
+
+  fprintf(stderr, "iteracoes do loop(): %llu, tempo virtual: %.1f s, tempo real: %.3f s, aceleracao: %.0fx, %.0f iteracoes/s\n",
+          (unsigned long long)iteracoes_loop, tempo_virtual, tempo_real, tempo_virtual / tempo_real, iteracoes_loop / tempo_real);
+
+  if(!espectadores.empty())
+  {
+    saida_registro.arquivo = stderr;
+    MostraEspectadores();
+  }
+
+  if(arquivo_nvs)
+    SimSalvaNvs(arquivo_nvs);
+
+  return retorno;
+}
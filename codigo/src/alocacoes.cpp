@@ -0,0 +1,81 @@
+#include "alocacoes.h"
+
+#include <stdlib.h>
+#include <new>
+
+static volatile uint32_t quantidade_alocacoes = 0;
+
+uint32_t QuantidadeAlocacoes()
+{
+  return quantidade_alocacoes;
+}
+
+#if defined(TIX_SIMULADOR)
+
+#include "hal_sim.h"
+
+void *operator new(size_t tamanho)
+{
+  if(!SimAlocacoesIgnoradas()) //Estruturas internas do simulador, que não existem no ESP32
+    quantidade_alocacoes++;
+
+  void *memoria = malloc(tamanho ? tamanho : 1);
+  if(!memoria)
+    throw std::bad_alloc();
+
+  return memoria;
+}
+
+void *operator new[](size_t tamanho)
+{
+  return operator new(tamanho);
+}
+
+void operator delete(void *memoria) noexcept
+{
+  free(memoria);
+}
+
+void operator delete[](void *memoria) noexcept
+{
+  free(memoria);
+}
+
+void operator delete(void *memoria, size_t tamanho) noexcept
+{
+  free(memoria);
+}
+
+void operator delete[](void *memoria, size_t tamanho) noexcept
+{
+  free(memoria);
+}
+
+#elif defined(TIX_CONTA_ALOCACOES)
+
+extern "C"
+{
+  void *__real_malloc(size_t tamanho);
+  void *__real_realloc(void *memoria, size_t tamanho);
+  void *__real_calloc(size_t quantidade, size_t tamanho);
+
+  void *__wrap_malloc(size_t tamanho)
+  {
+    quantidade_alocacoes++;
+    return __real_malloc(tamanho);
+  }
+
+  void *__wrap_realloc(void *memoria, size_t tamanho)
+  {
+    quantidade_alocacoes++;
+    return __real_realloc(memoria, tamanho);
+  }
+
+  void *__wrap_calloc(size_t quantidade, size_t tamanho)
+  {
+    quantidade_alocacoes++;
+    return __real_calloc(quantidade, tamanho);
+  }
+}
+
+#endif
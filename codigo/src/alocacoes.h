@@ -0,0 +1,11 @@
+//Contador de alocações dinâmicas de memória (malloc/realloc/calloc e operator new)
+//
+//No ESP32 o contador só funciona quando o firmware é ligado com
+//"-Wl,--wrap=malloc -Wl,--wrap=realloc -Wl,--wrap=calloc" e TIX_CONTA_ALOCACOES definido (ambiente "bancada"
+//do platformio.ini), o que também captura as alocações da classe String. No simulador o operator new é
+//substituído, o que cobre std::vector, std::string e a String do simulador.
+#pragma once
+
+#include <stdint.h>
+
+uint32_t QuantidadeAlocacoes();
@@ -0,0 +1,140 @@
+#include "automatico.h"
+#include "regras.h"
+#include "estado_casas.h"
+
+#include <stdio.h>
+
+//A janela soma-se à confirmação da casa (estado_casas.h) e à ida e volta do rádio: acima de 150 ms o lance passaria
+//de LIMITE_LATENCIA_LANCE_AUTOMATICO_MS
+static const uint16_t janelas_ms[] = {0, 50, 100, 150};
+
+struct CandidatoLance
+{
+  bool valido;
+  bool enviado;
+  int8_t origem;
+  int8_t destino;
+  uint8_t eventos;
+  uint32_t desde_ms;
+};
+
+//Último reconhecimento: entre duas varreduras sem evento novo ele não muda, e a espera de uma janela varre as casas
+//muitas vezes sem que nada mude
+struct AvaliacaoLance
+{
+  bool valida;
+  bool legal;
+  uint32_t geracao;
+  LanceReconhecido lance;
+};
+
+static uint16_t janela_ms = JANELA_LANCE_AUTOMATICO_PADRAO_MS;
+static CandidatoLance candidato = {};
+static AvaliacaoLance avaliacao = {};
+static bool aguarda_posicao = false; //As casas ainda não mostraram a posição do início da vez depois do acorde
+static uint32_t lances = 0;
+static uint32_t acima_limite = 0;
+static uint64_t soma_latencias_ms = 0;
+static uint32_t latencia_maxima_ms = 0;
+
+void DefineJanelaLanceAutomatico(uint16_t janela)
+{
+  janela_ms = janela;
+}
+
+uint16_t JanelaLanceAutomatico()
+{
+  return janela_ms;
+}
+
+uint16_t ProximaJanelaLanceAutomatico()
+{
+  const unsigned int quantidade = sizeof(janelas_ms) / sizeof(janelas_ms[0]);
+
+  for(unsigned int i = 0; i < quantidade; i++)
+    if(janelas_ms[i] == janela_ms)
+      return janelas_ms[(i + 1) % quantidade];
+
+  return janelas_ms[0]; //Valor gravado que não é mais opção
+}
+
+void IniciaLanceAutomatico()
+{
+  candidato = {};
+  avaliacao = {};
+  aguarda_posicao = false;
+}
+
+void AguardaPosicaoLanceAutomatico()
+{
+  aguarda_posicao = true;
+}
+
+bool LanceAutomaticoPronto(const EstadoTabuleiro &anterior, const EstadoTabuleiro &atual, bool vez_brancas,
+                           uint32_t agora_ms, LanceReconhecido &lance)
+{
+  if(!CasasAssentadas())
+  {
+    candidato.valido = false;
+    return false;
+  }
+
+  if(aguarda_posicao) //Sem isso o retrato da posição de antes do acorde reenviaria o lance desfeito
+  {
+    if(atual != anterior)
+      return false;
+
+    aguarda_posicao = false;
+    IniciaReconhecimento(anterior); //Os eventos de devolver as peças não fazem parte do próximo lance
+    avaliacao = {};
+  }
+
+  if(!avaliacao.valida || avaliacao.geracao != GeracaoEventos())
+  {
+    avaliacao.lance = ReconheceLance(atual, vez_brancas);
+    avaliacao.legal = avaliacao.lance.resultado == LANCE_RECONHECIDO &&
+                      LanceLegal(anterior, avaliacao.lance.origem, avaliacao.lance.destino);
+    avaliacao.geracao = GeracaoEventos();
+    avaliacao.valida = true;
+  }
+
+  lance = avaliacao.lance;
+
+  if(!avaliacao.legal)
+  {
+    candidato.valido = false;
+    return false;
+  }
+
+  if(!candidato.valido || candidato.origem != lance.origem || candidato.destino != lance.destino ||
+     candidato.eventos != lance.eventos)
+    candidato = {true, false, lance.origem, lance.destino, lance.eventos, agora_ms};
+
+  if(candidato.enviado || agora_ms - candidato.desde_ms < janela_ms)
+    return false;
+
+  candidato.enviado = true;
+  return true;
+}
+
+void RegistraLanceAutomatico(uint32_t latencia_ms)
+{
+  lances++;
+  soma_latencias_ms += latencia_ms;
+  if(latencia_ms > latencia_maxima_ms)
+    latencia_maxima_ms = latencia_ms;
+  if(latencia_ms > LIMITE_LATENCIA_LANCE_AUTOMATICO_MS)
+    acima_limite++;
+}
+
+void EscreveLanceAutomatico(Print &saida)
+{
+  char texto[80];
+
+  snprintf(texto, sizeof(texto), "{\"janela_ms\": %u, \"lances\": %lu, \"latencia_media_ms\": %lu, ", janela_ms,
+           (unsigned long)lances, (unsigned long)(lances ? soma_latencias_ms / lances : 0));
+  saida.print(texto);
+  snprintf(texto, sizeof(texto), "\"latencia_maxima_ms\": %lu, \"acima_de_%u_ms\": %lu}", (unsigned long)latencia_maxima_ms,
+           LIMITE_LATENCIA_LANCE_AUTOMATICO_MS, (unsigned long)acima_limite);
+  saida.println(texto);
+}
@@ -0,0 +1,31 @@
+//Lance automático: o tabuleiro envia o lance sem o aperto do relógio
+//
+//Com a janela ligada, as casas são varridas a cada INTERVALO_AMOSTRAGEM_AUTOMATICA_MS enquanto o loop() esperaria os
+//botões. Quando todas as casas estão assentadas e os eventos desde o início da vez formam um lance reconhecido e
+//legal (regras.h), o lance vira candidato; se ele continuar o mesmo (origem, destino e quantidade de eventos) por
+//toda a janela, é enviado ao host como se o relógio tivesse sido apertado. Cada candidato é enviado uma vez só: um
+//lance recusado pelo host só é reenviado depois que alguma casa mudar de novo. Depois de desfazer ou refazer, as peças
+//ainda estão na posição anterior ao acorde: nada é enviado até as casas mostrarem a posição da vez ao menos uma vez.
+//
+//A latência de cada lance é medida da primeira leitura da peça na casa de destino (reconhecedor.h) até a resposta
+//do host, e fica em "?lance_automatico".
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include "tabuleiro.h"
+#include "reconhecedor.h"
+
+#define INTERVALO_AMOSTRAGEM_AUTOMATICA_MS 10
+#define LIMITE_LATENCIA_LANCE_AUTOMATICO_MS 300 //Da peça colocada até a vez trocar
+#define JANELA_LANCE_AUTOMATICO_PADRAO_MS 0 //Desligado: o relógio continua sendo o padrão
+
+void DefineJanelaLanceAutomatico(uint16_t janela_ms); //0 desliga
+uint16_t JanelaLanceAutomatico();
+uint16_t ProximaJanelaLanceAutomatico(); //Opções do menu, em ciclo: desligado, 50, 100 e 150 ms
+void IniciaLanceAutomatico(); //No início de cada vez
+void AguardaPosicaoLanceAutomatico(); //Depois de desfazer ou refazer
+bool LanceAutomaticoPronto(const EstadoTabuleiro &anterior, const EstadoTabuleiro &atual, bool vez_brancas,
+                           uint32_t agora_ms, LanceReconhecido &lance);
+void RegistraLanceAutomatico(uint32_t latencia_ms);
+void EscreveLanceAutomatico(Print &saida); //"?lance_automatico"
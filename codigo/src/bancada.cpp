@@ -0,0 +1,158 @@
+#include "bancada.h"
+#include "alocacoes.h"
+#include "lcd_medido.h"
+#include "registro.h"
+#include "menus.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <string.h>
+
+#ifndef TIX_VERSAO
+#define TIX_VERSAO "desconhecida"
+#endif
+
+#define MAXIMO_AMOSTRAS 500
+
+//Estado e funções do firmware (main.cpp)
+extern LcdMedido lcd;
+extern bool primeiro_loop;
+extern bool tabuleiro_conferido;
+extern unsigned int opcao_selecionada;
+extern unsigned int tempo_restante_brancas;
+extern char mensagem_recebida[];
+void CapturaEstadoAtual();
+void EnviaMensagem();
+void AnalisaMensagemRecebida();
+void PrintaTempo(unsigned int linha, unsigned int coluna, unsigned int tempo);
+void ResetaVariaveis();
+bool IniciaPartidaConferida();
+void loop();
+
+struct CasoBancada
+{
+  const char *nome;
+  void (*funcao)();
+  bool (*preparo)(); //Executado antes de cada chamada, fora da medição; false se a função não pode ser medida
+  unsigned int chamadas;
+};
+
+static uint32_t amostras_ciclos[MAXIMO_AMOSTRAS];
+static uint32_t amostras_us[MAXIMO_AMOSTRAS];
+
+static bool PreparaMensagemRecebida()
+{
+  strcpy(mensagem_recebida, "[1, 0]");
+  return true;
+}
+
+static void PrintaTempoBrancas()
+{
+  PrintaTempo(12, 1, tempo_restante_brancas);
+}
+
+//Sem o tabuleiro conferido o loop() iria para a conferência e a medição seria a daquela tela, não a da partida
+static bool PreparaPartida()
+{
+  if(opcao_selecionada != INICIAR_JOGADOR_VS_JOGADOR || !tabuleiro_conferido)
+    IniciaPartidaConferida();
+
+  return opcao_selecionada == INICIAR_JOGADOR_VS_JOGADOR && tabuleiro_conferido;
+}
+
+//Os números de chamadas são baixos porque cada passagem do loop() inclui o delay(150) do LeBotoes()
+//e o AnalisaMensagemRecebida() toca os sons do lance
+static const CasoBancada casos[] = {
+  {"CapturaEstadoAtual", CapturaEstadoAtual, nullptr, 100},
+  {"EnviaMensagem", EnviaMensagem, nullptr, 200},
+  {"AnalisaMensagemRecebida", AnalisaMensagemRecebida, PreparaMensagemRecebida, 30},
+  {"PrintaTempo", PrintaTempoBrancas, nullptr, 200},
+  {"loop", loop, PreparaPartida, 30},
+};
+
+static void PrintaEstatisticas(Print &saida, const char *unidade, uint32_t *amostras, unsigned int quantidade)
+{
+  std::sort(amostras, amostras + quantidade);
+
+  saida.print("\"");
+  saida.print(unidade);
+  saida.print("\": {\"min\": ");
+  saida.print(amostras[0]);
+  saida.print(", \"mediana\": ");
+  saida.print(amostras[quantidade / 2]);
+  saida.print(", \"p99\": ");
+  saida.print(amostras[(quantidade * 99) / 100 < quantidade ? (quantidade * 99) / 100 : quantidade - 1]);
+  saida.print("}");
+}
+
+bool ExecutaBancada(Print &saida)
+{
+  unsigned int quantidade_casos = sizeof(casos) / sizeof(casos[0]);
+  bool sucesso = true;
+
+  saida.println();
+  saida.print("{\"versao\": \"");
+  saida.print(TIX_VERSAO);
+  saida.print("\", \"alvo\": \"");
+  saida.print(ESP.getChipModel());
+  saida.print("\", \"frequencia_mhz\": ");
+  saida.print(ESP.getCpuFreqMHz());
+  saida.println(", \"funcoes\": [");
+
+  for(unsigned int i = 0; i < quantidade_casos; i++)
+  {
+    const CasoBancada &caso = casos[i];
+    unsigned int chamadas = caso.chamadas < MAXIMO_AMOSTRAS ? caso.chamadas : MAXIMO_AMOSTRAS;
+    uint32_t alocacoes = 0;
+
+    unsigned int j = 0;
+
+    for(; j < chamadas; j++)
+    {
+      if(caso.preparo && !caso.preparo())
+        break;
+
+      uint32_t alocacoes_inicio = QuantidadeAlocacoes();
+      uint32_t inicio_us = micros();
+      uint32_t inicio_ciclos = ESP.getCycleCount();
+
+      caso.funcao();
+
+      amostras_ciclos[j] = ESP.getCycleCount() - inicio_ciclos;
+      amostras_us[j] = micros() - inicio_us;
+      alocacoes += QuantidadeAlocacoes() - alocacoes_inicio;
+    }
+
+    saida.print("  {\"nome\": \"");
+    saida.print(caso.nome);
+
+    if(j < chamadas) //Um número medido em outro estado seria comparado como se fosse desta função
+    {
+      REGISTRA_ERRO("Bancada: caso %d nao pode ser medido (preparo falhou na chamada %d)", i, j);
+      saida.print("\", \"erro\": \"preparo falhou na chamada ");
+      saida.print(j);
+      saida.println(i + 1 < quantidade_casos ? "\"}," : "\"}");
+      sucesso = false;
+      continue;
+    }
+
+    saida.print("\", \"chamadas\": ");
+    saida.print(chamadas);
+    saida.print(", ");
+    PrintaEstatisticas(saida, "ciclos", amostras_ciclos, chamadas);
+    saida.print(", ");
+    PrintaEstatisticas(saida, "us", amostras_us, chamadas);
+    saida.print(", \"alocacoes_por_chamada\": ");
+    saida.print((double)alocacoes / chamadas, 2);
+    saida.println(i + 1 < quantidade_casos ? "}," : "}");
+  }
+
+  saida.println("]}");
+
+  //Volta ao menu inicial como se o tabuleiro tivesse acabado de ligar
+  ResetaVariaveis();
+  opcao_selecionada = MENU_INICIAL;
+  primeiro_loop = true;
+  lcd.clear();
+  return sucesso;
+}
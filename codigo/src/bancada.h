@@ -0,0 +1,10 @@
+//Microbenchmark das funções do caminho crítico do firmware (captura, protocolo, LCD e uma passagem do loop)
+//
+//No ESP32 é executado ao fim do setup() quando o firmware é compilado com TIX_BANCADA (ambiente "bancada" do
+//platformio.ini), no computador pelo executável tix_bancada do simulador. O resultado é um objeto JSON com
+//mínimo, mediana e p99 em ciclos do processador e em microssegundos, e alocações de memória por chamada.
+#pragma once
+
+#include <Print.h>
+
+bool ExecutaBancada(Print &saida); //false se alguma função não pôde ser medida (a linha dela traz "erro")
@@ -0,0 +1,358 @@
+#include "calibracao.h"
+#include "limiares_adc.h"
+#include "registro.h"
+
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CHAVE_CALIBRACAO "calibracao"
+#define VERSAO_CALIBRACAO 1
+#define DENSIDADE_FORA_DAS_PECAS (1.0f / 4096) //Leitura que não é de peça alguma: qualquer código com a mesma chance
+#define DESVIOS_DENSIDADE_DESPREZIVEL 8 //Além disso a densidade de uma peça é menos de 1e-11 da DENSIDADE_FORA_DAS_PECAS
+#define CONFIANCA_PENDENTE 0xFF //Leitura classificada cuja confiança ainda não foi pedida
+#define SEM_JANELA 0xFF
+
+struct EstatisticaPeca
+{
+  uint16_t media;
+  uint16_t desvio;
+};
+
+struct PerfilCalibracao
+{
+  uint32_t versao;
+  EstatisticaPeca pecas[QUANTIDADE_CASAS][QUANTIDADE_PECAS];
+};
+
+struct Acumulador
+{
+  uint32_t quantidade;
+  uint32_t soma;
+  uint64_t soma_quadrados;
+};
+
+static PerfilCalibracao perfil;
+static bool perfil_salvo = false;
+static JanelaPeca janelas[QUANTIDADE_CASAS][QUANTIDADE_PECAS]; //Em ordem crescente de leitura
+static uint8_t janelas_pecas[QUANTIDADE_CASAS][QUANTIDADE_PECAS]; //Índice em janelas[casa] de cada peça, ou SEM_JANELA
+static bool janelas_disjuntas[QUANTIDADE_CASAS]; //A janela que contém a leitura é a que a busca em ordem acharia
+static Preferences *nvs = nullptr;
+static Acumulador acumuladores[QUANTIDADE_CASAS][QUANTIDADE_PECAS];
+
+//Última leitura classificada de cada casa, para o comando "?casas"
+static uint16_t ultimas_leituras[QUANTIDADE_CASAS];
+static Peca ultimas_pecas[QUANTIDADE_CASAS];
+static uint8_t ultimas_confiancas[QUANTIDADE_CASAS]; //CONFIANCA_PENDENTE até ConfiancaCasa()
+
+//A cada varredura cada casa é conferida contra a janela da peça estável e da última peça lida: sem procurar
+static void IndexaJanelas(uint8_t casa)
+{
+  memset(janelas_pecas[casa], SEM_JANELA, sizeof(janelas_pecas[casa]));
+  janelas_disjuntas[casa] = true;
+
+  for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+  {
+    const JanelaPeca &janela = janelas[casa][i];
+
+    if(janela.peca < QUANTIDADE_PECAS && janelas_pecas[casa][janela.peca] == SEM_JANELA)
+      janelas_pecas[casa][janela.peca] = i;
+    if(janela.minimo > janela.maximo || (i > 0 && janela.minimo <= janelas[casa][i - 1].maximo))
+      janelas_disjuntas[casa] = false;
+  }
+}
+
+static void UsaTabelaNominal()
+{
+  perfil.versao = VERSAO_CALIBRACAO;
+
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+    for(size_t i = 0; i < QUANTIDADE_JANELAS; i++)
+    {
+      const JanelaPeca &nominal = JANELAS_PECAS.janelas[i];
+
+      janelas[casa][i] = nominal;
+      perfil.pecas[casa][nominal.peca].media = nominal.esperado;
+      perfil.pecas[casa][nominal.peca].desvio = DESVIO_NOMINAL;
+    }
+
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+    IndexaJanelas(casa);
+
+  perfil_salvo = false;
+}
+
+//Ponto entre duas médias à mesma distância em desvios padrão de cada uma
+static uint16_t Fronteira(const EstatisticaPeca &a, const EstatisticaPeca &b)
+{
+  return (uint16_t)(((uint32_t)a.media * b.desvio + (uint32_t)b.media * a.desvio) / (a.desvio + b.desvio));
+}
+
+static void OrdenaPorMedia(uint8_t casa, Peca ordem[QUANTIDADE_PECAS])
+{
+  for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+  {
+    Peca atual = (Peca)i;
+    int j = i - 1;
+
+    for(; j >= 0 && perfil.pecas[casa][ordem[j]].media > perfil.pecas[casa][atual].media; j--)
+      ordem[j + 1] = ordem[j];
+    ordem[j + 1] = atual;
+  }
+}
+
+static void CalculaJanelas(uint8_t casa)
+{
+  Peca ordem[QUANTIDADE_PECAS];
+  OrdenaPorMedia(casa, ordem);
+
+  for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+  {
+    const EstatisticaPeca &atual = perfil.pecas[casa][ordem[i]];
+    int32_t minimo = (int32_t)atual.media - DESVIOS_JANELA * atual.desvio;
+    int32_t maximo = (int32_t)atual.media + DESVIOS_JANELA * atual.desvio;
+
+    if(i > 0)
+    {
+      int32_t fronteira = Fronteira(perfil.pecas[casa][ordem[i - 1]], atual) + FAIXA_GUARDA / 2;
+      minimo = fronteira > minimo ? fronteira : minimo;
+    }
+    if(i + 1 < QUANTIDADE_PECAS)
+    {
+      int32_t fronteira = Fronteira(atual, perfil.pecas[casa][ordem[i + 1]]) - FAIXA_GUARDA / 2;
+      maximo = fronteira < maximo ? fronteira : maximo;
+    }
+
+    janelas[casa][i].peca = ordem[i];
+    janelas[casa][i].esperado = atual.media;
+    janelas[casa][i].minimo = minimo < 0 ? 0 : minimo;
+    janelas[casa][i].maximo = maximo > 4095 ? 4095 : maximo;
+  }
+
+  IndexaJanelas(casa);
+}
+
+void CarregaCalibracao(Preferences &preferencias)
+{
+  nvs = &preferencias;
+
+  if(preferencias.getBytesLength(CHAVE_CALIBRACAO) == sizeof(perfil) &&
+     preferencias.getBytes(CHAVE_CALIBRACAO, &perfil, sizeof(perfil)) == sizeof(perfil) && perfil.versao == VERSAO_CALIBRACAO)
+  {
+    for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+      CalculaJanelas(casa);
+
+    perfil_salvo = true;
+    REGISTRA_INFO("Calibracao: perfil da NVS carregado");
+  }
+  else
+    UsaTabelaNominal();
+}
+
+bool CalibracaoSalva()
+{
+  return perfil_salvo;
+}
+
+static float Densidade(const EstatisticaPeca &estatistica, uint16_t leitura)
+{
+  float z = ((float)leitura - estatistica.media) / estatistica.desvio;
+  return expf(-0.5f * z * z) / (estatistica.desvio * 2.5066283f); //sqrt(2 pi)
+}
+
+static uint8_t Confianca(uint8_t casa, uint16_t leitura, Peca peca)
+{
+  float total = DENSIDADE_FORA_DAS_PECAS;
+  float reconhecida = 0;
+
+  for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+  {
+    const EstatisticaPeca &estatistica = perfil.pecas[casa][i];
+    if(abs((int32_t)leitura - estatistica.media) > DESVIOS_DENSIDADE_DESPREZIVEL * estatistica.desvio)
+      continue; //Só as peças vizinhas da leitura contam: as outras nem chegam ao arredondamento
+
+    float densidade = Densidade(estatistica, leitura);
+    total += densidade;
+    if(i == peca)
+      reconhecida = densidade;
+  }
+
+  return (uint8_t)(100 * reconhecida / total + 0.5f);
+}
+
+Peca ClassificaCasa(uint8_t casa, uint16_t leitura)
+{
+  Peca peca = VAZIO; //Fora de todas as janelas, como na tabela nominal
+  uint8_t anterior = janelas_pecas[casa][ultimas_pecas[casa]];
+
+  if(janelas_disjuntas[casa] && anterior != SEM_JANELA && leitura >= janelas[casa][anterior].minimo &&
+     leitura <= janelas[casa][anterior].maximo) //O caso comum: a mesma peça da última leitura
+    peca = ultimas_pecas[casa];
+  else
+  {
+    for(uint8_t i = 0; i < QUANTIDADE_PECAS && leitura >= janelas[casa][i].minimo; i++)
+      if(leitura <= janelas[casa][i].maximo)
+      {
+        peca = janelas[casa][i].peca;
+        break;
+      }
+  }
+
+  ultimas_leituras[casa] = leitura;
+  ultimas_pecas[casa] = peca;
+  ultimas_confiancas[casa] = CONFIANCA_PENDENTE;
+
+  return peca;
+}
+
+uint8_t ConfiancaCasa(uint8_t casa)
+{
+  if(ultimas_confiancas[casa] == CONFIANCA_PENDENTE)
+    ultimas_confiancas[casa] = Confianca(casa, ultimas_leituras[casa], ultimas_pecas[casa]);
+
+  return ultimas_confiancas[casa];
+}
+
+bool LeituraNaJanela(uint8_t casa, uint16_t leitura, Peca peca, uint16_t margem)
+{
+  uint8_t i = peca < QUANTIDADE_PECAS ? janelas_pecas[casa][peca] : SEM_JANELA;
+
+  if(i == SEM_JANELA)
+    return false;
+
+  return leitura + margem >= janelas[casa][i].minimo && leitura <= janelas[casa][i].maximo + margem;
+}
+
+Peca PecaPassoCalibracao(uint8_t passo, uint8_t casa)
+{
+  return ESTADO_INICIAL[(casa + passo) % QUANTIDADE_CASAS];
+}
+
+void IniciaCalibracao()
+{
+  memset(acumuladores, 0, sizeof(acumuladores));
+}
+
+void AcumulaCalibracao(uint8_t passo, uint8_t casa, uint16_t leitura)
+{
+  Acumulador &acumulador = acumuladores[casa][PecaPassoCalibracao(passo, casa)];
+
+  acumulador.quantidade++;
+  acumulador.soma += leitura;
+  acumulador.soma_quadrados += (uint32_t)leitura * leitura;
+}
+
+ResultadoCalibracao ConcluiCalibracao()
+{
+  PerfilCalibracao novo;
+  ResultadoCalibracao resultado = {true, 0, VAZIO, VAZIO, 0xFFFF};
+
+  novo.versao = VERSAO_CALIBRACAO;
+
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+    for(uint8_t peca = 0; peca < QUANTIDADE_PECAS; peca++)
+    {
+      const Acumulador &acumulador = acumuladores[casa][peca];
+      float media = acumulador.quantidade ? (float)acumulador.soma / acumulador.quantidade : 0;
+      float variancia = acumulador.quantidade ? (float)acumulador.soma_quadrados / acumulador.quantidade - media * media : 0;
+      float desvio = variancia > 0 ? sqrtf(variancia) : 0;
+
+      novo.pecas[casa][peca].media = (uint16_t)(media + 0.5f);
+      novo.pecas[casa][peca].desvio = desvio < DESVIO_MINIMO_CALIBRACAO ? DESVIO_MINIMO_CALIBRACAO : (uint16_t)(desvio + 0.5f);
+    }
+
+  //Par de peças mais próximo entre si em cada casa, em desvios padrão somados
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+  {
+    Peca ordem[QUANTIDADE_PECAS];
+    PerfilCalibracao anterior = perfil;
+
+    perfil = novo;
+    OrdenaPorMedia(casa, ordem);
+    perfil = anterior;
+
+    for(uint8_t i = 1; i < QUANTIDADE_PECAS; i++)
+    {
+      const EstatisticaPeca &a = novo.pecas[casa][ordem[i - 1]];
+      const EstatisticaPeca &b = novo.pecas[casa][ordem[i]];
+      uint32_t separacao = (uint32_t)(b.media - a.media) * 10 / (a.desvio + b.desvio);
+
+      if(separacao < resultado.separacao_decimos)
+      {
+        resultado.separacao_decimos = separacao;
+        resultado.casa = casa;
+        resultado.peca_a = ordem[i - 1];
+        resultado.peca_b = ordem[i];
+      }
+    }
+  }
+
+  resultado.valida = resultado.separacao_decimos >= SEPARACAO_MINIMA_CALIBRACAO * 10;
+
+  if(!resultado.valida)
+  {
+    REGISTRA_AVISO("Calibracao reprovada: casa %d, pecas %d e %d separadas por %d decimos de desvio", resultado.casa,
+                   resultado.peca_a, resultado.peca_b, resultado.separacao_decimos);
+    return resultado;
+  }
+
+  perfil = novo;
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+    CalculaJanelas(casa);
+  perfil_salvo = true;
+
+  if(nvs)
+    nvs->putBytes(CHAVE_CALIBRACAO, &perfil, sizeof(perfil));
+
+  REGISTRA_INFO("Calibracao salva: menor separacao %d decimos de desvio (casa %d)", resultado.separacao_decimos, resultado.casa);
+  return resultado;
+}
+
+void ApagaCalibracao()
+{
+  if(nvs)
+    nvs->remove(CHAVE_CALIBRACAO);
+
+  UsaTabelaNominal();
+}
+
+void EscreveCalibracao(Print &saida)
+{
+  char texto[96];
+
+  saida.print(perfil_salvo ? "{\"perfil\": \"salvo\", \"casas\": [" : "{\"perfil\": \"nominal\", \"casas\": [");
+
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+  {
+    saida.print(casa == 0 ? "{" : ", {");
+
+    for(uint8_t i = 0; i < QUANTIDADE_PECAS; i++)
+    {
+      const JanelaPeca &janela = janelas[casa][i];
+      const EstatisticaPeca &estatistica = perfil.pecas[casa][janela.peca];
+
+      snprintf(texto, sizeof(texto), "%s\"%s\": {\"media\": %u, \"desvio\": %u, \"min\": %u, \"max\": %u}", i == 0 ? "" : ", ",
+               NomePeca(janela.peca), estatistica.media, estatistica.desvio, janela.minimo, janela.maximo);
+      saida.print(texto);
+    }
+
+    saida.print("}");
+  }
+
+  saida.println("]}");
+}
+
+void EscreveCasas(Print &saida)
+{
+  char texto[64];
+
+  saida.print("{\"casas\": [");
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+  {
+    snprintf(texto, sizeof(texto), "%s{\"leitura\": %u, \"peca\": \"%s\", \"confianca\": %u}", casa == 0 ? "" : ", ",
+             ultimas_leituras[casa], NomePeca(ultimas_pecas[casa]), ConfiancaCasa(casa));
+    saida.print(texto);
+  }
+  saida.println("]}");
+}
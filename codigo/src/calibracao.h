@@ -0,0 +1,51 @@
+//Calibração por casa das leituras de cada peça, com perfil salvo na NVS e confiança de cada leitura
+//
+//O assistente tem PASSOS_CALIBRACAO passos: no passo k a casa i deve ter a peça ESTADO_INICIAL[(i + k) % 8], ou seja,
+//começa na posição inicial e a cada passo todas as peças andam uma casa para a esquerda (a da casa 0 vai para a 7).
+//Ao fim cada peça passou por todas as casas e cada casa ficou vazia duas vezes. Cada passo acumula
+//AMOSTRAS_CALIBRACAO leituras por casa; a média e o desvio padrão de cada (casa, peça) definem as fronteiras de
+//decisão daquela casa: entre duas peças vizinhas a fronteira fica no ponto equidistante em desvios padrão das duas
+//médias, e cada janela vai no máximo até DESVIOS_JANELA desvios da média.
+//
+//Sem perfil salvo o classificador usa a tabela nominal de limiares_adc.h em todas as casas. A confiança de uma
+//leitura (0 a 100) é a probabilidade a posteriori da peça reconhecida, com uma gaussiana por peça e uma densidade
+//uniforme para leituras que não são de peça alguma.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include <Preferences.h>
+#include "tabuleiro.h"
+
+#define AMOSTRAS_CALIBRACAO 64
+#define INTERVALO_AMOSTRAS_CALIBRACAO_MS 4 //Espalha as amostras por ~1/4 s para pegar o ruído da rede e da fonte
+#define PASSOS_CALIBRACAO QUANTIDADE_CASAS
+#define DESVIO_MINIMO_CALIBRACAO 4 //Ruído de quantização: evita janelas de largura zero se as leituras forem constantes
+#define DESVIO_NOMINAL 70 //Desvio assumido para a tabela nominal (MEIA_JANELA_MAXIMA / 3)
+#define DESVIOS_JANELA 5
+#define SEPARACAO_MINIMA_CALIBRACAO 6 //Distância mínima entre duas médias, em desvios padrão somados das duas peças
+
+struct ResultadoCalibracao
+{
+  bool valida;
+  uint8_t casa; //Casa e peças mais próximas entre si (a que reprovou, se inválida)
+  Peca peca_a;
+  Peca peca_b;
+  uint16_t separacao_decimos; //Distância entre as médias das duas peças em décimos de desvio padrão somado
+};
+
+void CarregaCalibracao(Preferences &preferencias); //No setup(), com a NVS já aberta
+bool CalibracaoSalva();
+Peca ClassificaCasa(uint8_t casa, uint16_t leitura);
+uint8_t ConfiancaCasa(uint8_t casa); //Da última leitura classificada; calculada só quando pedida, e uma vez
+bool LeituraNaJanela(uint8_t casa, uint16_t leitura, Peca peca, uint16_t margem); //Janela da peça alargada pela margem
+
+//Assistente
+Peca PecaPassoCalibracao(uint8_t passo, uint8_t casa);
+void IniciaCalibracao();
+void AcumulaCalibracao(uint8_t passo, uint8_t casa, uint16_t leitura);
+ResultadoCalibracao ConcluiCalibracao(); //Se válida, passa a usar e salva na NVS
+
+void EscreveCalibracao(Print &saida); //Resposta JSON do comando "?calibracao"
+void ApagaCalibracao(); //Volta para a tabela nominal e apaga o perfil da NVS
+void EscreveCasas(Print &saida); //Resposta JSON do comando "?casas": última leitura, peça e confiança de cada casa
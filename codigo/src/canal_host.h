@@ -0,0 +1,57 @@
+//Canal com o host: Stream que encaminha para o transporte do cliente conectado
+//
+//O protocolo (mensagens de lance, respostas, comandos "?...") e a tarefa de comunicação usam só este canal, sem
+//saber por qual rádio o host está falando. Sem cliente, o canal é o do TRANSPORTE_PADRAO da variante.
+//
+//O stream é escolhido a cada escrita, e um println() são duas. O transporte só muda na tarefa de comunicação com o
+//rádio travado (AtendeConexao, conexao.h), então uma linha escrita entre TravaRadio e LiberaRadio (tarefas.h) vai
+//inteira pelo mesmo rádio, que também não é desligado no meio dela.
+#pragma once
+
+#include <Stream.h>
+#include "transportes.h"
+#include "conexao.h"
+
+class CanalHost : public Stream
+{
+  public:
+    void Adiciona(uint8_t transporte, Stream &stream) //No setup(), para cada rádio da variante
+    {
+      streams[transporte] = &stream;
+    }
+
+    size_t write(uint8_t caractere) override
+    {
+      return Atual().write(caractere);
+    }
+
+    size_t write(const uint8_t *buffer, size_t tamanho) override
+    {
+      return Atual().write(buffer, tamanho);
+    }
+    using Print::write;
+
+    int available() override
+    {
+      return Atual().available();
+    }
+
+    int read() override
+    {
+      return Atual().read();
+    }
+
+    int peek() override
+    {
+      return Atual().peek();
+    }
+
+  private:
+    Stream *streams[QUANTIDADE_TRANSPORTES] = {};
+
+    Stream &Atual()
+    {
+      uint8_t transporte = TransporteConectado();
+      return *streams[transporte == SEM_TRANSPORTE ? TRANSPORTE_PADRAO : transporte];
+    }
+};
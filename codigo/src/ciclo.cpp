@@ -0,0 +1,236 @@
+#include "ciclo.h"
+#include "registro.h"
+#include "tarefas.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#define FASE_FORA_DE_TRECHOS "loop"
+
+//Iteração em andamento (lidos também pelo vigia, em outra tarefa)
+static volatile bool em_iteracao = false;
+static volatile bool vigia_avisou = false;
+static volatile uint32_t inicio_iteracao_us = 0;
+static const char *volatile fase_atual = FASE_FORA_DE_TRECHOS;
+
+static const char *pilha_fases[PROFUNDIDADE_MAXIMA_FASES];
+static unsigned int profundidade_fases = 0;
+static uint32_t inicio_fase_us = 0;
+static const char *fase_mais_demorada_iteracao = FASE_FORA_DE_TRECHOS;
+static uint32_t tempo_fase_mais_demorada_iteracao_us = 0;
+
+//Estatísticas acumuladas
+static uint32_t iteracoes = 0;
+static uint64_t soma_us = 0;
+static uint32_t minimo_us = 0;
+static uint32_t maximo_us = 0;
+static uint32_t lentas = 0;
+static uint32_t travadas = 0;
+static const char *fase_mais_lenta = FASE_FORA_DE_TRECHOS;
+static uint32_t tempo_fase_mais_lenta_us = 0;
+
+//Taxas, recalculadas a cada segundo
+static uint32_t varreduras = 0;
+static uint32_t bytes_lcd = 0;
+static uint32_t varreduras_por_segundo = 0;
+static uint32_t bytes_lcd_por_segundo = 0;
+static uint32_t inicio_janela_us = 0;
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+static TaskHandle_t tarefa_loop = NULL;
+
+static void Vigia(void *parametro)
+{
+  if(!em_iteracao || vigia_avisou || micros() - inicio_iteracao_us < LIMITE_VIGIA_LOOP_MS * 1000UL)
+    return;
+
+  vigia_avisou = true;
+  REGISTRA_TEXTO_AVISO("Vigia: loop() parado em %s", fase_atual);
+}
+
+#endif
+
+void IniciaCiclo()
+{
+  inicio_janela_us = micros();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  tarefa_loop = xTaskGetCurrentTaskHandle();
+
+  esp_timer_create_args_t argumentos = {};
+  esp_timer_handle_t temporizador;
+  argumentos.callback = Vigia;
+  argumentos.name = "vigia";
+
+  if(esp_timer_create(&argumentos, &temporizador) == ESP_OK)
+    esp_timer_start_periodic(temporizador, PERIODO_VIGIA_LOOP_MS * 1000ULL);
+#endif
+}
+
+static bool NaTarefaLoop()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  return xTaskGetCurrentTaskHandle() == tarefa_loop;
+#else
+  return true;
+#endif
+}
+
+//Atribui o tempo desde o último evento à fase que estava em execução
+static void EncerraTrechoFase(uint32_t agora_us)
+{
+  uint32_t tempo_us = agora_us - inicio_fase_us;
+
+  if(tempo_us > tempo_fase_mais_demorada_iteracao_us)
+  {
+    tempo_fase_mais_demorada_iteracao_us = tempo_us;
+    fase_mais_demorada_iteracao = fase_atual;
+  }
+
+  inicio_fase_us = agora_us;
+}
+
+void EntraFase(const char *fase)
+{
+  if(!em_iteracao || !NaTarefaLoop())
+    return;
+
+  EncerraTrechoFase(micros());
+
+  if(profundidade_fases < PROFUNDIDADE_MAXIMA_FASES)
+    pilha_fases[profundidade_fases] = fase;
+  profundidade_fases++;
+  fase_atual = fase;
+}
+
+void SaiFase()
+{
+  if(!em_iteracao || !NaTarefaLoop() || profundidade_fases == 0)
+    return;
+
+  EncerraTrechoFase(micros());
+
+  profundidade_fases--;
+  if(profundidade_fases == 0)
+    fase_atual = FASE_FORA_DE_TRECHOS;
+  else if(profundidade_fases <= PROFUNDIDADE_MAXIMA_FASES)
+    fase_atual = pilha_fases[profundidade_fases - 1];
+}
+
+void InicioIteracao()
+{
+  uint32_t agora_us = micros();
+
+  profundidade_fases = 0;
+  fase_atual = FASE_FORA_DE_TRECHOS;
+  fase_mais_demorada_iteracao = FASE_FORA_DE_TRECHOS;
+  tempo_fase_mais_demorada_iteracao_us = 0;
+  inicio_fase_us = agora_us;
+  inicio_iteracao_us = agora_us;
+  vigia_avisou = false;
+  em_iteracao = true;
+}
+
+void FimIteracao()
+{
+  uint32_t agora_us = micros();
+  uint32_t duracao_us = agora_us - inicio_iteracao_us;
+
+  EncerraTrechoFase(agora_us);
+  em_iteracao = false;
+  ContaIteracaoLoop(duracao_us);
+
+  if(iteracoes == 0 || duracao_us < minimo_us)
+    minimo_us = duracao_us;
+  if(duracao_us > maximo_us)
+  {
+    maximo_us = duracao_us;
+    fase_mais_lenta = fase_mais_demorada_iteracao;
+    tempo_fase_mais_lenta_us = tempo_fase_mais_demorada_iteracao_us;
+  }
+  iteracoes++;
+  soma_us += duracao_us;
+
+  if(duracao_us > LIMITE_ITERACAO_LENTA_MS * 1000UL)
+    lentas++;
+
+  if(duracao_us > LIMITE_VIGIA_LOOP_MS * 1000UL)
+  {
+    travadas++;
+    REGISTRA_AVISO("Loop: iteracao de %d ms, %d ms seguidos na fase abaixo", duracao_us / 1000, tempo_fase_mais_demorada_iteracao_us / 1000);
+    REGISTRA_TEXTO_AVISO("Loop: fase mais demorada %s", fase_mais_demorada_iteracao);
+  }
+
+  uint32_t janela_us = agora_us - inicio_janela_us;
+  if(janela_us >= 1000000UL)
+  {
+    varreduras_por_segundo = (uint32_t)((uint64_t)varreduras * 1000000 / janela_us);
+    bytes_lcd_por_segundo = (uint32_t)((uint64_t)bytes_lcd * 1000000 / janela_us);
+    varreduras = 0;
+    bytes_lcd = 0;
+    inicio_janela_us = agora_us;
+  }
+}
+
+void ContaVarredura()
+{
+  varreduras++;
+}
+
+void ContaBytesLcd(uint32_t bytes)
+{
+  bytes_lcd += bytes;
+}
+
+ResumoCiclo ResumeCiclo()
+{
+  ResumoCiclo resumo;
+
+  resumo.iteracoes = iteracoes;
+  resumo.minimo_us = minimo_us;
+  resumo.media_us = iteracoes ? (uint32_t)(soma_us / iteracoes) : 0;
+  resumo.maximo_us = maximo_us;
+  resumo.lentas = lentas;
+  resumo.travadas = travadas;
+  resumo.varreduras_por_segundo = varreduras_por_segundo;
+  resumo.bytes_lcd_por_segundo = bytes_lcd_por_segundo;
+  resumo.fase_mais_lenta = fase_mais_lenta;
+  resumo.tempo_fase_mais_lenta_us = tempo_fase_mais_lenta_us;
+
+  return resumo;
+}
+
+void EscreveCiclo(Print &saida)
+{
+  char texto[200];
+  ResumoCiclo resumo = ResumeCiclo();
+
+  snprintf(texto, sizeof(texto), "{\"iteracoes\": %lu, \"us\": {\"min\": %lu, \"media\": %lu, \"max\": %lu}, \"acima_%d_ms\": %lu, \"acima_%d_ms\": %lu, ",
+           (unsigned long)resumo.iteracoes, (unsigned long)resumo.minimo_us, (unsigned long)resumo.media_us, (unsigned long)resumo.maximo_us,
+           LIMITE_ITERACAO_LENTA_MS, (unsigned long)resumo.lentas, LIMITE_VIGIA_LOOP_MS, (unsigned long)resumo.travadas);
+  saida.print(texto);
+
+  snprintf(texto, sizeof(texto), "\"fase_mais_lenta\": {\"nome\": \"%s\", \"us\": %lu}, \"varreduras_por_segundo\": %lu, \"bytes_lcd_por_segundo\": %lu, \"i2c_por_segundo\": %lu}",
+           resumo.fase_mais_lenta, (unsigned long)resumo.tempo_fase_mais_lenta_us, (unsigned long)resumo.varreduras_por_segundo,
+           (unsigned long)resumo.bytes_lcd_por_segundo, (unsigned long)resumo.bytes_lcd_por_segundo * ESCRITAS_I2C_POR_BYTE_LCD);
+  saida.println(texto);
+}
+
+void LimpaCiclo()
+{
+  iteracoes = 0;
+  soma_us = 0;
+  minimo_us = 0;
+  maximo_us = 0;
+  lentas = 0;
+  travadas = 0;
+  fase_mais_lenta = FASE_FORA_DE_TRECHOS;
+  tempo_fase_mais_lenta_us = 0;
+}
@@ -0,0 +1,50 @@
+//Período do loop(), taxa de varredura do tabuleiro, taxa de escrita no LCD e vigia de iterações travadas
+//
+//Cada iteração do loop() é medida entre InicioIteracao() e FimIteracao(), com mínimo, média e máximo e a contagem das
+//iterações acima de LIMITE_ITERACAO_LENTA_MS. As fases são os trechos de rastreamento.h (LeBotoes, Lance, ida e volta
+//pelo rádio, sons...), que chamam EntraFase()/SaiFase(); o tempo fora de qualquer trecho conta como fase "loop".
+//Se uma iteração passar de LIMITE_VIGIA_LOOP_MS, a fase que ficou mais tempo seguido em execução é registrada. No
+//ESP32 um temporizador do esp_timer também confere a iteração em andamento, de forma que um loop() bloqueado (por
+//exemplo aguardando o host) aparece no registro com a fase em que parou, sem esperar a iteração terminar.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+
+#define LIMITE_ITERACAO_LENTA_MS 20
+#define LIMITE_VIGIA_LOOP_MS 1000
+#define PERIODO_VIGIA_LOOP_MS 250
+#define PROFUNDIDADE_MAXIMA_FASES 8
+#define ESCRITAS_I2C_POR_BYTE_LCD 6 //Duas metades de 4 bits, cada uma com o dado e o pulso de enable (3 escritas)
+
+struct ResumoCiclo
+{
+  uint32_t iteracoes;
+  uint32_t minimo_us;
+  uint32_t media_us;
+  uint32_t maximo_us;
+  uint32_t lentas; //Acima de LIMITE_ITERACAO_LENTA_MS
+  uint32_t travadas; //Acima de LIMITE_VIGIA_LOOP_MS
+  uint32_t varreduras_por_segundo; //CapturaEstadoAtual() no último segundo
+  uint32_t bytes_lcd_por_segundo; //No último segundo
+  const char *fase_mais_lenta; //Fase mais demorada da iteração mais longa
+  uint32_t tempo_fase_mais_lenta_us;
+};
+
+void IniciaCiclo(); //Chamada no setup(): guarda a tarefa do loop() e cria o vigia (ESP32)
+void InicioIteracao();
+void FimIteracao();
+void EntraFase(const char *fase); //String literal, só o ponteiro é guardado. Ignorada fora da tarefa do loop()
+void SaiFase();
+void ContaVarredura();
+void ContaBytesLcd(uint32_t bytes);
+ResumoCiclo ResumeCiclo();
+void EscreveCiclo(Print &saida); //Resposta JSON do comando "?ciclo"
+void LimpaCiclo();
+
+class FaseEscopo
+{
+  public:
+    explicit FaseEscopo(const char *fase) { EntraFase(fase); }
+    ~FaseEscopo() { SaiFase(); }
+};
@@ -0,0 +1,183 @@
+#include "comandos.h"
+#include "rastreamento.h"
+#include "latencia.h"
+#include "memoria.h"
+#include "ciclo.h"
+#include "calibracao.h"
+#include "estado_casas.h"
+#include "automatico.h"
+#include "tarefas.h"
+#include "conexao.h"
+#include "sessao.h"
+#include "telemetria.h"
+#include "sincronia.h"
+#include "painel.h"
+#include "transportes.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+struct Comando
+{
+  const char *nome;
+  void (*executa)(Print &saida);
+  void (*executa_com_argumentos)(const char *argumentos, Print &saida); //Em vez de executa, nos comandos com argumentos
+};
+
+static void LimpaRastreamentoComando(Print &saida)
+{
+  LimpaRastreamento();
+  saida.println("{\"ok\": true}");
+}
+
+static void LimpaLatenciaComando(Print &saida)
+{
+  LimpaLatencia();
+  saida.println("{\"ok\": true}");
+}
+
+static void LimpaMemoriaComando(Print &saida)
+{
+  LimpaMemoria();
+  saida.println("{\"ok\": true}");
+}
+
+static void LimpaCicloComando(Print &saida)
+{
+  LimpaCiclo();
+  saida.println("{\"ok\": true}");
+}
+
+static void ApagaCalibracaoComando(Print &saida)
+{
+  ApagaCalibracao();
+  saida.println("{\"ok\": true}");
+}
+
+static void LimpaTarefasComando(Print &saida)
+{
+  LimpaTarefas();
+  saida.println("{\"ok\": true}");
+}
+
+static void LimpaConexaoComando(Print &saida)
+{
+  LimpaConexao();
+  saida.println("{\"ok\": true}");
+}
+
+#if TIX_WIFI
+static void LimpaPainelComando(Print &saida)
+{
+  LimpaPainel();
+  saida.println("{\"ok\": true}");
+}
+#endif
+
+static const Comando comandos[] = {
+  {"rastro", ExportaRastreamento},
+  {"limpa_rastro", LimpaRastreamentoComando},
+  {"latencia", EscreveLatencia},
+  {"limpa_latencia", LimpaLatenciaComando},
+  {"memoria", EscreveMemoria},
+  {"limpa_memoria", LimpaMemoriaComando},
+  {"ciclo", EscreveCiclo},
+  {"limpa_ciclo", LimpaCicloComando},
+  {"casas", EscreveCasas},
+  {"estado_casas", EscreveEstadoCasas},
+  {"calibracao", EscreveCalibracao},
+  {"apaga_calibracao", ApagaCalibracaoComando},
+  {"lance_automatico", EscreveLanceAutomatico},
+  {"tarefas", EscreveTarefas},
+  {"limpa_tarefas", LimpaTarefasComando},
+  {"conexao", EscreveConexao},
+  {"limpa_conexao", LimpaConexaoComando},
+  {"retoma", nullptr, RetomaSessao},
+  {"telemetria", nullptr, ConfiguraTelemetria},
+  {"relogio", nullptr, RespondeRelogioComando},
+#if TIX_WIFI
+  {"painel", EscrevePainel},
+  {"limpa_painel", LimpaPainelComando},
+#endif
+};
+
+static void RespondeComandoDesconhecido(Print &saida)
+{
+  saida.print("{\"erro\": \"comando desconhecido\", \"comandos\": [");
+  for(unsigned int i = 0; i < sizeof(comandos) / sizeof(comandos[0]); i++)
+  {
+    saida.print(i == 0 ? "\"" : ", \"");
+    saida.print(comandos[i].nome);
+    saida.print("\"");
+  }
+  saida.println("]}");
+}
+
+void ProcessaComandos(Stream &canal, EntradaComandos &entrada, bool exclusivo)
+{
+  while(canal.available() > 0)
+  {
+    if(!exclusivo && entrada.tamanho == 0 && !entrada.descartando && canal.peek() != '?')
+      return; //Resposta do host, lida por RecebeResposta()
+
+    char caractere = canal.read();
+
+    if(caractere == '\n')
+    {
+      uint8_t tamanho = entrada.tamanho;
+      entrada.tamanho = 0;
+      entrada.descartando = false;
+
+      if(tamanho > 0)
+      {
+        TRECHO_ESCOPO("ProcessaComandos");
+
+        entrada.linha[tamanho] = '\0';
+        ExecutaComando(entrada.linha, canal);
+        return;
+      }
+    }
+    else if(entrada.descartando)
+      continue;
+    else if((entrada.tamanho == 0 && caractere != '?') || entrada.tamanho == TAMANHO_MAXIMO_COMANDO)
+      entrada.descartando = true;
+    else
+      entrada.linha[entrada.tamanho++] = caractere;
+  }
+}
+
+void ExecutaComando(const char *linha, Print &saida)
+{
+  char nome[TAMANHO_MAXIMO_COMANDO + 1];
+  size_t tamanho = strlen(linha);
+
+  if(tamanho == 0 || linha[0] != '?')
+    return;
+
+  while(tamanho > 0 && (linha[tamanho - 1] == '\r' || linha[tamanho - 1] == ' '))
+    tamanho--;
+  if(tamanho > TAMANHO_MAXIMO_COMANDO)
+    tamanho = TAMANHO_MAXIMO_COMANDO;
+  memcpy(nome, linha + 1, tamanho - 1);
+  nome[tamanho - 1] = '\0';
+
+  char *argumentos = strchr(nome, ' '); //"?retoma 123 45": nome e argumentos separados pelo primeiro espaço
+  if(argumentos)
+    *argumentos++ = '\0';
+  else
+    argumentos = nome + strlen(nome);
+
+  for(unsigned int i = 0; i < sizeof(comandos) / sizeof(comandos[0]); i++)
+  {
+    if(strcmp(nome, comandos[i].nome) == 0)
+    {
+      if(comandos[i].executa_com_argumentos)
+        comandos[i].executa_com_argumentos(argumentos, saida);
+      else
+        comandos[i].executa(saida);
+      return;
+    }
+  }
+
+  RespondeComandoDesconhecido(saida);
+}
@@ -0,0 +1,24 @@
+//Comandos de diagnóstico recebidos pelo Bluetooth ou pela serial USB
+//
+//Um comando é uma linha que começa com '?' (por exemplo "?rastro\n"), o que não se confunde com as respostas de
+//lance do host, que começam com '['. Argumentos, quando o comando tem, seguem o nome separados por espaço
+//("?retoma 123 45\n"). A resposta é um objeto JSON em uma única linha terminada por "\r\n".
+#pragma once
+
+#include <stdint.h>
+#include <Stream.h>
+
+#define TAMANHO_MAXIMO_COMANDO 32 //Sem o '\n'; o resto de uma linha mais longa é descartado
+
+//Linha em montagem de um canal, cada canal com a sua: ProcessaComandos lê só o que já chegou, sem esperar o '\n'
+struct EntradaComandos
+{
+  char linha[TAMANHO_MAXIMO_COMANDO + 1];
+  uint8_t tamanho;
+  bool descartando; //Até o '\n': linha que não começa com '?' ou resto de uma linha longa demais
+};
+
+//Atende no máximo um comando completo no canal, se houver. exclusivo: o canal só traz comandos (serial USB) e o que
+//não começa com '?' é descartado; no rádio, a linha que não começa com '?' é resposta do host e fica no canal
+void ProcessaComandos(Stream &canal, EntradaComandos &entrada, bool exclusivo);
+void ExecutaComando(const char *linha, Print &saida); //Linha já lida, com o '?' e sem o '\n'
@@ -0,0 +1,241 @@
+#include "conexao.h"
+#include "registro.h"
+
+#include <atomic>
+#include <stdio.h>
+
+//Último estado informado por cada rádio e quantas vezes ele foi informado (escritos pelos callbacks)
+static std::atomic<bool> conectado_informado[QUANTIDADE_TRANSPORTES];
+static std::atomic<uint32_t> versao_informada[QUANTIDADE_TRANSPORTES];
+
+static uint8_t transportes_disponiveis = 0;
+static void (*liga_radio)(uint8_t transporte, bool ligado) = nullptr;
+static uint32_t versao_vista[QUANTIDADE_TRANSPORTES];
+static bool conectado[QUANTIDADE_TRANSPORTES];
+static bool radio_ligado[QUANTIDADE_TRANSPORTES];
+static std::atomic<uint8_t> transporte_conectado{SEM_TRANSPORTE}; //Lido pelo canal do host nas linhas do loop()
+static uint32_t inicio_estado_ms = 0; //Desde quando há (ou não há) cliente
+static bool ja_conectou = false;
+static std::atomic<uint32_t> geracao{0}; //Lida pelo loop(), que espera as respostas do host
+
+//Transições dos rádios
+static uint32_t transicoes_radio = 0;
+static uint32_t espera_transicao_ms = ESPERA_INICIAL_TRANSICAO_MS;
+static uint32_t tempo_ultima_transicao_ms = 0;
+static bool houve_transicao = false;
+
+//Tempo para reconectar
+static uint32_t desconexoes = 0;
+static uint32_t reconexoes = 0;
+static uint32_t ultima_reconexao_ms = 0;
+static uint32_t minima_reconexao_ms = 0;
+static uint32_t maxima_reconexao_ms = 0;
+static uint64_t soma_reconexoes_ms = 0;
+
+static bool PrazoVencido(uint32_t agora_ms, uint32_t inicio_ms, uint32_t prazo_ms)
+{
+  return agora_ms - inicio_ms >= prazo_ms;
+}
+
+static void RegistraReconexao(uint32_t tempo_ms)
+{
+  if(reconexoes == 0 || tempo_ms < minima_reconexao_ms)
+    minima_reconexao_ms = tempo_ms;
+  if(tempo_ms > maxima_reconexao_ms)
+    maxima_reconexao_ms = tempo_ms;
+
+  reconexoes++;
+  ultima_reconexao_ms = tempo_ms;
+  soma_reconexoes_ms += tempo_ms;
+}
+
+//Com o cliente perdido, passa para outro transporte ainda conectado; sem cliente, adota o primeiro que conectar
+static bool EscolheTransporte(uint32_t agora_ms)
+{
+  uint8_t anterior = transporte_conectado;
+  uint8_t escolhido = anterior;
+
+  if(escolhido != SEM_TRANSPORTE && !conectado[escolhido])
+    escolhido = SEM_TRANSPORTE;
+
+  for(uint8_t i = 0; i < QUANTIDADE_TRANSPORTES && escolhido == SEM_TRANSPORTE; i++)
+    if(conectado[i])
+      escolhido = i;
+
+  if(escolhido == anterior)
+    return false;
+
+  transporte_conectado = escolhido;
+  if(escolhido != SEM_TRANSPORTE)
+    geracao.fetch_add(1, std::memory_order_release);
+
+  if(anterior == SEM_TRANSPORTE)
+  {
+    if(ja_conectou)
+      RegistraReconexao(agora_ms - inicio_estado_ms);
+    ja_conectou = true;
+    inicio_estado_ms = agora_ms;
+    REGISTRA_INFO("Conexao: cliente em %d", escolhido);
+  }
+  else if(escolhido == SEM_TRANSPORTE)
+  {
+    desconexoes++;
+    inicio_estado_ms = agora_ms;
+    REGISTRA_INFO("Conexao: sem cliente (estava em %d)", anterior);
+  }
+  else
+  {
+    inicio_estado_ms = agora_ms;
+    REGISTRA_INFO("Conexao: cliente passou de %d para %d", anterior, escolhido);
+  }
+
+  return true;
+}
+
+static bool RadioDesejado(uint8_t transporte, uint32_t agora_ms)
+{
+  if(transporte_conectado == SEM_TRANSPORTE) //Ligados de volta só depois da histerese, se já houve cliente
+    return radio_ligado[transporte] || !ja_conectou || PrazoVencido(agora_ms, inicio_estado_ms, HISTERESE_RELIGA_RADIOS_MS);
+
+  if(transporte == transporte_conectado)
+    return true;
+
+  return radio_ligado[transporte] && !PrazoVencido(agora_ms, inicio_estado_ms, HISTERESE_DESLIGA_RADIO_MS);
+}
+
+//No máximo uma transição por chamada, respeitando a espera desde a anterior
+static void AplicaRadios(uint32_t agora_ms)
+{
+  if(!liga_radio || (houve_transicao && !PrazoVencido(agora_ms, tempo_ultima_transicao_ms, espera_transicao_ms)))
+    return;
+
+  for(uint8_t i = 0; i < QUANTIDADE_TRANSPORTES; i++)
+  {
+    if(!(transportes_disponiveis & (1 << i)))
+      continue;
+
+    bool desejado = RadioDesejado(i, agora_ms);
+    if(desejado == radio_ligado[i])
+      continue;
+
+    if(houve_transicao && !PrazoVencido(agora_ms, tempo_ultima_transicao_ms, JANELA_ESTABILIDADE_RADIOS_MS))
+      espera_transicao_ms = espera_transicao_ms * 2 < ESPERA_MAXIMA_TRANSICAO_MS ? espera_transicao_ms * 2 : ESPERA_MAXIMA_TRANSICAO_MS;
+    else
+      espera_transicao_ms = ESPERA_INICIAL_TRANSICAO_MS;
+
+    liga_radio(i, desejado);
+    radio_ligado[i] = desejado;
+    transicoes_radio++;
+    tempo_ultima_transicao_ms = agora_ms;
+    houve_transicao = true;
+    return;
+  }
+}
+
+void IniciaConexao(uint8_t transportes, void (*funcao_liga_radio)(uint8_t transporte, bool ligado))
+{
+  transportes_disponiveis = transportes;
+  liga_radio = funcao_liga_radio;
+
+  //Os estados informados não são apagados: um rádio pode ter conectado antes desta chamada
+  for(uint8_t i = 0; i < QUANTIDADE_TRANSPORTES; i++)
+  {
+    versao_vista[i] = 0;
+    conectado[i] = false;
+    radio_ligado[i] = (transportes & (1 << i)) != 0;
+  }
+}
+
+void SinalizaConexao(uint8_t transporte, bool conectado_agora)
+{
+  if(transporte >= QUANTIDADE_TRANSPORTES)
+    return;
+
+  conectado_informado[transporte].store(conectado_agora, std::memory_order_relaxed);
+  versao_informada[transporte].fetch_add(1, std::memory_order_release);
+}
+
+bool AtendeConexao(uint32_t agora_ms)
+{
+  bool mudou = false;
+
+  for(uint8_t i = 0; i < QUANTIDADE_TRANSPORTES; i++)
+  {
+    uint32_t versao = versao_informada[i].load(std::memory_order_acquire);
+    if(versao == versao_vista[i])
+      continue;
+
+    versao_vista[i] = versao;
+    bool agora_conectado = conectado_informado[i].load(std::memory_order_relaxed);
+
+    if(agora_conectado != conectado[i])
+    {
+      conectado[i] = agora_conectado;
+      AtualizaConexao(i, agora_conectado);
+      mudou = true;
+    }
+  }
+
+  bool transporte_mudou = mudou && EscolheTransporte(agora_ms);
+  AplicaRadios(agora_ms);
+
+  return transporte_mudou;
+}
+
+uint8_t TransporteConectado()
+{
+  return transporte_conectado;
+}
+
+uint32_t GeracaoConexao()
+{
+  return geracao.load(std::memory_order_acquire);
+}
+
+ResumoConexao ResumeConexao()
+{
+  ResumoConexao resumo;
+
+  resumo.transporte = transporte_conectado;
+  for(uint8_t i = 0; i < QUANTIDADE_TRANSPORTES; i++)
+    resumo.radio_ligado[i] = radio_ligado[i];
+  resumo.transicoes_radio = transicoes_radio;
+  resumo.espera_transicao_ms = espera_transicao_ms;
+  resumo.desconexoes = desconexoes;
+  resumo.reconexoes = reconexoes;
+  resumo.ultima_reconexao_ms = ultima_reconexao_ms;
+  resumo.minima_reconexao_ms = minima_reconexao_ms;
+  resumo.maxima_reconexao_ms = maxima_reconexao_ms;
+  resumo.media_reconexao_ms = reconexoes ? (uint32_t)(soma_reconexoes_ms / reconexoes) : 0;
+
+  return resumo;
+}
+
+void EscreveConexao(Print &saida)
+{
+  char texto[160];
+  ResumoConexao resumo = ResumeConexao();
+
+  snprintf(texto, sizeof(texto), "{\"transporte\": \"%s\", \"radios\": {\"%s\": %s, \"%s\": %s}, \"transicoes\": %lu, \"espera_transicao_ms\": %lu, ",
+           resumo.transporte == SEM_TRANSPORTE ? "nenhum" : NomeTransporte(resumo.transporte),
+           NomeTransporte(TRANSPORTE_BLUETOOTH), resumo.radio_ligado[TRANSPORTE_BLUETOOTH] ? "true" : "false",
+           NomeTransporte(TRANSPORTE_WIFI), resumo.radio_ligado[TRANSPORTE_WIFI] ? "true" : "false",
+           (unsigned long)resumo.transicoes_radio, (unsigned long)resumo.espera_transicao_ms);
+  saida.print(texto);
+
+  snprintf(texto, sizeof(texto), "\"desconexoes\": %lu, \"reconexao_ms\": {\"quantidade\": %lu, \"ultima\": %lu, \"min\": %lu, \"media\": %lu, \"max\": %lu}}",
+           (unsigned long)resumo.desconexoes, (unsigned long)resumo.reconexoes, (unsigned long)resumo.ultima_reconexao_ms,
+           (unsigned long)resumo.minima_reconexao_ms, (unsigned long)resumo.media_reconexao_ms, (unsigned long)resumo.maxima_reconexao_ms);
+  saida.println(texto);
+}
+
+void LimpaConexao()
+{
+  transicoes_radio = 0;
+  desconexoes = 0;
+  reconexoes = 0;
+  ultima_reconexao_ms = 0;
+  minima_reconexao_ms = 0;
+  maxima_reconexao_ms = 0;
+  soma_reconexoes_ms = 0;
+}
@@ -0,0 +1,56 @@
+//Gerenciador da conexão com o host: estado dirigido pelos eventos dos rádios
+//
+//Os callbacks dos rádios (SPP do Bluetooth, eventos do ponto de acesso WiFi) só chamam SinalizaConexao(), que
+//guarda o estado informado sem travas. AtendeConexao(), na tarefa de comunicação, aplica as mudanças e decide que
+//rádios ficam ligados; sem evento novo ela só compara dois contadores e um prazo, sem consultar os rádios. Ela é
+//chamada com o rádio travado (TravaRadio, tarefas.h): trocar o transporte muda o destino do canal do host e ligar ou
+//desligar um rádio derruba o stream dele, o que não pode acontecer no meio de uma linha escrita pelo loop().
+//
+//- Sem cliente, todos os rádios alternáveis ficam ligados, anunciando o tabuleiro.
+//- Com um cliente, os outros rádios são desligados só depois de HISTERESE_DESLIGA_RADIO_MS de conexão estável
+//  (um pareamento que cai e volta não derruba o outro rádio).
+//- Perdido o cliente, os rádios desligados voltam depois de HISTERESE_RELIGA_RADIOS_MS, tempo para o mesmo cliente
+//  reconectar sem ligar e desligar o outro rádio à toa.
+//- Cada ligar ou desligar é caro (a pilha do rádio inteira sobe ou desce): duas transições seguidas ficam separadas
+//  por uma espera que dobra a cada transição dentro de JANELA_ESTABILIDADE_RADIOS_MS, até ESPERA_MAXIMA_TRANSICAO_MS.
+//
+//O tempo para reconectar (do último cliente perdido ao próximo conectado, em qualquer transporte) é medido e
+//respondido pelo comando "?conexao".
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include "latencia.h"
+
+#define SEM_TRANSPORTE 0xFF
+
+#define HISTERESE_DESLIGA_RADIO_MS 5000
+#define HISTERESE_RELIGA_RADIOS_MS 2000
+#define ESPERA_INICIAL_TRANSICAO_MS 500
+#define ESPERA_MAXIMA_TRANSICAO_MS 30000
+#define JANELA_ESTABILIDADE_RADIOS_MS 30000
+
+struct ResumoConexao
+{
+  uint8_t transporte; //SEM_TRANSPORTE sem cliente
+  bool radio_ligado[QUANTIDADE_TRANSPORTES];
+  uint32_t transicoes_radio;
+  uint32_t espera_transicao_ms; //Espera atual entre duas transições
+  uint32_t desconexoes;
+  uint32_t reconexoes;
+  uint32_t ultima_reconexao_ms;
+  uint32_t minima_reconexao_ms;
+  uint32_t maxima_reconexao_ms;
+  uint32_t media_reconexao_ms;
+};
+
+//transportes: bits (1 << TRANSPORTE_...) dos rádios do firmware, ligados no início. liga_radio liga ou desliga um
+//rádio; nullptr se eles nunca são alternados (firmware só Bluetooth)
+void IniciaConexao(uint8_t transportes, void (*liga_radio)(uint8_t transporte, bool ligado));
+void SinalizaConexao(uint8_t transporte, bool conectado); //Dos callbacks dos rádios, em qualquer tarefa
+bool AtendeConexao(uint32_t agora_ms); //Com o rádio travado; true se o transporte conectado mudou
+uint8_t TransporteConectado(); //De qualquer tarefa
+uint32_t GeracaoConexao(); //Muda a cada cliente conectado ou troca de transporte, de qualquer tarefa
+ResumoConexao ResumeConexao();
+void EscreveConexao(Print &saida); //Resposta JSON do comando "?conexao"
+void LimpaConexao();
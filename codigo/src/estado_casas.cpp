@@ -0,0 +1,133 @@
+#include "estado_casas.h"
+#include "calibracao.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#define LEITURA_INDEFINIDA 0xFF //Confiança abaixo de CONFIANCA_MINIMA_CASA: não confirma peça alguma
+
+struct EstadoCasa
+{
+  Peca estavel;
+  uint8_t historico[LEITURAS_JANELA_CASA]; //Circular, indice aponta para a próxima posição a escrever
+  uint8_t indice;
+  uint8_t faltam_assentar; //Leituras seguidas da peça estável que ainda faltam para a casa assentar
+  bool diferente; //Desde diferente_ms as leituras não são a peça estável
+  uint32_t diferente_ms;
+  uint32_t mudanca_ms;
+};
+
+static EstadoCasa estados[QUANTIDADE_CASAS]; //Começa com tudo VAZIO, as primeiras varreduras corrigem
+static uint32_t esperas = 0;
+static uint32_t recusas = 0;
+static uint32_t espera_maxima_ms = 0;
+
+Peca AtualizaEstadoCasa(uint8_t casa, uint16_t leitura, Peca lida, uint32_t tempo_ms)
+{
+  EstadoCasa &estado = estados[casa];
+  uint8_t contada = LEITURA_INDEFINIDA;
+
+  if(LeituraNaJanela(casa, leitura, estado.estavel, MARGEM_HISTERESE))
+    contada = estado.estavel;
+  else if(ConfiancaCasa(casa) >= CONFIANCA_MINIMA_CASA) //Na janela da peça estável, o caso comum, a confiança nem é calculada
+    contada = lida;
+
+  if(contada == estado.estavel)
+    estado.diferente = false;
+  else if(!estado.diferente)
+  {
+    estado.diferente = true;
+    estado.diferente_ms = tempo_ms;
+  }
+
+  estado.historico[estado.indice] = contada;
+  estado.indice = (estado.indice + 1) % LEITURAS_JANELA_CASA;
+
+  if(contada == estado.estavel)
+  {
+    if(estado.faltam_assentar > 0)
+      estado.faltam_assentar--;
+    return estado.estavel;
+  }
+
+  estado.faltam_assentar = LEITURAS_CONFIRMACAO_CASA;
+  if(contada == LEITURA_INDEFINIDA)
+    return estado.estavel;
+
+  //Só a peça desta leitura ganhou um voto, então só ela pode ter chegado à confirmação
+  uint8_t votos = 0;
+  for(uint8_t i = 0; i < LEITURAS_JANELA_CASA; i++)
+    votos += estado.historico[i] == contada;
+
+  if(votos >= LEITURAS_CONFIRMACAO_CASA)
+  {
+    estado.estavel = (Peca)contada;
+    estado.mudanca_ms = estado.diferente ? estado.diferente_ms : tempo_ms;
+    estado.diferente = false;
+
+    uint8_t seguidas = 0;
+    while(seguidas < LEITURAS_CONFIRMACAO_CASA &&
+          estado.historico[(estado.indice + LEITURAS_JANELA_CASA - 1 - seguidas) % LEITURAS_JANELA_CASA] == estado.estavel)
+      seguidas++;
+    estado.faltam_assentar = LEITURAS_CONFIRMACAO_CASA - seguidas;
+  }
+
+  return estado.estavel;
+}
+
+uint32_t InicioMudancaCasa(uint8_t casa)
+{
+  return estados[casa].mudanca_ms;
+}
+
+bool CasaAssentada(uint8_t casa) //As últimas LEITURAS_CONFIRMACAO_CASA leituras são todas a peça estável
+{
+  return estados[casa].faltam_assentar == 0;
+}
+
+bool CasasAssentadas()
+{
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+    if(!CasaAssentada(casa))
+      return false;
+
+  return true;
+}
+
+void ContaEsperaAcomodacao(uint32_t espera_ms, bool assentou)
+{
+  esperas++;
+  if(!assentou)
+    recusas++;
+  if(espera_ms > espera_maxima_ms)
+    espera_maxima_ms = espera_ms;
+}
+
+void EscreveEstadoCasas(Print &saida)
+{
+  char texto[80];
+
+  saida.print("{\"casas\": [");
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+  {
+    snprintf(texto, sizeof(texto), "%s{\"estavel\": \"%s\", \"assentada\": %s, \"historico\": [", casa == 0 ? "" : ", ",
+             NomePeca(estados[casa].estavel), CasaAssentada(casa) ? "true" : "false");
+    saida.print(texto);
+
+    for(uint8_t i = 1; i <= LEITURAS_JANELA_CASA; i++) //Da mais recente para a mais antiga
+    {
+      uint8_t leitura = estados[casa].historico[(estados[casa].indice + LEITURAS_JANELA_CASA - i) % LEITURAS_JANELA_CASA];
+
+      saida.print(i == 1 ? "\"" : ", \"");
+      saida.print(leitura == LEITURA_INDEFINIDA ? "?" : NomePeca((Peca)leitura));
+      saida.print("\"");
+    }
+
+    saida.print("]}");
+  }
+
+  snprintf(texto, sizeof(texto), "], \"esperas\": %lu, \"recusas\": %lu, ", (unsigned long)esperas, (unsigned long)recusas);
+  saida.print(texto);
+  snprintf(texto, sizeof(texto), "\"espera_maxima_ms\": %lu}", (unsigned long)espera_maxima_ms);
+  saida.println(texto);
+}
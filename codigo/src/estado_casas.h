@@ -0,0 +1,28 @@
+//Estado estável de cada casa a partir das leituras classificadas, com histerese, confirmação N de M e acomodação
+//
+//Cada varredura entrega a peça lida em cada casa. A leitura que ainda cabe na janela da peça estável alargada por
+//MARGEM_HISTERESE conta como a peça estável (uma leitura na borda não troca a peça a cada varredura); fora disso
+//conta a peça classificada, ou nenhuma se a confiança (calibracao.h) ficar abaixo de CONFIANCA_MINIMA_CASA. A peça
+//estável só muda quando a mesma peça aparece em LEITURAS_CONFIRMACAO_CASA das últimas LEITURAS_JANELA_CASA leituras.
+//A casa está assentada quando as últimas LEITURAS_CONFIRMACAO_CASA leituras são todas a peça estável; enquanto não
+//estiver (peça meio encaixada, mão sobre a casa) ela está acomodando e o lance espera até
+//TEMPO_MAXIMO_ACOMODACAO_MS antes de ser recusado.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include "tabuleiro.h"
+
+#define LEITURAS_JANELA_CASA 5 //M
+#define LEITURAS_CONFIRMACAO_CASA 4 //N
+#define MARGEM_HISTERESE 30 //Códigos de ADC além da janela da peça estável; menor que FAIXA_GUARDA, não invade a janela vizinha
+#define CONFIANCA_MINIMA_CASA 50
+#define TEMPO_MAXIMO_ACOMODACAO_MS 250 //Espera máxima do relógio por casas assentadas
+#define INTERVALO_ACOMODACAO_MS 5 //Entre as varreduras da espera
+
+Peca AtualizaEstadoCasa(uint8_t casa, uint16_t leitura, Peca lida, uint32_t tempo_ms); //Devolve a peça estável
+uint32_t InicioMudancaCasa(uint8_t casa); //Primeira leitura da peça estável atual, antes da confirmação
+bool CasaAssentada(uint8_t casa);
+bool CasasAssentadas();
+void ContaEsperaAcomodacao(uint32_t espera_ms, bool assentou); //Lance que precisou esperar alguma casa assentar
+void EscreveEstadoCasas(Print &saida); //Resposta JSON do comando "?estado_casas"
@@ -0,0 +1,95 @@
+#include "historico.h"
+#include "regras.h"
+
+static LanceHistorico lances[CAPACIDADE_HISTORICO]; //Circular: os lances desfeitos continuam depois do topo
+static uint8_t inicio = 0;
+static uint8_t quantidade = 0; //Lances que podem ser desfeitos
+static uint8_t refaziveis = 0; //Lances desfeitos logo acima do topo
+
+uint32_t HashPosicao(const EstadoTabuleiro &posicao, bool vez_brancas)
+{
+  char fen[TAMANHO_FEN];
+  uint32_t hash = 2166136261u;
+
+  FormataFen(posicao, vez_brancas, fen);
+  for(const char *c = fen; *c; c++)
+  {
+    hash ^= (uint8_t)*c;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+void AplicaLanceHistorico(EstadoTabuleiro &posicao, const LanceHistorico &lance)
+{
+  posicao[DestinoLance(lance.lance)] = lance.peca;
+  posicao[OrigemLance(lance.lance)] = VAZIO;
+}
+
+void DesfazLanceHistorico(EstadoTabuleiro &posicao, const LanceHistorico &lance)
+{
+  posicao[OrigemLance(lance.lance)] = lance.peca;
+  posicao[DestinoLance(lance.lance)] = lance.capturada;
+}
+
+static uint8_t Indice(uint8_t posicao)
+{
+  return (inicio + posicao) % CAPACIDADE_HISTORICO;
+}
+
+void IniciaHistorico()
+{
+  inicio = 0;
+  quantidade = 0;
+  refaziveis = 0;
+}
+
+void EmpilhaLance(const LanceHistorico &lance)
+{
+  if(quantidade == CAPACIDADE_HISTORICO) //Descarta o mais antigo
+  {
+    inicio = Indice(1);
+    quantidade--;
+  }
+
+  lances[Indice(quantidade++)] = lance;
+  refaziveis = 0;
+}
+
+bool DesempilhaLance(LanceHistorico &lance)
+{
+  if(quantidade == 0)
+    return false;
+
+  lance = lances[Indice(--quantidade)];
+  refaziveis++;
+  return true;
+}
+
+bool ReempilhaLance(LanceHistorico &lance)
+{
+  if(refaziveis == 0)
+    return false;
+
+  lance = lances[Indice(quantidade++)];
+  refaziveis--;
+  return true;
+}
+
+void CancelaDesempilhaLance()
+{
+  quantidade++;
+  refaziveis--;
+}
+
+void CancelaReempilhaLance()
+{
+  quantidade--;
+  refaziveis++;
+}
+
+uint8_t LancesNoHistorico()
+{
+  return quantidade;
+}
@@ -0,0 +1,55 @@
+//Histórico dos lances da partida, com capacidade fixa, para desfazer e refazer
+//
+//Cada lance aceito pelo host é empilhado com o lance compactado (origem e destino em um byte), a peça movida, a peça
+//capturada, os dois relógios no início da vez e o do jogador no aperto do relógio, em ms, e o hash da posição depois
+//do lance. Desfazer e refazer só mexem no topo: O(1), sem alocação.
+//Quando a pilha enche, o lance mais antigo é descartado e deixa de poder ser desfeito. Um lance novo apaga os lances
+//que podiam ser refeitos.
+//
+//O hash é o FNV-1a de 32 bits do texto de FormataFen (regras.h), fácil de calcular igual no main.py: o host confere
+//que chegou à mesma posição depois de desfazer ou refazer.
+#pragma once
+
+#include <stdint.h>
+#include "tabuleiro.h"
+
+#define CAPACIDADE_HISTORICO 64 //20 bytes por lance
+
+struct LanceHistorico
+{
+  uint8_t lance; //Origem nos 3 bits altos, destino nos 3 baixos
+  Peca peca;
+  Peca capturada; //VAZIO sem captura
+  bool brancas; //Cor de quem jogou
+  uint32_t tempo_brancas_antes_ms; //Relógios no início da vez
+  uint32_t tempo_pretas_antes_ms;
+  uint32_t tempo_depois_ms; //Relógio de quem jogou no aperto do relógio
+  uint32_t hash_depois;
+};
+
+inline uint8_t CompactaLance(int origem, int destino)
+{
+  return (uint8_t)((origem << 3) | destino);
+}
+
+inline int OrigemLance(uint8_t lance)
+{
+  return lance >> 3;
+}
+
+inline int DestinoLance(uint8_t lance)
+{
+  return lance & 0x07;
+}
+
+uint32_t HashPosicao(const EstadoTabuleiro &posicao, bool vez_brancas);
+void AplicaLanceHistorico(EstadoTabuleiro &posicao, const LanceHistorico &lance);
+void DesfazLanceHistorico(EstadoTabuleiro &posicao, const LanceHistorico &lance);
+
+void IniciaHistorico(); //Partida nova
+void EmpilhaLance(const LanceHistorico &lance);
+bool DesempilhaLance(LanceHistorico &lance); //Para desfazer; o lance passa a poder ser refeito
+bool ReempilhaLance(LanceHistorico &lance); //Para refazer
+void CancelaDesempilhaLance(); //O host recusou: desfaz o DesempilhaLance
+void CancelaReempilhaLance();
+uint8_t LancesNoHistorico();
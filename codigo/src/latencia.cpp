@@ -0,0 +1,175 @@
+#include "latencia.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <stdio.h>
+
+#define BITS_SUBFAIXA 4
+#define SUBFAIXAS (1 << BITS_SUBFAIXA)
+#define MAIOR_EXPOENTE 25 //2^26 us = ~67 s, valores maiores ficam no último intervalo
+#define INTERVALOS_HISTOGRAMA (SUBFAIXAS + (MAIOR_EXPOENTE - BITS_SUBFAIXA + 1) * SUBFAIXAS)
+
+struct EstatisticasTransporte
+{
+  uint32_t histograma[INTERVALOS_HISTOGRAMA];
+  uint32_t quantidade;
+  uint32_t minimo_us;
+  uint32_t maximo_us;
+  uint32_t retentativas;
+  uint32_t quadros_malformados;
+  uint32_t reconexoes;
+  bool conectado;
+  bool ja_conectou;
+};
+
+static EstatisticasTransporte estatisticas[QUANTIDADE_TRANSPORTES];
+static const char *nomes_transportes[QUANTIDADE_TRANSPORTES] = {"bluetooth", "wifi"};
+
+static unsigned int Expoente(uint32_t valor)
+{
+  return 31 - __builtin_clz(valor);
+}
+
+//Valores abaixo de 16 têm um intervalo cada; acima, cada potência de 2 é dividida em 16 intervalos iguais
+static unsigned int IndiceIntervalo(uint32_t valor)
+{
+  if(valor < SUBFAIXAS)
+    return valor;
+
+  unsigned int expoente = Expoente(valor);
+  if(expoente > MAIOR_EXPOENTE)
+    return INTERVALOS_HISTOGRAMA - 1;
+
+  unsigned int deslocamento = expoente - BITS_SUBFAIXA;
+  return SUBFAIXAS + deslocamento * SUBFAIXAS + ((valor >> deslocamento) - SUBFAIXAS);
+}
+
+//Maior valor que cai no intervalo, para que os percentis nunca subestimem a latência
+static uint32_t LimiteSuperiorIntervalo(unsigned int indice)
+{
+  if(indice < SUBFAIXAS)
+    return indice;
+
+  unsigned int deslocamento = (indice - SUBFAIXAS) / SUBFAIXAS;
+  uint32_t mantissa = SUBFAIXAS + (indice - SUBFAIXAS) % SUBFAIXAS;
+  return ((mantissa + 1) << deslocamento) - 1;
+}
+
+static uint32_t Percentil(const EstatisticasTransporte &transporte, unsigned int percentual)
+{
+  if(transporte.quantidade == 0)
+    return 0;
+
+  uint32_t alvo = ((uint64_t)transporte.quantidade * percentual + 99) / 100;
+  uint32_t acumulado = 0;
+
+  for(unsigned int i = 0; i < INTERVALOS_HISTOGRAMA; i++)
+  {
+    acumulado += transporte.histograma[i];
+    if(acumulado >= alvo)
+    {
+      if(i == INTERVALOS_HISTOGRAMA - 1) //Intervalo aberto dos valores acima do maior expoente
+        return transporte.maximo_us;
+
+      uint32_t limite = LimiteSuperiorIntervalo(i);
+      return limite < transporte.maximo_us ? limite : transporte.maximo_us;
+    }
+  }
+
+  return transporte.maximo_us;
+}
+
+void RegistraIdaEVolta(uint8_t transporte, uint32_t tempo_us)
+{
+  EstatisticasTransporte &atual = estatisticas[transporte];
+
+  atual.histograma[IndiceIntervalo(tempo_us)]++;
+
+  if(atual.quantidade == 0 || tempo_us < atual.minimo_us)
+    atual.minimo_us = tempo_us;
+  if(tempo_us > atual.maximo_us)
+    atual.maximo_us = tempo_us;
+
+  atual.quantidade++;
+}
+
+void ContaRetentativa(uint8_t transporte)
+{
+  estatisticas[transporte].retentativas++;
+}
+
+void ContaQuadroMalformado(uint8_t transporte)
+{
+  estatisticas[transporte].quadros_malformados++;
+}
+
+void AtualizaConexao(uint8_t transporte, bool conectado)
+{
+  EstatisticasTransporte &atual = estatisticas[transporte];
+
+  if(conectado && !atual.conectado)
+  {
+    if(atual.ja_conectou)
+      atual.reconexoes++;
+    atual.ja_conectou = true;
+  }
+
+  atual.conectado = conectado;
+}
+
+ResumoLatencia ResumeLatencia(uint8_t transporte)
+{
+  const EstatisticasTransporte &atual = estatisticas[transporte];
+  ResumoLatencia resumo;
+
+  resumo.quantidade = atual.quantidade;
+  resumo.minimo_us = atual.minimo_us;
+  resumo.mediana_us = Percentil(atual, 50);
+  resumo.p90_us = Percentil(atual, 90);
+  resumo.p99_us = Percentil(atual, 99);
+  resumo.maximo_us = atual.maximo_us;
+  resumo.retentativas = atual.retentativas;
+  resumo.quadros_malformados = atual.quadros_malformados;
+  resumo.reconexoes = atual.reconexoes;
+
+  return resumo;
+}
+
+const char *NomeTransporte(uint8_t transporte)
+{
+  return nomes_transportes[transporte];
+}
+
+void EscreveLatencia(Print &saida)
+{
+  char texto[200];
+
+  saida.print("{");
+  for(uint8_t transporte = 0; transporte < QUANTIDADE_TRANSPORTES; transporte++)
+  {
+    ResumoLatencia resumo = ResumeLatencia(transporte);
+
+    snprintf(texto, sizeof(texto), "%s\"%s\": {\"lances\": %lu, \"us\": {\"min\": %lu, \"mediana\": %lu, \"p90\": %lu, \"p99\": %lu, \"max\": %lu}, ",
+             transporte == 0 ? "" : ", ", NomeTransporte(transporte), (unsigned long)resumo.quantidade, (unsigned long)resumo.minimo_us,
+             (unsigned long)resumo.mediana_us, (unsigned long)resumo.p90_us, (unsigned long)resumo.p99_us, (unsigned long)resumo.maximo_us);
+    saida.print(texto);
+
+    snprintf(texto, sizeof(texto), "\"retentativas\": %lu, \"quadros_malformados\": %lu, \"reconexoes\": %lu}",
+             (unsigned long)resumo.retentativas, (unsigned long)resumo.quadros_malformados, (unsigned long)resumo.reconexoes);
+    saida.print(texto);
+  }
+  saida.println("}");
+}
+
+void LimpaLatencia()
+{
+  for(uint8_t transporte = 0; transporte < QUANTIDADE_TRANSPORTES; transporte++)
+  {
+    EstatisticasTransporte &atual = estatisticas[transporte];
+    bool conectado = atual.conectado;
+
+    memset(&atual, 0, sizeof(atual));
+    atual.conectado = conectado; //A conexão atual não deve contar como reconexão
+    atual.ja_conectou = conectado;
+  }
+}
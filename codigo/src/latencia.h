@@ -0,0 +1,35 @@
+//Latência de ida e volta dos lances e qualidade do enlace com o host, separadas por transporte
+//
+//O tempo entre EnviaMensagem() e a resposta correspondente em AguardaMensagem() vai para um histograma no estilo
+//HDR: 16 subdivisões lineares por potência de 2, erro relativo abaixo de 6,25% de 1 us a ~67 s, em memória fixa.
+//Também são contadas as esperas esgotadas (retentativas de leitura), os quadros malformados e as reconexões.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+
+#define TRANSPORTE_BLUETOOTH 0
+#define TRANSPORTE_WIFI 1
+#define QUANTIDADE_TRANSPORTES 2
+
+struct ResumoLatencia
+{
+  uint32_t quantidade;
+  uint32_t minimo_us;
+  uint32_t mediana_us;
+  uint32_t p90_us;
+  uint32_t p99_us;
+  uint32_t maximo_us;
+  uint32_t retentativas;
+  uint32_t quadros_malformados;
+  uint32_t reconexoes;
+};
+
+void RegistraIdaEVolta(uint8_t transporte, uint32_t tempo_us);
+void ContaRetentativa(uint8_t transporte);
+void ContaQuadroMalformado(uint8_t transporte);
+void AtualizaConexao(uint8_t transporte, bool conectado); //Chamada pelo gerenciador de conexão, conta as conexões depois da primeira
+ResumoLatencia ResumeLatencia(uint8_t transporte);
+const char *NomeTransporte(uint8_t transporte);
+void EscreveLatencia(Print &saida); //Resposta JSON do comando "?latencia"
+void LimpaLatencia();
@@ -0,0 +1,39 @@
+//LCD que conta os bytes enviados ao HD44780 (caracteres e comandos de posicionamento/limpeza)
+//
+//Cada byte vai em 4 bits pelo PCF8574: duas metades com pulso de enable, 6 escritas I2C por byte. A contagem alimenta
+//a taxa de escrita mostrada na tela de diagnóstico (ciclo.h).
+#pragma once
+
+#include <LiquidCrystal_I2C.h>
+#include "ciclo.h"
+
+class LcdMedido : public LiquidCrystal_I2C
+{
+  public:
+    using LiquidCrystal_I2C::LiquidCrystal_I2C;
+
+    size_t write(uint8_t caractere) override
+    {
+      ContaBytesLcd(1);
+      return LiquidCrystal_I2C::write(caractere);
+    }
+    using Print::write;
+
+    void clear()
+    {
+      ContaBytesLcd(1);
+      LiquidCrystal_I2C::clear();
+    }
+
+    void home()
+    {
+      ContaBytesLcd(1);
+      LiquidCrystal_I2C::home();
+    }
+
+    void setCursor(uint8_t coluna, uint8_t linha)
+    {
+      ContaBytesLcd(1);
+      LiquidCrystal_I2C::setCursor(coluna, linha);
+    }
+};
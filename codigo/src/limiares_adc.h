@@ -0,0 +1,190 @@
+//Tabela de classificação das leituras do ADC, gerada em tempo de compilação a partir dos resistores das peças
+//
+//Cada casa é um divisor de tensão: resistor fixo RESISTOR_FIXO_OHM entre 3V3 e o pino, resistor da peça entre o pino
+//e o GND (casa vazia = circuito aberto, o pino fica no 3V3 e o ADC satura). A tensão esperada de cada peça passa pela
+//curva nominal do ADC e vira o código esperado; as janelas de decisão ficam em volta de cada código, limitadas a
+//MEIA_JANELA_MAXIMA e separadas das vizinhas por FAIXA_GUARDA. Os static_assert no fim do arquivo impedem que uma
+//troca de resistor gere janelas que se sobrepõem e conferem as janelas contra as leituras medidas no protótipo, que
+//não entram no cálculo. A tabela resultante é constexpr (fica na flash) e ClassificaLeitura() só a percorre.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "tabuleiro.h"
+
+#define CIRCUITO_ABERTO 0xFFFFFFFFu //Resistência da casa vazia
+
+struct ResistorPeca
+{
+  Peca peca;
+  uint32_t ohms;
+};
+
+struct PontoCurvaAdc
+{
+  uint16_t milivolts;
+  uint16_t codigo;
+};
+
+struct JanelaPeca
+{
+  Peca peca;
+  uint16_t esperado;
+  uint16_t minimo; //Inclusivo
+  uint16_t maximo; //Inclusivo
+};
+
+//Vetor simples em vez de std::array: no C++11 o operator[] do std::array não é constexpr
+template<size_t N>
+struct TabelaJanelas
+{
+  JanelaPeca janelas[N];
+};
+
+//---------------------------------------------------------------- Parâmetros do TiX
+
+#define TENSAO_ALIMENTACAO_MV 3300
+#define RESISTOR_FIXO_OHM 510 //RF0 a RF7 no esquema (conexoes/conexoes_prototipo.png), que não traz o valor; com 510 Ω
+                              //(E24) a curva nominal reproduz as leituras do protótipo a menos de 20 códigos
+#define MEIA_JANELA_MAXIMA 210 //Antiga TOLERANCIA, agora só um teto: a janela encolhe se a vizinha estiver perto
+#define FAIXA_GUARDA 40 //Códigos entre duas janelas que não pertencem a nenhuma peça (leitura tratada como vazia)
+#define LARGURA_MINIMA_JANELA 120 //Ruído de pico a pico aceitável do ADC do ESP32 em uma casa
+
+//Em ordem crescente de resistência, ou seja, de código esperado
+constexpr ResistorPeca RESISTORES_PECAS[] = {
+  {TORRE_BRANCAS, 10}, //MPPD (antes: 220 Ω, VVMD)
+  {CAVALO_BRANCAS, 100}, //MPMD
+  {REI_BRANCAS, 330}, //LLMD
+  {REI_PRETAS, 560}, //VAMD
+  {TORRE_PRETAS, 1500}, //MVVD
+  {CAVALO_PRETAS, 3300}, //LLVM (antes: 33 Ω, LLPD)
+  {VAZIO, CIRCUITO_ABERTO},
+};
+
+#define QUANTIDADE_JANELAS (sizeof(RESISTORES_PECAS) / sizeof(RESISTORES_PECAS[0]))
+
+//ADC1 com atenuação de 11 dB (padrão do analogRead), pela caracterização nominal do esp_adc_cal para um chip sem
+//Vref gravado no eFuse: tensão = coeficiente * código / 65536 + 142 mV, com coeficiente = 1100 mV * 196602 / 4096
+//(characterize_using_vref, em esp_adc_cal_esp32.c). Abaixo de 142 mV o ADC lê 0; entre os pontos a curva é
+//interpolada linearmente.
+#define VREF_ADC_NOMINAL_MV 1100
+#define ESCALA_ADC1_11DB 196602
+#define DESLOCAMENTO_ADC1_11DB_MV 142
+
+constexpr uint32_t MilivoltsAdcNominal(uint32_t codigo)
+{
+  return (uint32_t)(((uint64_t)(VREF_ADC_NOMINAL_MV * ESCALA_ADC1_11DB / 4096) * codigo + 32768) / 65536) + DESLOCAMENTO_ADC1_11DB_MV;
+}
+
+constexpr PontoCurvaAdc CURVA_ADC_11DB[] = {
+  {0, 0}, {DESLOCAMENTO_ADC1_11DB_MV, 0}, {(uint16_t)MilivoltsAdcNominal(4095), 4095},
+};
+
+//---------------------------------------------------------------- Gerador (C++11: funções constexpr de um só return)
+
+constexpr uint32_t MilivoltsDivisor(uint32_t ohms, uint32_t resistor_fixo, uint32_t alimentacao_mv)
+{
+  return ohms == CIRCUITO_ABERTO ? alimentacao_mv : (uint32_t)((uint64_t)alimentacao_mv * ohms / ((uint64_t)ohms + resistor_fixo));
+}
+
+template<size_t PONTOS>
+constexpr uint16_t CodigoAdc(uint32_t milivolts, const PontoCurvaAdc (&curva)[PONTOS], size_t i = 0)
+{
+  return milivolts <= curva[0].milivolts ? curva[0].codigo
+       : i + 1 >= PONTOS ? curva[PONTOS - 1].codigo
+       : milivolts <= curva[i + 1].milivolts
+         ? (uint16_t)(curva[i].codigo + (uint32_t)(curva[i + 1].codigo - curva[i].codigo) * (milivolts - curva[i].milivolts) /
+                                        (curva[i + 1].milivolts - curva[i].milivolts))
+         : CodigoAdc(milivolts, curva, i + 1);
+}
+
+//Casa vazia: o pino no 3V3 está além da faixa recomendada do 11 dB (até ~2,45 V), onde o ADC real deixa a reta e satura
+template<size_t N, size_t PONTOS>
+constexpr uint16_t CodigoEsperado(const ResistorPeca (&pecas)[N], size_t i, uint32_t resistor_fixo, const PontoCurvaAdc (&curva)[PONTOS])
+{
+  return pecas[i].ohms == CIRCUITO_ABERTO ? 4095 : CodigoAdc(MilivoltsDivisor(pecas[i].ohms, resistor_fixo, TENSAO_ALIMENTACAO_MV), curva);
+}
+
+constexpr uint32_t Menor(uint32_t a, uint32_t b)
+{
+  return a < b ? a : b;
+}
+
+//Limite inferior: o maior entre (esperado - meia janela) e (ponto médio com a vizinha de baixo + metade da guarda)
+template<size_t N, size_t PONTOS>
+constexpr uint16_t MinimoJanela(const ResistorPeca (&pecas)[N], size_t i, uint32_t resistor_fixo, const PontoCurvaAdc (&curva)[PONTOS])
+{
+  return (uint16_t)(CodigoEsperado(pecas, i, resistor_fixo, curva) -
+                    (i == 0 ? Menor(MEIA_JANELA_MAXIMA, CodigoEsperado(pecas, i, resistor_fixo, curva))
+                            : Menor(MEIA_JANELA_MAXIMA, (uint32_t)(CodigoEsperado(pecas, i, resistor_fixo, curva) - CodigoEsperado(pecas, i - 1, resistor_fixo, curva)) / 2 - FAIXA_GUARDA / 2)));
+}
+
+template<size_t N, size_t PONTOS>
+constexpr uint16_t MaximoJanela(const ResistorPeca (&pecas)[N], size_t i, uint32_t resistor_fixo, const PontoCurvaAdc (&curva)[PONTOS])
+{
+  return (uint16_t)(CodigoEsperado(pecas, i, resistor_fixo, curva) +
+                    (i + 1 == N ? Menor(MEIA_JANELA_MAXIMA, 4095 - CodigoEsperado(pecas, i, resistor_fixo, curva))
+                                : Menor(MEIA_JANELA_MAXIMA, (uint32_t)(CodigoEsperado(pecas, i + 1, resistor_fixo, curva) - CodigoEsperado(pecas, i, resistor_fixo, curva)) / 2 - FAIXA_GUARDA / 2)));
+}
+
+template<size_t... I>
+struct Indices {};
+
+template<size_t N, size_t... I>
+struct GeraIndices : GeraIndices<N - 1, N - 1, I...> {};
+
+template<size_t... I>
+struct GeraIndices<0, I...>
+{
+  typedef Indices<I...> tipo;
+};
+
+template<size_t N, size_t PONTOS, size_t... I>
+constexpr TabelaJanelas<N> GeraJanelas(const ResistorPeca (&pecas)[N], uint32_t resistor_fixo, const PontoCurvaAdc (&curva)[PONTOS], Indices<I...>)
+{
+  return {{{pecas[I].peca, CodigoEsperado(pecas, I, resistor_fixo, curva), MinimoJanela(pecas, I, resistor_fixo, curva), MaximoJanela(pecas, I, resistor_fixo, curva)}...}};
+}
+
+template<size_t N>
+constexpr bool JanelasValidas(const TabelaJanelas<N> &tabela, size_t i = 0)
+{
+  return i >= N ? true
+       : tabela.janelas[i].maximo < tabela.janelas[i].minimo || tabela.janelas[i].maximo - tabela.janelas[i].minimo + 1 < LARGURA_MINIMA_JANELA ? false
+       : i + 1 < N && tabela.janelas[i].maximo + FAIXA_GUARDA > tabela.janelas[i + 1].minimo ? false
+       : JanelasValidas(tabela, i + 1);
+}
+
+template<size_t N>
+constexpr bool CodigosCrescentes(const TabelaJanelas<N> &tabela, size_t i = 1)
+{
+  return i >= N ? true : tabela.janelas[i - 1].esperado < tabela.janelas[i].esperado && CodigosCrescentes(tabela, i + 1);
+}
+
+//---------------------------------------------------------------- Tabela do TiX
+
+constexpr TabelaJanelas<QUANTIDADE_JANELAS> JANELAS_PECAS =
+  GeraJanelas(RESISTORES_PECAS, RESISTOR_FIXO_OHM, CURVA_ADC_11DB, GeraIndices<QUANTIDADE_JANELAS>::tipo());
+
+static_assert(CodigosCrescentes(JANELAS_PECAS), "RESISTORES_PECAS deve estar em ordem crescente com códigos de ADC distintos");
+static_assert(JanelasValidas(JANELAS_PECAS), "Janelas de ADC se sobrepõem ou são estreitas demais: escolha resistores mais espaçados");
+
+//Leitura fora de todas as janelas é tratada como casa vazia, como antes
+template<size_t N>
+constexpr Peca ClassificaLeitura(uint16_t leitura, const TabelaJanelas<N> &tabela, size_t i = 0)
+{
+  return i >= N || leitura < tabela.janelas[i].minimo ? VAZIO
+       : leitura <= tabela.janelas[i].maximo ? tabela.janelas[i].peca
+       : ClassificaLeitura(leitura, tabela, i + 1);
+}
+
+inline Peca ClassificaLeitura(uint16_t leitura)
+{
+  return ClassificaLeitura(leitura, JANELAS_PECAS);
+}
+
+//Leituras medidas no protótipo com as peças atuais (as antigas constantes VALOR_ANALOGICO_*): não entram na curva nem
+//nas janelas, então uma troca de resistor, do resistor fixo ou da curva que as tire das janelas para a compilação
+static_assert(ClassificaLeitura(0, JANELAS_PECAS) == TORRE_BRANCAS && ClassificaLeitura(511, JANELAS_PECAS) == CAVALO_BRANCAS &&
+              ClassificaLeitura(1424, JANELAS_PECAS) == REI_BRANCAS && ClassificaLeitura(1980, JANELAS_PECAS) == REI_PRETAS &&
+              ClassificaLeitura(2880, JANELAS_PECAS) == TORRE_PRETAS && ClassificaLeitura(3380, JANELAS_PECAS) == CAVALO_PRETAS &&
+              ClassificaLeitura(4095, JANELAS_PECAS) == VAZIO, "As leituras medidas no protótipo não caem nas janelas geradas");
@@ -1,19 +1,39 @@
-#include <vector>
+#include <array>
+#include <string.h>
 #include <Wire.h>
 #include <Arduino.h>
 #include <Preferences.h>
+#include "transportes.h"
+#if TIX_BLUETOOTH
 #include "BluetoothSerial.h"
+#endif
+#if TIX_WIFI
+#include <WiFi.h>
+#include "painel.h"
+#endif
 #include <LiquidCrystal_I2C.h>
-
-#define VALOR_ANALOGICO_VAZIO 4095 // = 0 OHM
-#define VALOR_ANALOGICO_REI_PRETAS 1980 // = 560 OHM (COR RESISTOR = VAMD)
-#define VALOR_ANALOGICO_TORRE_PRETAS 2880 // = 1500 OHM (COR RESISTOR = MVVD)
-#define VALOR_ANALOGICO_CAVALO_PRETAS 3380 // = 3300 OHM (COR RESISTOR = LLVM) (ANTES: 240 = 33 OHM (COR RESISTOR = LLPD))
-#define VALOR_ANALOGICO_TORRE_BRANCAS 0 // = 10 OHM (COR RESISTOR = MPPD) (ANTES: 1063 = 220 OHM (COR RESISTOR = VVMD))
-#define VALOR_ANALOGICO_CAVALO_BRANCAS 511 // = 100 OHM (COR RESISTOR = MPMD)
-#define VALOR_ANALOGICO_REI_BRANCAS 1424 // = 330 OHM (COR RESISTOR = LLMD)
-
-#define TOLERANCIA 210 //Tolerância das leituras dos valores analógicos
+#include "lcd_medido.h"
+#include "bancada.h"
+#include "registro.h"
+#include "rastreamento.h"
+#include "comandos.h"
+#include "latencia.h"
+#include "memoria.h"
+#include "ciclo.h"
+#include "tabuleiro.h"
+#include "estado_casas.h"
+#include "reconhecedor.h"
+#include "calibracao.h" //Janelas de ADC de cada casa: perfil calibrado ou tabela nominal de limiares_adc.h
+#include "automatico.h"
+#include "regras.h"
+#include "historico.h"
+#include "tarefas.h"
+#include "conexao.h"
+#include "sessao.h"
+#include "telemetria.h"
+#include "sincronia.h"
+#include "canal_host.h"
+#include "menus.h"
 
 #define PINO_CASA0 34
 #define PINO_CASA1 35
@@ -29,7 +49,7 @@
 #define PINO_BOTAO_ESQUERDA 15
 
 #define PINO_BUZZER 21
-#define PINO_LED_BLUETOOTH 13
+#define PINO_LED 13 //Aceso com o host conectado, por qualquer transporte
 #define PINO_SDA 23
 #define PINO_SCL 22
 
@@ -66,46 +86,43 @@
 #define I_BACKLIGHT_INVERTIDO 6
 #define X_BACKLIGHT_INVERTIDO 7
 
-//Linhas em que as funcionalidades são exibidas no LCD
-#define LINHA_CONTINUAR 0
-#define LINHA_ENCERRAR_PARTIDA 1
-#define LINHA_CONFIGURAR_TEMPO 0
-#define LINHA_JOGADOR_VS_JOGADOR 0
-#define LINHA_JOGADOR_VS_MAQUINA 1
-#define LINHA_DEFINIR_DIFICULDADE 1
-#define LINHA_MENU_CONFIGURAR_TEMPO 1
-#define LINHA_VOLTAR_CONFIGURAR_TEMPO 1
-#define LINHA_VOLTAR_JOGADOR_VS_JOGADOR 2
-#define LINHA_VOLTAR_JOGADOR_VS_MAQUINA 2
-#define LINHA_INICIAR_JOGADOR_VS_MAQUINA 0
-#define LINHA_INICIAR_JOGADOR_VS_JOGADOR 0
-#define LINHA_JOGAR_NOVAMENTE 2
-#define LINHA_VOLTAR_FIM_PARTIDA 3
-
-//A relação entre LINHA_X e X é: se LINHA_X e X existem o valor de X é equivalente ao valor da linha incrementado pelo parâmetro "incremento_linha" da função "AtualizaOpcaoSelecionadaMenu"
-#define MENU_PAUSE 200 //Valor fixo não atrelado a nenhuma linha
-#define MENU_FIM_PARTIDA 300
-#define MENU_INICIAL 100 //Valor qualquer (entrará no caso default da estrutura switch)
-#define JOGADOR_VS_JOGADOR LINHA_JOGADOR_VS_JOGADOR
-#define JOGADOR_VS_MAQUINA LINHA_JOGADOR_VS_MAQUINA
-#define MENU_CONFIGURAR_TEMPO LINHA_MENU_CONFIGURAR_TEMPO + 10
-#define INICIAR_JOGADOR_VS_JOGADOR LINHA_INICIAR_JOGADOR_VS_JOGADOR + 10
-#define DEFINIR_DIFICULDADE LINHA_DEFINIR_DIFICULDADE + 20
-#define INICIAR_JOGADOR_VS_MAQUINA LINHA_INICIAR_JOGADOR_VS_MAQUINA + 20
-#define CONTINUAR LINHA_CONTINUAR + 30
-#define CONFIGURAR_TEMPO LINHA_CONFIGURAR_TEMPO + 40
-#define VOLTAR_CONFIGURAR_TEMPO LINHA_VOLTAR_CONFIGURAR_TEMPO + 40
-#define JOGAR_NOVAMENTE LINHA_JOGAR_NOVAMENTE + 50
-
 //Estado dos botões (ACIONADO/DESACIONADO)
-#define ESTADO_BOTAO_ESQUERDA estado_botoes.at(0)
-#define ESTADO_BOTAO_CENTRO estado_botoes.at(1)
-#define ESTADO_BOTAO_DIREITA estado_botoes.at(2)
+#define ESTADO_BOTAO_ESQUERDA estado_botoes[0]
+#define ESTADO_BOTAO_CENTRO estado_botoes[1]
+#define ESTADO_BOTAO_DIREITA estado_botoes[2]
 
 //Diferenciar último botão acionado
 #define BOTAO_ESQUERDA 0
 #define BOTAO_CENTRO 1
 #define BOTAO_DIREITA 2
+#define QUANTIDADE_BOTOES 3
+
+#define ESPERA_BOTOES_MS 150 //Evita o movimento acelerado da seta (provisório)
+
+//Configuração do tempo: um passo de 1 s por aperto; segurando, o passo cresce com o tempo segurado
+#define TEMPO_MAXIMO_CONFIGURAVEL (9*60*60 + 59*60 + 59) //9:59:59, o maior que cabe no LCD
+#define ATRASO_REPETICAO_TEMPO_MS 400 //Do aperto à primeira repetição
+#define PERIODO_REPETICAO_TEMPO_MS 100 //Menor que ESPERA_BOTOES_MS: na prática, uma repetição por iteração
+#define JANELA_ACORDE_TEMPO_MS 100 //O passo de um aperto sozinho espera isto (ou soltar): o outro botão ainda pode formar o acorde
+#define TAMANHO_TEXTO_TEMPO 17 //"9:59:59" e '\0'; o snprintf precisa de lugar para qualquer unsigned int nas horas
+#define INTERVALO_TELEMETRIA_CASAS_MS 20 //Varredura das casas durante a espera dos botões, com a telemetria ligada
+
+//Páginas da tela de diagnóstico
+#define PAGINA_DIAGNOSTICO_BLUETOOTH TRANSPORTE_BLUETOOTH
+#define PAGINA_DIAGNOSTICO_WIFI TRANSPORTE_WIFI
+#define PAGINA_DIAGNOSTICO_MEMORIA 2
+#define PAGINA_DIAGNOSTICO_CICLO 3
+#define PAGINA_DIAGNOSTICO_CASAS 4
+#define PAGINA_DIAGNOSTICO_CALIBRACAO 5
+#define QUANTIDADE_PAGINAS_DIAGNOSTICO 6
+#define PERIODO_ATUALIZACAO_DIAGNOSTICO_MS 1000
+#define PERIODO_ATUALIZACAO_CASAS_MS 250 //Leituras ao vivo enquanto o operador mexe nas peças
+#define COLUNAS_LCD 20
+#define TAMANHO_LINHA_DIAGNOSTICO 80 //Cabe a linha mais longa que os formatos das páginas podem gerar; o LCD mostra só COLUNAS_LCD
+
+#define COLUNA_CASAS_CONFERENCIA 10 //Casas 0 a 7 da tela de conferência do tabuleiro
+#define TEMPO_AVISO_CONFERENCIA_MS 1000
+#define TEMPO_AVISO_LANCE_MS 500
 
 //Notas para efeitos sonoros
 #define NOTE_B4  494
@@ -123,72 +140,180 @@
 
 using namespace std;
 
-#if !defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED)
+#if TIX_BLUETOOTH && (!defined(CONFIG_BT_ENABLED) || !defined(CONFIG_BLUEDROID_ENABLED))
 #erro Bluetooth nao esta habilitado! Por favor, execute "make menuconfig" e habilite-o
 #endif
 
+//Credenciais das conexões
+#define ID_BLUETOOTH_WIFI "TiX"
+#define SENHA_WIFI "ufsc"
+#define PORTA_WIFI 5000
+#define PERIODO_CONSULTA_CLIENTE_WIFI_MS 250 //O WiFiClient não avisa quando o socket é aceito ou fechado
+
 Preferences preferences; //Para ler e gravar dados na memória flash do microcontrolador
+#if TIX_BLUETOOTH
 BluetoothSerial SerialBT;
-LiquidCrystal_I2C lcd(0x27, 20, 4);
+#endif
+#if TIX_WIFI
+WiFiServer server(PORTA_WIFI);
+WiFiClient client;
+#endif
+CanalHost canal_host; //Mensagens e comandos do host, pelo transporte conectado
+EntradaComandos comandos_serial = {}; //Linha em montagem da serial USB, que só traz comandos de diagnóstico
+LcdMedido lcd(0x27, 20, 4); //Conta os bytes enviados para a taxa de escrita I2C da tela de diagnóstico
 
 bool turno = BRANCAS;
 bool primeiro_loop = true;
 bool lance_invalido = false;
-bool existe_cliente = false;
-bool existe_cliente_anterior = false;
+bool aviso_lance = false; //Aviso de desfazer/refazer na linha 3
+bool acorde_acionado = false; //Desfazer e refazer agem uma vez por aperto do acorde
+bool tabuleiro_conferido = false; //Peças conferidas com posicao_inicial_partida desde o fim da última partida
 int indice_origem = -1;
 int indice_destino = -1;
 unsigned int opcao_selecionada = MENU_INICIAL;
 unsigned int posicao_seta = LINHA_JOGADOR_VS_JOGADOR;
-unsigned int tempo_inicio_turno = 0;
+unsigned int tempo_inicio_turno = 0; //Até onde o relógio da vez já foi descontado
 unsigned int tempo_configurado = 5*60; //Este valor só foi utilizado na primeira utilização do sistema, em todas as outras o tempo configurado corresponde ao último tempo configurado pelo usuário
 unsigned int tempo_configurado_anterior = tempo_configurado;
-unsigned int tempo_restante_pretas = tempo_configurado;
+char tempo_configurado_mostrado[TAMANHO_TEXTO_TEMPO] = ""; //Como o LCD mostra o tempo configurado, para reescrever só o que mudou
+char tempo_brancas_mostrado[TAMANHO_TEXTO_TEMPO] = ""; //O mesmo para os relógios da partida
+char tempo_pretas_mostrado[TAMANHO_TEXTO_TEMPO] = "";
+uint32_t aperto_ajuste_tempo = 0; //InstanteAperto() do aperto que está ajustando o tempo
+unsigned long proxima_repeticao_tempo = 0;
+bool passo_tempo_pendente = false; //Aperto novo cujo passo ainda espera a JANELA_ACORDE_TEMPO_MS
+uint8_t botao_ajuste_tempo = BOTAO_DIREITA;
+unsigned int tempo_restante_pretas = tempo_configurado; //Como o LCD mostra, arredondados para cima a partir dos relógios em ms
 unsigned int tempo_restante_brancas = tempo_configurado;
-unsigned int quantidade_alteracoes_estado = 0;
+unsigned long tempo_restante_pretas_ms = tempo_configurado * 1000UL;
+unsigned long tempo_restante_brancas_ms = tempo_configurado * 1000UL;
 unsigned int tempo_notificacao_lance_invalido = 0;
+unsigned long tempo_brancas_inicio_vez_ms = tempo_configurado * 1000UL; //Relógios no início da vez, guardados com o lance no histórico
+unsigned long tempo_pretas_inicio_vez_ms = tempo_configurado * 1000UL;
+unsigned int pagina_diagnostico = PAGINA_DIAGNOSTICO_BLUETOOTH;
+unsigned long tempo_atualizacao_diagnostico = 0;
+unsigned int passo_calibracao = 0;
 char resultado_jogo = '\0';
-String mensagem_recebida = "";
-vector<int> botoes = {PINO_BOTAO_ESQUERDA, PINO_BOTAO_CENTRO, PINO_BOTAO_DIREITA};
-vector<int> casas = {PINO_CASA0, PINO_CASA1, PINO_CASA2, PINO_CASA3, PINO_CASA4, PINO_CASA5, PINO_CASA6, PINO_CASA7};
-vector<bool> estado_botoes = {DESACIONADO, DESACIONADO, DESACIONADO};
-vector<String> estado_atual = {"RB", "CB", "TB", "V", "V", "TP", "CP", "RP"}; //C = Cavalo, R = Rei, T = Torre, V = Vazio
-vector<String> estado_anterior = {"RB", "CB", "TB", "V", "V", "TP", "CP", "RP"}; 
+#if TIX_BLUETOOTH
+bool bluetooth_ativo = false;
+#endif
+#if TIX_WIFI
+bool wifi_ativo = false;
+volatile bool estacao_wifi_associada = false; //Escrito pelo evento do ponto de acesso
+bool cliente_wifi_aceito = false;
+unsigned long tempo_consulta_cliente_wifi = 0;
+#endif
+char mensagem_recebida[TAMANHO_MAXIMO_MENSAGEM + 2] = ""; //Com o último caractere do quadro e o '\0'
+char mensagem_pendente[TAMANHO_MAXIMO_MENSAGEM + 1] = ""; //Última mensagem enviada ao host, reenviada se ele reconectar
+uint32_t geracao_conexao_envio = 0; //GeracaoConexao() quando ela foi enviada
+bool aguardando_host = false; //Lance pendente na telemetria
+uint64_t inicio_vez_us = 0; //RelogioTabuleiroUs() no início da vez, adiantado pelas pausas
+uint64_t instante_lance_us = 0; //No aperto do relógio, na peça assentada do lance automático ou no tempo esgotado
+unsigned long tempo_lance_ms = 0; //TempoRestanteMs() de quem lançou, no instante_lance_us
+uint64_t inicio_pausa_us = 0; //0 fora da pausa
+constexpr array<uint8_t, QUANTIDADE_BOTOES> botoes = {{PINO_BOTAO_ESQUERDA, PINO_BOTAO_CENTRO, PINO_BOTAO_DIREITA}};
+constexpr array<uint8_t, QUANTIDADE_CASAS> casas = {{PINO_CASA0, PINO_CASA1, PINO_CASA2, PINO_CASA3, PINO_CASA4, PINO_CASA5, PINO_CASA6, PINO_CASA7}};
+array<bool, QUANTIDADE_BOTOES> estado_botoes = {{DESACIONADO, DESACIONADO, DESACIONADO}};
+constexpr array<unsigned int, 8> tempos_predefinidos = {{1*60, 3*60, 5*60, 10*60, 15*60, 30*60, 60*60, 90*60}}; //Recuperados com esquerda + direita ao configurar o tempo
+EstadoTabuleiro estado_atual = ESTADO_INICIAL;
+EstadoTabuleiro estado_anterior = ESTADO_INICIAL;
+EstadoTabuleiro posicao_inicial_partida = ESTADO_INICIAL; //Posição adotada na conferência, ou a inicial
+EstadoTabuleiro estado_lido = ESTADO_INICIAL; //Peça classificada na última varredura, antes da confirmação
+array<uint16_t, QUANTIDADE_CASAS> leituras_casas = {}; //Última leitura crua do ADC de cada casa
 
 void CapturaEstadoAtual();
-void PrintaEstado(vector<String> estado); //Para depuração
+uint8_t AmostraBotoes();
+void AmostraCasas(uint16_t leituras[QUANTIDADE_CASAS]);
+bool AguardaCasasAssentadas();
+void FormataEstado(const EstadoTabuleiro &estado, char *destino); //Para depuração
 void EnviaMensagem();
+void EnviaAoHost(const char *mensagem);
 void PrintaMenuInicial();
-void LeBotoes();
+void LeBotoes(unsigned int espera_ms = ESPERA_BOTOES_MS);
+void AcompanhaCasasNaEspera();
 void AtualizaOpcaoSelecionadaMenu(unsigned int primeira_linha_valida, unsigned int ultima_linha_valida, unsigned int incremento_linha, unsigned int som_confirmacao); //A opção selecionada pelo usuário é baseada na posição da seta mostrada no LCD, "incremento_linha" serve para diferenciar opções na mesma linha mas em menus diferentes
 void PrintaMenuJogadorVsJogador();
 void PrintaMenuJogadorVsMaquina();
 void PrintaAbertura();
 void AtualizaCronometro();
 void AtualizaTurnoEPause();
+void EnviaLance();
+void NotificaLanceInvalido();
+bool AmostraLanceAutomatico();
+void MarcaInicioVez();
+void DefineRelogios(unsigned long brancas_ms, unsigned long pretas_ms);
+void DescontaRelogioVez(unsigned long agora_ms);
+unsigned long TempoRestanteMs(bool brancas, bool correndo = true);
+unsigned long PensamentoMs();
+void PublicaEstadoTelemetria();
+void EmpilhaLanceAceito();
+void DesfazLance();
+void RefazLance();
+bool EnviaHistoricoAoHost(const char *comando, uint32_t hash);
+void MostraVez();
+void AvisaLance(const char *aviso);
 void PrintaMenuPause();
 void PrintaMenuConfigurarTempo();
 void ConfigurarTempo();
 void PrintaTempo(unsigned int linha, unsigned int coluna, unsigned int tempo);
+void FormataTempo(unsigned int tempo, char destino[TAMANHO_TEXTO_TEMPO]);
+void AtualizaTempo(unsigned int coluna, unsigned int linha, unsigned int tempo, char mostrado[TAMANHO_TEXTO_TEMPO]);
+void AjustaTempoSegurado(uint8_t botao);
+void AplicaPassoTempo(uint8_t botao, unsigned int passo);
+unsigned int PassoRepeticaoTempo(unsigned long segurado_ms);
+unsigned int ProximoTempoPredefinido(unsigned int tempo);
 void SomNavegacao();
 void SomConfirmar();
 void SomConfigurarTempo();
 void SomPause();
 void SomFimPartida();
 void SomIniciarPartida();
-void PrintaTextoComSom(unsigned int coluna, unsigned int linha, string texto);
-void CalculaIndicesOrigemDestino();
-void CalculaNumeroAlteracoes();
+void PrintaTextoComSom(unsigned int coluna, unsigned int linha, const char *texto);
 void SomLanceInvalido();
 void LimparLinhaLanceInvalido();
 void AguardaMensagem(char primeiro_caractere, char ultimo_caractere);
-void PrintaEstadosAlteracoesIndices(); //Para depuração
+void PrintaEstadosLance(const LanceReconhecido &lance); //Para depuração
 void AnalisaMensagemRecebida();
 void SomVitoria();
 void SomEmpate();
 void PrintaMenuFimPartida();
 void ResetaVariaveis();
+bool ConfereTabuleiro();
+bool IniciaPartidaConferida();
+bool EnviaPosicaoInicial();
+void AtualizaConferenciaTabuleiro();
+void PrintaConferenciaTabuleiro();
+void PrintaLeituraConferencia();
+void PrintaAvisoConferencia(const char *aviso);
 void VerificaClienteConectado();
+#if TIX_BLUETOOTH
+void EventoBluetooth(esp_spp_cb_event_t evento, esp_spp_cb_param_t *parametro);
+void AtivaBluetooth();
+void DesativaBluetooth();
+#endif
+#if TIX_WIFI
+void EventoWifi(WiFiEvent_t evento, WiFiEventInfo_t informacao);
+void ConsultaClienteWifi();
+void AtivaWifi();
+void DesativaWifi();
+#endif
+#if TIX_BLUETOOTH && TIX_WIFI
+void LigaRadio(uint8_t transporte, bool ligado);
+#endif
+uint8_t TransporteAtual();
+void AtualizaDiagnostico();
+void PrintaPaginaDiagnostico();
+void PrintaLinhaDiagnostico(unsigned int linha, const char *texto);
+void PrintaPaginaLatencia();
+void PrintaPaginaMemoria();
+void PrintaPaginaCiclo();
+void PrintaPaginaCasas();
+void PrintaPaginaCalibracao();
+void AtualizaCalibracao();
+void AmostraPassoCalibracao();
+void PrintaPassoCalibracao();
+void PrintaLeituraCalibracao();
+void PrintaResultadoCalibracao(const ResultadoCalibracao &resultado);
+void SaiCalibracao();
 
 //Caracteres customizados
 byte trofeu[] = {
@@ -281,24 +406,46 @@ byte x_backlight_invertido[] = {
 void setup()
 {
   Serial.begin(9600);
-  SerialBT.begin("TiX"); //Inicia a comunicação Bluetooth
+  MonitoraPilhaTarefa("loop"); //Tarefa do Arduino que executa o setup() e o loop()
+  IniciaRegistro(); //Os registros de depuração são escritos na serial por uma tarefa de baixa prioridade
+  IniciaCiclo(); //Período do loop() e vigia de iterações travadas
+#if TIX_BLUETOOTH
+  SerialBT.register_callback(EventoBluetooth); //Conexões chegam por eventos dos rádios, sem consultá-los a cada loop()
+  canal_host.Adiciona(TRANSPORTE_BLUETOOTH, SerialBT);
+#endif
+#if TIX_WIFI
+  WiFi.onEvent(EventoWifi);
+  canal_host.Adiciona(TRANSPORTE_WIFI, client);
+#endif
+#if TIX_BLUETOOTH && TIX_WIFI
+  IniciaConexao(TRANSPORTES_FIRMWARE, LigaRadio); //Com um cliente, o outro rádio é desligado
+#else
+  IniciaConexao(TRANSPORTES_FIRMWARE, nullptr); //Só um rádio, que nunca é desligado
+#endif
+#if TIX_BLUETOOTH
+  AtivaBluetooth();
+#endif
+#if TIX_WIFI
+  AtivaWifi();
+#endif
   Wire.begin(PINO_SDA, PINO_SCL); //Inicia a comunicação I2C
 
   pinMode(PINO_BUZZER, OUTPUT);
-  pinMode(PINO_LED_BLUETOOTH, OUTPUT);
+  pinMode(PINO_LED, OUTPUT);
 
-  for (int i = 0; i < casas.size(); i++)
+  for (unsigned int i = 0; i < casas.size(); i++)
     pinMode(casas.at(i), INPUT);
-  for (int i = 0; i < botoes.size(); i++)
+  for (unsigned int i = 0; i < botoes.size(); i++)
     pinMode(botoes.at(i), INPUT_PULLUP);
 
   digitalWrite(PINO_BUZZER, LOW);
-  digitalWrite(PINO_LED_BLUETOOTH, LOW); 
+  digitalWrite(PINO_LED, LOW); 
   
-  preferences.begin("dados", true); //Inicia a memória não volátil (para salvar as configurações e recuperar mesmo após o microcontrolador delsigar)
-  tempo_configurado = preferences.getInt("tempo", 5*60);
+  preferences.begin("dados", false); //Inicia a memória não volátil (para salvar as configurações e recuperar mesmo após o microcontrolador delsigar)
+  tempo_configurado = preferences.getInt("tempo", 5*60); //A NVS fica aberta: abrir e fechar a cada gravação aloca memória dinâmica
   tempo_configurado_anterior = tempo_configurado;
-  preferences.end();
+  CarregaCalibracao(preferences); //Perfil por casa salvo pelo assistente, ou a tabela nominal
+  DefineJanelaLanceAutomatico(preferences.getUInt("auto", JANELA_LANCE_AUTOMATICO_PADRAO_MS));
 
   lcd.init();
   lcd.backlight();
@@ -312,11 +459,20 @@ void setup()
   lcd.createChar(X_BACKLIGHT_INVERTIDO, x_backlight_invertido);
   
   PrintaAbertura();
+
+#ifdef TIX_BANCADA
+  ExecutaBancada(Serial); //Mede as funções do caminho crítico e imprime o resultado em JSON
+#endif
+
+  IniciaTarefas(canal_host); //Botões, rádio, casas e som saem do loop(); a bancada acima mede as funções sem elas
 }
 
 void loop()
 {
-  VerificaClienteConectado();
+  InicioIteracao();
+  AtendeRadio(); //Comandos de diagnóstico do host ("?rastro", ...); a conexão é conferida pela tarefa de comunicação
+  ProcessaComandos(Serial, comandos_serial, true);
+  AmostraMemoria(); //Heap e pilhas, uma vez por segundo
 
   switch (opcao_selecionada)
   {
@@ -332,13 +488,30 @@ void loop()
       AtualizaOpcaoSelecionadaMenu(LINHA_INICIAR_JOGADOR_VS_JOGADOR, LINHA_VOLTAR_JOGADOR_VS_JOGADOR, 10, SOM_INICIAR_PARTIDA);
       break;
 
+    case ALTERNAR_LANCE_AUTOMATICO: //Cada confirmação passa para a próxima janela e volta ao menu na mesma linha
+      DefineJanelaLanceAutomatico(ProximaJanelaLanceAutomatico());
+      preferences.putUInt("auto", JanelaLanceAutomatico());
+
+      opcao_selecionada = JOGADOR_VS_JOGADOR;
+      posicao_seta = LINHA_LANCE_AUTOMATICO;
+      primeiro_loop = true;
+      break;
+
     case JOGAR_NOVAMENTE:
     case CONTINUAR:
     case INICIAR_JOGADOR_VS_JOGADOR:
       if(primeiro_loop == true)
       {
+        if(!tabuleiro_conferido) //Partida nova: o relógio só começa com as peças conferidas
+        {
+          opcao_selecionada = MENU_CONFERE_TABULEIRO;
+          break;
+        }
+
         lcd.home();
         lcd.print(" Pretas    Brancas");
+        tempo_brancas_mostrado[0] = '\0'; //Tela redesenhada: os relógios saem inteiros
+        tempo_pretas_mostrado[0] = '\0';
 
         if(turno == PRETAS)
         {
@@ -353,16 +526,34 @@ void loop()
         
         tempo_inicio_turno = millis(); //Armazena o tempo atual para periodizar a atualização do cronômetro
         primeiro_loop = false;
+
+        if(inicio_pausa_us) //A pausa não conta no tempo da vez enviado ao host
+        {
+          inicio_vez_us += RelogioTabuleiroUs() - inicio_pausa_us;
+          inicio_pausa_us = 0;
+        }
       }
         
       AtualizaCronometro();
-      LeBotoes();
+      CapturaEstadoAtual(); //Acompanha as casas entre os lances: no relógio elas normalmente já estão assentadas
+
+      if(JanelaLanceAutomatico() > 0)
+      {
+        if(AmostraLanceAutomatico()) //Lance enviado sem o relógio: os botões ficam para a próxima iteração
+          break;
+      }
+      else if(PublicacaoLigada())
+        AcompanhaCasasNaEspera();
+      else
+        LeBotoes();
+
       AtualizaTurnoEPause();
       
-      if(millis() - tempo_notificacao_lance_invalido >= 500 && lance_invalido)
+      if(millis() - tempo_notificacao_lance_invalido >= TEMPO_AVISO_LANCE_MS && (lance_invalido || aviso_lance))
       {
         LimparLinhaLanceInvalido();
         lance_invalido = false;
+        aviso_lance = false;
       }
 
       break;
@@ -441,80 +632,167 @@ void loop()
     AtualizaOpcaoSelecionadaMenu(LINHA_JOGAR_NOVAMENTE, LINHA_VOLTAR_FIM_PARTIDA, 50, SOM_INICIAR_PARTIDA);
     break;
 
+    case MENU_DIAGNOSTICO:
+      if(primeiro_loop == true)
+      {
+        pagina_diagnostico = PAGINA_DIAGNOSTICO_BLUETOOTH;
+        PrintaPaginaDiagnostico();
+        primeiro_loop = false;
+      }
+
+      LeBotoes();
+      AtualizaDiagnostico();
+      break;
+
+    case MENU_CALIBRACAO:
+      if(primeiro_loop == true)
+      {
+        passo_calibracao = 0;
+        IniciaCalibracao();
+        lcd.clear();
+        PrintaPassoCalibracao();
+        primeiro_loop = false;
+      }
+
+      LeBotoes();
+      AtualizaCalibracao();
+      break;
+
+    case MENU_CONFERE_TABULEIRO:
+      if(primeiro_loop == true)
+      {
+        PrintaConferenciaTabuleiro();
+        primeiro_loop = false;
+      }
+
+      if(ConfereTabuleiro() && IniciaPartidaConferida()) //Com o tabuleiro já montado a partida começa na mesma iteração
+        break;
+
+      PrintaLeituraConferencia();
+      LeBotoes();
+      AtualizaConferenciaTabuleiro();
+      break;
+
     default:
       if(primeiro_loop == true)
       {
         PrintaMenuInicial();
+        posicao_inicial_partida = ESTADO_INICIAL; //A posição adotada vale até voltar ao menu inicial
         ResetaVariaveis();
       }
 
       LeBotoes();
-      AtualizaOpcaoSelecionadaMenu(LINHA_JOGADOR_VS_JOGADOR, LINHA_JOGADOR_VS_JOGADOR, 0, SOM_PADRAO);
+
+      if(ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO) //Atalho para a tela de diagnóstico
+      {
+        opcao_selecionada = MENU_DIAGNOSTICO;
+        primeiro_loop = true;
+        lcd.clear();
+        SomConfirmar();
+      }
+      else
+        AtualizaOpcaoSelecionadaMenu(LINHA_JOGADOR_VS_JOGADOR, LINHA_JOGADOR_VS_JOGADOR, 0, SOM_PADRAO);
       break;
   }
+
+  PublicaEstadoTelemetria();
+  FimIteracao();
 }
 
 void CapturaEstadoAtual()
 {
-  for(int i=0; i<casas.size(); i++)
+  TRECHO_ESCOPO("CapturaEstadoAtual");
+  ContaVarredura();
+
+  uint16_t leituras[QUANTIDADE_CASAS];
+  uint32_t tempo_leitura_ms = LeituraCasas(leituras); //Da tarefa de casas, ou lidas agora
+
+  for(unsigned int i=0; i<casas.size(); i++)
   {
-    if (analogRead(casas.at(i)) > VALOR_ANALOGICO_CAVALO_BRANCAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_CAVALO_BRANCAS + TOLERANCIA)
-      estado_atual.at(i) = "CB";
-    else if (analogRead(casas.at(i)) > VALOR_ANALOGICO_REI_BRANCAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_REI_BRANCAS + TOLERANCIA)
-      estado_atual.at(i) = "RB";
-    else if (analogRead(casas.at(i)) > VALOR_ANALOGICO_TORRE_BRANCAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_TORRE_BRANCAS + TOLERANCIA)
-      estado_atual.at(i) = "TB";
-    else if (analogRead(casas.at(i)) > VALOR_ANALOGICO_CAVALO_PRETAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_CAVALO_PRETAS + TOLERANCIA)
-      estado_atual.at(i) = "CP";
-    else if (analogRead(casas.at(i)) > VALOR_ANALOGICO_REI_PRETAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_REI_PRETAS + TOLERANCIA)
-      estado_atual.at(i) = "RP";
-    else if (analogRead(casas.at(i)) > VALOR_ANALOGICO_TORRE_PRETAS - TOLERANCIA && analogRead(casas.at(i)) < VALOR_ANALOGICO_TORRE_PRETAS + TOLERANCIA)
-      estado_atual.at(i) = "TP";
-    else
-      estado_atual.at(i) = "V";
+    int leitura = leituras[i];
+    leituras_casas.at(i) = leitura;
 
-    
-    Serial.print(analogRead(casas.at(i)));
-    Serial.print(" ");
+    Peca antes = estado_atual.at(i);
+    estado_lido.at(i) = ClassificaCasa(i, leitura);
+    estado_atual.at(i) = AtualizaEstadoCasa(i, leitura, estado_lido.at(i), tempo_leitura_ms);
+
+    if(estado_atual.at(i) != antes) //Peça levantada, colocada ou trocada: entra na sequência do lance
+      RegistraEventoCasa(InicioMudancaCasa(i), i, antes, estado_atual.at(i));
+
+    REGISTRA_DEPURACAO("Casa %d: leitura %d", i, leitura);
   }
 
-  Serial.println();
+  PublicaEstadoTelemetria(); //As peças levantadas e colocadas aparecem no host antes do lance
+}
+
+void AmostraCasas(uint16_t leituras[QUANTIDADE_CASAS])
+{
+  for(unsigned int i=0; i<casas.size(); i++)
+    leituras[i] = analogRead(casas.at(i)); //Uma conversão por casa: a classificação e o registro usam o mesmo valor
+}
+
+bool AguardaCasasAssentadas() //Varre até todas as casas assentarem, por no máximo TEMPO_MAXIMO_ACOMODACAO_MS
+{
+  TRECHO_ESCOPO("AguardaCasasAssentadas");
+  unsigned long inicio = millis();
+
+  CapturaEstadoAtual();
+  if(CasasAssentadas())
+    return true;
+
+  while(true)
+  {
+    delay(INTERVALO_ACOMODACAO_MS);
+    CapturaEstadoAtual();
+
+    bool assentadas = CasasAssentadas();
+    if(assentadas || millis() - inicio >= TEMPO_MAXIMO_ACOMODACAO_MS)
+    {
+      ContaEsperaAcomodacao(millis() - inicio, assentadas);
+      if(!assentadas)
+        REGISTRA_AVISO("Casas nao assentaram em %d ms, lance recusado", TEMPO_MAXIMO_ACOMODACAO_MS);
+
+      return assentadas;
+    }
+  }
 }
 
-void PrintaEstado(vector<String> estado)
+void FormataEstado(const EstadoTabuleiro &estado, char *destino)
 {
-  for(int i=0; i<estado.size(); i++)
+  destino[0] = '\0';
+
+  for(unsigned int i=0; i<estado.size(); i++)
   {
-    Serial.print(estado.at(i));
-    Serial.print(" ");
+    if(i > 0)
+      strcat(destino, " ");
+    strcat(destino, NomePeca(estado.at(i)));
   }
-     
-  Serial.println();
 }
 
-void EnviaMensagem()
+void EnviaMensagem() //Com o início da vez e o instante do lance no relógio do tabuleiro (sincronia.h), e o relógio e o tempo da vez em ms
 {
-  String string_estado_atual = "";
+  char mensagem[TAMANHO_MAXIMO_MENSAGEM + 1];
+  char inicio_vez[TAMANHO_TEXTO_MICROS];
+  char instante_lance[TAMANHO_TEXTO_MICROS];
 
-  string_estado_atual += '[';
-  string_estado_atual += indice_origem;
-  string_estado_atual += ',';
-  string_estado_atual += ' ';
-  string_estado_atual += indice_destino;
-  string_estado_atual += ',';
-  string_estado_atual += ' ';
+  FormataMicros(inicio_vez_us, inicio_vez, sizeof(inicio_vez));
+  FormataMicros(instante_lance_us, instante_lance, sizeof(instante_lance));
+  snprintf(mensagem, sizeof(mensagem), "[%d, %d, %u, %u, %lu, %s, %s, %lu, %lu]", indice_origem, indice_destino,
+           turno == BRANCAS ? tempo_restante_brancas : tempo_restante_pretas, tempo_configurado,
+           (unsigned long)ProximaSequenciaSessao(), inicio_vez, instante_lance, tempo_lance_ms, PensamentoMs());
 
-  if(turno == BRANCAS)
-    string_estado_atual += tempo_restante_brancas;
-  else
-    string_estado_atual += tempo_restante_pretas;
+  EnviaAoHost(mensagem);
+}
 
-  string_estado_atual += ',';
-  string_estado_atual += ' ';
-  string_estado_atual += tempo_configurado;
-  string_estado_atual += ']';
-  
-  SerialBT.println(string_estado_atual);
+void EnviaAoHost(const char *mensagem) //Guarda a mensagem para reenviá-la igual (com a mesma sequência) numa reconexão
+{
+  if(mensagem != mensagem_pendente)
+    snprintf(mensagem_pendente, sizeof(mensagem_pendente), "%s", mensagem);
+  geracao_conexao_envio = GeracaoConexao();
+
+  TravaRadio();
+  canal_host.println(mensagem_pendente);
+  LiberaRadio();
 }
 
 void PrintaMenuInicial()
@@ -526,16 +804,45 @@ void PrintaMenuInicial()
   lcd.print("Jogador X Jogador");
 }
 
-void LeBotoes()
+void LeBotoes(unsigned int espera_ms)
 {
-  delay(150); //Evita o movimento acelarado da seta (provisório)
+  TRECHO_ESCOPO("LeBotoes");
 
-  for(int i=0; i<botoes.size(); i++)
+  uint8_t acionados = EsperaBotoes(espera_ms); //Inclui os apertos dados enquanto o loop() estava ocupado
+
+  for(unsigned int i=0; i<botoes.size(); i++)
   {
-    if(digitalRead(botoes.at(i)) == 1) //Se estiver desacionado é 1 (resistor de pull-up)
-      estado_botoes.at(i) = DESACIONADO;
-    else
+    if(acionados & (1 << i))
       estado_botoes.at(i) = ACIONADO;
+    else
+      estado_botoes.at(i) = DESACIONADO;
+  }
+}
+
+uint8_t AmostraBotoes()
+{
+  uint8_t acionados = 0;
+
+  for(unsigned int i=0; i<botoes.size(); i++)
+    if(digitalRead(botoes.at(i)) == 0) //Se estiver desacionado é 1 (resistor de pull-up)
+      acionados |= 1 << i;
+
+  return acionados;
+}
+
+void AcompanhaCasasNaEspera() //A espera de LeBotoes() em fatias, varrendo as casas entre elas
+{
+  unsigned long inicio = millis();
+
+  while(true)
+  {
+    LeBotoes(INTERVALO_TELEMETRIA_CASAS_MS);
+
+    bool acionado = ESTADO_BOTAO_ESQUERDA == ACIONADO || ESTADO_BOTAO_CENTRO == ACIONADO || ESTADO_BOTAO_DIREITA == ACIONADO;
+    if(acionado || millis() - inicio >= ESPERA_BOTOES_MS)
+      return;
+
+    CapturaEstadoAtual();
   }
 }
 
@@ -589,7 +896,7 @@ void AtualizaOpcaoSelecionadaMenu(unsigned int primeira_linha_valida, unsigned i
 
 void PrintaMenuJogadorVsJogador()
 {
-  lcd.home();
+  lcd.setCursor(0, posicao_seta);
   lcd.write(SETA_DIREITA);
 
   lcd.setCursor(2, 0);
@@ -598,7 +905,17 @@ void PrintaMenuJogadorVsJogador()
   lcd.setCursor(2, 1);
   lcd.print("Configurar Tempo");
 
-  lcd.setCursor(2, 2);
+  lcd.setCursor(2, LINHA_LANCE_AUTOMATICO);
+  lcd.print("Lance auto: ");
+  if(JanelaLanceAutomatico() > 0)
+  {
+    lcd.print(JanelaLanceAutomatico());
+    lcd.print("ms");
+  }
+  else
+    lcd.print("nao");
+
+  lcd.setCursor(2, LINHA_VOLTAR_JOGADOR_VS_JOGADOR);
   lcd.print("Voltar");
 }
 
@@ -638,25 +955,21 @@ void PrintaAbertura()
   lcd.backlight();
 }
 
-void AtualizaCronometro() //Sobreecreve dados ciclicamente mesmo sem terem mudado (provisório)
+void AtualizaCronometro() //Reescreve só os dígitos que mudaram desde a última iteração
 {
-  if(turno == BRANCAS && millis() - tempo_inicio_turno >= 1000)
-  {
-    tempo_inicio_turno = millis();
-    tempo_restante_brancas--;
-  }
-  else if(turno == PRETAS && millis() - tempo_inicio_turno >= 1000)
-  {
-    tempo_inicio_turno = millis();
-    tempo_restante_pretas--;
-  }
+  DescontaRelogioVez(millis());
   
-  PrintaTempo(12, 1, tempo_restante_brancas);
-  PrintaTempo(1, 1, tempo_restante_pretas);
+  INICIA_TRECHO("LCD cronometro");
+  AtualizaTempo(12, 1, tempo_restante_brancas, tempo_brancas_mostrado);
+  AtualizaTempo(1, 1, tempo_restante_pretas, tempo_pretas_mostrado);
+  FINALIZA_TRECHO("LCD cronometro");
 
   if(tempo_restante_brancas <= 0)
   {
+    instante_lance_us = RelogioTabuleiroUs();
+    tempo_lance_ms = 0;
     EnviaMensagem();
+    RegistraEventoSessao(EVENTO_FIM, -1, -1, VITORIA_PRETAS, estado_anterior, turno == BRANCAS, 0, TempoRestanteMs(false, false), PensamentoMs());
 
     opcao_selecionada = MENU_FIM_PARTIDA;
     resultado_jogo = VITORIA_PRETAS;
@@ -664,7 +977,10 @@ void AtualizaCronometro() //Sobreecreve dados ciclicamente mesmo sem terem mudad
   }
   else if(tempo_restante_pretas <= 0)
   {
+    instante_lance_us = RelogioTabuleiroUs();
+    tempo_lance_ms = 0;
     EnviaMensagem();
+    RegistraEventoSessao(EVENTO_FIM, -1, -1, VITORIA_BRANCAS, estado_anterior, turno == BRANCAS, TempoRestanteMs(true, false), 0, PensamentoMs());
 
     opcao_selecionada = MENU_FIM_PARTIDA;
     resultado_jogo = VITORIA_BRANCAS;
@@ -674,69 +990,351 @@ void AtualizaCronometro() //Sobreecreve dados ciclicamente mesmo sem terem mudad
 
 void AtualizaTurnoEPause()
 {
+  bool desfazer = ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO && ESTADO_BOTAO_CENTRO == DESACIONADO;
+  bool refazer = ESTADO_BOTAO_CENTRO == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO && ESTADO_BOTAO_ESQUERDA == DESACIONADO;
+
+  if(desfazer || refazer) //Segurar o acorde não desfaz vários lances: é preciso soltar e apertar de novo
+  {
+    if(!acorde_acionado)
+    {
+      if(desfazer)
+        DesfazLance();
+      else
+        RefazLance();
+    }
+
+    acorde_acionado = true;
+    return;
+  }
+
+  acorde_acionado = false;
+
   if(ESTADO_BOTAO_CENTRO == ACIONADO)
   {
+    DescontaRelogioVez(millis()); //Na volta da pausa o relógio recomeça do aperto
+    inicio_pausa_us = RelogioTabuleiroUs();
     opcao_selecionada = MENU_PAUSE;
     primeiro_loop = true;
     posicao_seta = 0;
     lcd.clear();
   }
-  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO)
-    return;
-  else if(ESTADO_BOTAO_DIREITA == ACIONADO && turno == BRANCAS || ESTADO_BOTAO_ESQUERDA == ACIONADO && turno == PRETAS)
+  else if((ESTADO_BOTAO_DIREITA == ACIONADO && turno == BRANCAS) || (ESTADO_BOTAO_ESQUERDA == ACIONADO && turno == PRETAS))
   {
-    CapturaEstadoAtual();
-    CalculaNumeroAlteracoes();
-    CalculaIndicesOrigemDestino();
-
-    PrintaEstadosAlteracoesIndices();
-
-    if(quantidade_alteracoes_estado == 2 && indice_origem != -1 && indice_destino != -1)
-    {
-      EnviaMensagem();
-      AguardaMensagem('[', ']');
-      Serial.println(mensagem_recebida);
-      
-      AnalisaMensagemRecebida();
-    }
+    INICIA_TRECHO("Lance");
+    instante_lance_us = RelogioTabuleiroUs(); //O aperto do relógio, antes da espera das casas
+    DescontaRelogioVez(millis()); //Aceito o lance, o relógio do adversário corre a partir daqui
+    tempo_lance_ms = TempoRestanteMs(turno == BRANCAS);
+
+    bool casas_assentadas = AguardaCasasAssentadas();
+    INICIA_TRECHO("Validacao");
+    LanceReconhecido lance = ReconheceLance(estado_atual, turno == BRANCAS);
+    indice_origem = lance.origem;
+    indice_destino = lance.destino;
+    FINALIZA_TRECHO("Validacao");
+
+    PrintaEstadosLance(lance);
+
+    if(casas_assentadas && lance.resultado == LANCE_RECONHECIDO)
+      EnviaLance();
     else
       lance_invalido = true;
 
     if(lance_invalido)
-    {
-      lcd.setCursor(1, 3);
-      lcd.write(NOTIFICACAO);
-      lcd.setCursor(3, 3);
-      lcd.print("Invalido");
-      SomLanceInvalido();
-      tempo_notificacao_lance_invalido = millis();
-    }
+      NotificaLanceInvalido();
 
     indice_origem = -1;
     indice_destino = -1;
-    quantidade_alteracoes_estado = 0;
+
+    FINALIZA_TRECHO("Lance");
   }
 }
 
-void AnalisaMensagemRecebida()
+void EnviaLance() //Lance em indice_origem e indice_destino
+{
+  INICIA_TRECHO("Ida e volta radio");
+  unsigned long inicio_ida_e_volta = micros();
+  EnviaMensagem();
+  AguardaMensagem('[', ']');
+  RegistraIdaEVolta(TransporteAtual(), micros() - inicio_ida_e_volta);
+  FINALIZA_TRECHO("Ida e volta radio");
+
+  AnalisaMensagemRecebida();
+}
+
+void NotificaLanceInvalido()
+{
+  INICIA_TRECHO("LCD lance invalido");
+  AvisaLance("Invalido"); //Limpa a linha: um aviso de desfazer ou refazer ainda na tela é mais longo
+  FINALIZA_TRECHO("LCD lance invalido");
+  lance_invalido = true;
+  aviso_lance = false;
+  SomLanceInvalido();
+  tempo_notificacao_lance_invalido = millis(); //Depois do som, que sem a tarefa de som toca na hora
+}
+
+bool AmostraLanceAutomatico() //A espera dos botões em fatias, varrendo as casas entre elas; true se um lance foi enviado
+{
+  TRECHO_ESCOPO("AmostraLanceAutomatico");
+  unsigned long inicio = millis();
+
+  while(true)
+  {
+    LanceReconhecido lance;
+
+    if(LanceAutomaticoPronto(estado_anterior, estado_atual, turno == BRANCAS, millis(), lance))
+    {
+      indice_origem = lance.origem;
+      indice_destino = lance.destino;
+      instante_lance_us = RelogioTabuleiroUs() - (uint64_t)(millis() - lance.ultimo_evento_ms) * 1000; //Peça assentada, sem a janela
+      DescontaRelogioVez(millis()); //A janela de confirmação fica no relógio de quem jogou, como no LCD
+      tempo_lance_ms = TempoRestanteMs(turno == BRANCAS);
+      PrintaEstadosLance(lance);
+
+      EnviaLance();
+      RegistraLanceAutomatico(millis() - lance.ultimo_evento_ms);
+
+      if(lance_invalido)
+        NotificaLanceInvalido();
+
+      indice_origem = -1;
+      indice_destino = -1;
+      return true;
+    }
+
+    LeBotoes(INTERVALO_AMOSTRAGEM_AUTOMATICA_MS);
+
+    bool acionado = ESTADO_BOTAO_ESQUERDA == ACIONADO || ESTADO_BOTAO_CENTRO == ACIONADO || ESTADO_BOTAO_DIREITA == ACIONADO;
+    if(acionado || millis() - inicio >= ESPERA_BOTOES_MS) //Um aperto é atendido na hora, sem varrer o resto da espera
+      return false;
+
+    CapturaEstadoAtual();
+  }
+}
+
+void MarcaInicioVez() //Os relógios descontados até tempo_inicio_turno, onde a vez começou
+{
+  inicio_vez_us = RelogioTabuleiroUs();
+  tempo_brancas_inicio_vez_ms = tempo_restante_brancas_ms;
+  tempo_pretas_inicio_vez_ms = tempo_restante_pretas_ms;
+}
+
+void DefineRelogios(unsigned long brancas_ms, unsigned long pretas_ms)
+{
+  tempo_restante_brancas_ms = brancas_ms;
+  tempo_restante_pretas_ms = pretas_ms;
+  tempo_restante_brancas = (brancas_ms + 999) / 1000;
+  tempo_restante_pretas = (pretas_ms + 999) / 1000;
+}
+
+void DescontaRelogioVez(unsigned long agora_ms) //Em ms, sem perder a fração de uma iteração atrasada
 {
-  for(int i=0; i<mensagem_recebida.length(); i++)
+  unsigned long decorrido = agora_ms - tempo_inicio_turno;
+  tempo_inicio_turno = agora_ms;
+
+  if(turno == BRANCAS)
+    DefineRelogios(tempo_restante_brancas_ms > decorrido ? tempo_restante_brancas_ms - decorrido : 0, tempo_restante_pretas_ms);
+  else
+    DefineRelogios(tempo_restante_brancas_ms, tempo_restante_pretas_ms > decorrido ? tempo_restante_pretas_ms - decorrido : 0);
+}
+
+unsigned long TempoRestanteMs(bool brancas, bool correndo) //Com correndo, o relógio da vez inclui o que ainda não foi descontado
+{
+  unsigned long restante = brancas ? tempo_restante_brancas_ms : tempo_restante_pretas_ms;
+
+  if(correndo && brancas == (turno == BRANCAS))
   {
-    Serial.print("Mensagem recebida posicao ");
-    Serial.print(i);
-    Serial.print(": ");
-    Serial.println(mensagem_recebida[i]);
+    unsigned long decorrido = millis() - tempo_inicio_turno;
+    restante = restante > decorrido ? restante - decorrido : 0;
   }
 
-  Serial.println();
-  
+  return restante;
+}
+
+unsigned long PensamentoMs() //Da vez que terminou em instante_lance_us, sem as pausas
+{
+  return instante_lance_us > inicio_vez_us ? (unsigned long)((instante_lance_us - inicio_vez_us) / 1000) : 0;
+}
+
+void PublicaEstadoTelemetria() //Para a tarefa de comunicação: quadros no ritmo pedido pelo host e eventos do painel
+{
+  if(!PublicacaoLigada())
+    return;
+
+  EstadoTelemetria estado;
+  bool jogando = opcao_selecionada == INICIAR_JOGADOR_VS_JOGADOR || opcao_selecionada == CONTINUAR || opcao_selecionada == JOGAR_NOVAMENTE;
+
+  estado.em_partida = tabuleiro_conferido && (jogando || opcao_selecionada == MENU_PAUSE);
+  estado.relogio_correndo = estado.em_partida && jogando && !primeiro_loop; //Na primeira iteração o turno ainda não começou
+  estado.vez_brancas = turno == BRANCAS;
+  estado.lance_pendente = aguardando_host;
+  estado.tempo_brancas_ms = TempoRestanteMs(true, estado.relogio_correndo);
+  estado.tempo_pretas_ms = TempoRestanteMs(false, estado.relogio_correndo);
+  estado.folga_relogio_ms = 0;
+  estado.tabuleiro = estado_atual;
+
+  if(estado.relogio_correndo) //Até o LCD mudar de segundo
+    estado.folga_relogio_ms = ((turno == BRANCAS ? estado.tempo_brancas_ms : estado.tempo_pretas_ms) + 999) % 1000;
+
+  PublicaTelemetria(estado, millis());
+}
+
+void EmpilhaLanceAceito() //Antes de trocar a vez: estado_anterior ainda é a posição de antes do lance
+{
+  if(indice_origem < 0 || indice_destino < 0)
+    return;
+
+  LanceHistorico lance;
+  lance.lance = CompactaLance(indice_origem, indice_destino);
+  lance.peca = estado_anterior.at(indice_origem);
+  lance.capturada = estado_anterior.at(indice_destino);
+  lance.brancas = turno == BRANCAS;
+  lance.tempo_brancas_antes_ms = tempo_brancas_inicio_vez_ms;
+  lance.tempo_pretas_antes_ms = tempo_pretas_inicio_vez_ms;
+  lance.tempo_depois_ms = tempo_lance_ms;
+
+  EstadoTabuleiro depois = estado_anterior;
+  AplicaLanceHistorico(depois, lance);
+  lance.hash_depois = HashPosicao(depois, !lance.brancas);
+
+  EmpilhaLance(lance);
+}
+
+void DesfazLance() //Volta ao início da vez de quem fez o último lance, com os relógios daquele instante
+{
+  TRECHO_ESCOPO("DesfazLance");
+  LanceHistorico lance;
+
+  if(!DesempilhaLance(lance))
+  {
+    AvisaLance("Nada a desfazer");
+    SomLanceInvalido();
+    return;
+  }
+
+  EstadoTabuleiro posicao = estado_anterior;
+  DesfazLanceHistorico(posicao, lance);
+
+  if(!EnviaHistoricoAoHost("desfaz", HashPosicao(posicao, lance.brancas)))
+  {
+    CancelaDesempilhaLance();
+    AvisaLance("Host recusou");
+    SomLanceInvalido();
+    return;
+  }
+
+  DefineRelogios(lance.tempo_brancas_antes_ms, lance.tempo_pretas_antes_ms);
+  tempo_inicio_turno = millis();
+  turno = lance.brancas ? BRANCAS : PRETAS;
+  RegistraEventoSessao(EVENTO_DESFAZ, OrigemLance(lance.lance), DestinoLance(lance.lance), PARTIDA_CONTINUA, posicao, lance.brancas,
+                       TempoRestanteMs(true), TempoRestanteMs(false), 0);
+
+  estado_anterior = posicao; //O jogador devolve as peças e joga de novo: os eventos partem desta posição
+  IniciaReconhecimento(estado_anterior);
+  IniciaLanceAutomatico();
+  AguardaPosicaoLanceAutomatico();
+  MarcaInicioVez();
+
+  MostraVez();
+  AvisaLance("Desfeito");
+  SomConfirmar();
+}
+
+void RefazLance() //Reaplica o último lance desfeito e volta ao fim daquela vez
+{
+  TRECHO_ESCOPO("RefazLance");
+  LanceHistorico lance;
+
+  if(!ReempilhaLance(lance))
+  {
+    AvisaLance("Nada a refazer");
+    SomLanceInvalido();
+    return;
+  }
+
+  if(!EnviaHistoricoAoHost("refaz", lance.hash_depois))
+  {
+    CancelaReempilhaLance();
+    AvisaLance("Host recusou");
+    SomLanceInvalido();
+    return;
+  }
+
+  DefineRelogios(lance.brancas ? lance.tempo_depois_ms : lance.tempo_brancas_antes_ms,
+                 lance.brancas ? lance.tempo_pretas_antes_ms : lance.tempo_depois_ms);
+  tempo_inicio_turno = millis();
+  turno = lance.brancas ? PRETAS : BRANCAS;
+
+  AplicaLanceHistorico(estado_anterior, lance);
+  RegistraEventoSessao(EVENTO_REFAZ, OrigemLance(lance.lance), DestinoLance(lance.lance), PARTIDA_CONTINUA, estado_anterior, !lance.brancas,
+                       TempoRestanteMs(true), TempoRestanteMs(false), 0);
+  IniciaReconhecimento(estado_anterior);
+  IniciaLanceAutomatico();
+  AguardaPosicaoLanceAutomatico();
+  MarcaInicioVez();
+
+  MostraVez();
+  AvisaLance("Refeito");
+  SomConfirmar();
+}
+
+bool EnviaHistoricoAoHost(const char *comando, uint32_t hash) //true se o host chegou à posição com o mesmo hash
+{
+  char mensagem[TAMANHO_MAXIMO_MENSAGEM + 1];
+  char instante[TAMANHO_TEXTO_MICROS];
+
+  FormataMicros(RelogioTabuleiroUs(), instante, sizeof(instante));
+  snprintf(mensagem, sizeof(mensagem), "[\"%s\", %lu, %lu, %s]", comando, (unsigned long)hash, (unsigned long)ProximaSequenciaSessao(),
+           instante);
+  EnviaAoHost(mensagem);
+  AguardaMensagem('[', ']');
+
+  return mensagem_recebida[1] == LANCE_VALIDO;
+}
+
+void MostraVez() //Seta do jogador da vez, pretas à esquerda
+{
+  lcd.setCursor(9, 1);
+  if(turno == PRETAS)
+    lcd.write(SETA_ESQUERDA);
+  else
+    lcd.print(" ");
+
+  lcd.setCursor(10, 1);
+  if(turno == BRANCAS)
+    lcd.write(SETA_DIREITA);
+  else
+    lcd.print(" ");
+}
+
+void AvisaLance(const char *aviso)
+{
+  LimparLinhaLanceInvalido();
+  lcd.setCursor(1, 3);
+  lcd.write(NOTIFICACAO);
+  lcd.setCursor(3, 3);
+  lcd.print(aviso);
+
+  aviso_lance = true;
+  tempo_notificacao_lance_invalido = millis();
+}
+
+void AnalisaMensagemRecebida()
+{
+  TRECHO_ESCOPO("AnalisaMensagemRecebida");
+
   if(mensagem_recebida[1] == LANCE_INVALIDO)
     lance_invalido = true;
     
   else if(mensagem_recebida[1] == LANCE_VALIDO)
   {
+    RegistraEventoSessao(EVENTO_LANCE, indice_origem, indice_destino, mensagem_recebida[4], estado_atual, turno != BRANCAS,
+                         turno == BRANCAS ? tempo_lance_ms : TempoRestanteMs(true, false),
+                         turno == PRETAS ? tempo_lance_ms : TempoRestanteMs(false, false), PensamentoMs());
+
     if(mensagem_recebida[4] == PARTIDA_CONTINUA)
     {
+      EmpilhaLanceAceito();
+
       if(turno == BRANCAS)
       {
         turno = PRETAS;
@@ -759,6 +1357,10 @@ void AnalisaMensagemRecebida()
       }
 
       estado_anterior = estado_atual;
+      IniciaReconhecimento(estado_anterior);
+      IniciaLanceAutomatico();
+      MarcaInicioVez();
+      inicio_vez_us = instante_lance_us; //A vez do adversário começou no aperto do relógio, não na resposta do host
     }
     else if(mensagem_recebida[4] == EMPATE || mensagem_recebida[4] == VITORIA_BRANCAS || mensagem_recebida[4] == VITORIA_PRETAS)
     {
@@ -767,6 +1369,8 @@ void AnalisaMensagemRecebida()
       resultado_jogo = mensagem_recebida[4];
     }
   }
+  else
+    ContaQuadroMalformado(TransporteAtual());
 }
 
 void PrintaMenuPause()
@@ -783,77 +1387,186 @@ void PrintaMenuPause()
 
 void PrintaMenuConfigurarTempo()
 {
-  PrintaTempo(2, 0, tempo_configurado);
+  tempo_configurado_mostrado[0] = '\0'; //Depois de um lcd.clear(): tudo de novo
+  AtualizaTempo(2, 0, tempo_configurado, tempo_configurado_mostrado);
 
   lcd.setCursor(2, 1);
   lcd.print("Voltar");
 }
 
-void PrintaTempo(unsigned int linha, unsigned int coluna, unsigned int tempo)
+void FormataTempo(unsigned int tempo, char destino[TAMANHO_TEXTO_TEMPO])
 {
   unsigned int horas_tempo = tempo/(60*60);
   unsigned int minutos_tempo = (tempo%(60*60))/60;
   unsigned int segundos_tempo = (tempo%(60*60))%60;
 
-  lcd.setCursor(linha, coluna);
-  lcd.print(horas_tempo);
-  lcd.print(":");
-
-  if(minutos_tempo < 10)
-    lcd.print("0");
-  lcd.print(minutos_tempo);
-  lcd.print(":");
+  if(horas_tempo > 9) //Fora do relógio de um dígito, que o cronômetro redesenha a cada iteração sem o snprintf
+  {
+    snprintf(destino, TAMANHO_TEXTO_TEMPO, "%u:%02u:%02u", horas_tempo, minutos_tempo, segundos_tempo);
+    return;
+  }
 
-  if(segundos_tempo < 10)
-    lcd.print("0");
-  lcd.print(segundos_tempo);
+  destino[0] = '0' + horas_tempo;
+  destino[1] = ':';
+  destino[2] = '0' + minutos_tempo/10;
+  destino[3] = '0' + minutos_tempo%10;
+  destino[4] = ':';
+  destino[5] = '0' + segundos_tempo/10;
+  destino[6] = '0' + segundos_tempo%10;
+  destino[7] = '\0';
+}
+
+void PrintaTempo(unsigned int linha, unsigned int coluna, unsigned int tempo)
+{
+  char texto[TAMANHO_TEXTO_TEMPO];
+  FormataTempo(tempo, texto);
+
+  lcd.setCursor(linha, coluna);
+  lcd.print(texto);
+}
+
+void AtualizaTempo(unsigned int coluna, unsigned int linha, unsigned int tempo, char mostrado[TAMANHO_TEXTO_TEMPO]) //Só os caracteres que mudaram
+{
+  char texto[TAMANHO_TEXTO_TEMPO];
+  size_t tamanho_mostrado = strlen(mostrado);
+  bool cursor_no_lugar = false;
+
+  FormataTempo(tempo, texto);
+
+  for(size_t i = 0; texto[i] != '\0'; i++)
+  {
+    if(i < tamanho_mostrado && mostrado[i] == texto[i])
+    {
+      cursor_no_lugar = false;
+      continue;
+    }
+
+    if(!cursor_no_lugar) //Caracteres seguidos saem com um só posicionamento
+      lcd.setCursor(coluna + i, linha);
+    lcd.write(texto[i]);
+    cursor_no_lugar = true;
+  }
+
+  strcpy(mostrado, texto);
 }
 
 void ConfigurarTempo()
 {
+  bool esquerda = ESTADO_BOTAO_ESQUERDA == ACIONADO;
+  bool direita = ESTADO_BOTAO_DIREITA == ACIONADO;
+
   if(ESTADO_BOTAO_CENTRO == ACIONADO)
   {
     opcao_selecionada = MENU_CONFIGURAR_TEMPO;
     primeiro_loop = true;
     posicao_seta = 0;
-    tempo_restante_brancas = tempo_configurado;
-    tempo_restante_pretas = tempo_configurado;
+    passo_tempo_pendente = false; //Vale o tempo mostrado
+    DefineRelogios(tempo_configurado * 1000UL, tempo_configurado * 1000UL);
     lcd.clear();
     SomConfirmar();
 
     if(tempo_configurado_anterior != tempo_configurado)
     {
-      preferences.begin("dados", false); //Modo escrita/leitura
       preferences.putInt("tempo", tempo_configurado); //Salva o tempo configurado na memória
-      preferences.end();
 
       tempo_configurado_anterior = tempo_configurado;
     }
-  }
-  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO)
     return;
-  else if (ESTADO_BOTAO_ESQUERDA == ACIONADO)
+  }
+  else if((esquerda && direita) || (acorde_acionado && (esquerda || direita))) //Até soltar os dois, o botão que sobrou não ajusta o tempo
   {
-    if(tempo_configurado > 0)
+    if(!acorde_acionado) //Esquerda + direita: próximo tempo predefinido, uma vez por aperto do acorde
     {
-      tempo_configurado -= 60;
+      tempo_configurado = ProximoTempoPredefinido(tempo_configurado);
       SomConfigurarTempo();
     }
+
+    acorde_acionado = true;
+    passo_tempo_pendente = false; //O primeiro botão do acorde não ajusta o tempo
   }
-  else if(ESTADO_BOTAO_DIREITA == ACIONADO)
+  else if(esquerda || direita)
+    AjustaTempoSegurado(direita ? BOTAO_DIREITA : BOTAO_ESQUERDA);
+  else
   {
-    if(tempo_configurado < 9*60*60 + 59*60)
+    if(passo_tempo_pendente) //Soltou antes da janela: o aperto curto vale um passo
     {
-      tempo_configurado += 60;
-      SomConfigurarTempo();
+      passo_tempo_pendente = false;
+      AplicaPassoTempo(botao_ajuste_tempo, 1);
     }
+
+    acorde_acionado = false;
+  }
+
+  AtualizaTempo(2, 0, tempo_configurado, tempo_configurado_mostrado);
+}
+
+void AjustaTempoSegurado(uint8_t botao) //Um passo por aperto, passada a janela do acorde; segurando, um por repetição, arredondado ao passo
+{
+  uint32_t aperto = InstanteAperto(botao);
+  unsigned long agora = millis();
+
+  if(aperto != aperto_ajuste_tempo || botao != botao_ajuste_tempo) //Aperto novo: o passo fica para depois da janela do acorde
+  {
+    aperto_ajuste_tempo = aperto;
+    botao_ajuste_tempo = botao;
+    proxima_repeticao_tempo = agora + ATRASO_REPETICAO_TEMPO_MS;
+    passo_tempo_pendente = true;
+  }
+  else if(passo_tempo_pendente && agora - aperto >= JANELA_ACORDE_TEMPO_MS)
+  {
+    passo_tempo_pendente = false;
+    AplicaPassoTempo(botao, 1);
+  }
+  else if(!passo_tempo_pendente && (long)(agora - proxima_repeticao_tempo) >= 0)
+  {
+    proxima_repeticao_tempo = agora + PERIODO_REPETICAO_TEMPO_MS;
+    AplicaPassoTempo(botao, PassoRepeticaoTempo(agora - aperto));
+  }
+}
+
+void AplicaPassoTempo(uint8_t botao, unsigned int passo)
+{
+  unsigned int tempo = tempo_configurado;
+
+  if(botao == BOTAO_DIREITA)
+    tempo = (tempo/passo + 1)*passo < TEMPO_MAXIMO_CONFIGURAVEL ? (tempo/passo + 1)*passo : TEMPO_MAXIMO_CONFIGURAVEL;
+  else if(tempo > 0)
+    tempo = (tempo - 1)/passo*passo;
+
+  if(tempo != tempo_configurado)
+  {
+    tempo_configurado = tempo;
+    SomConfigurarTempo();
   }
+}
 
-  PrintaTempo(2, 0, tempo_configurado);
+unsigned int PassoRepeticaoTempo(unsigned long segurado_ms) //1 s, 10 s, 1 min e 10 min
+{
+  if(segurado_ms < 2000)
+    return 1;
+  if(segurado_ms < 3500)
+    return 10;
+  if(segurado_ms < 5000)
+    return 60;
+  return 10*60;
+}
+
+unsigned int ProximoTempoPredefinido(unsigned int tempo) //O primeiro maior que o atual; depois do último, volta ao primeiro
+{
+  for(unsigned int i = 0; i < tempos_predefinidos.size(); i++)
+    if(tempos_predefinidos.at(i) > tempo)
+      return tempos_predefinidos.at(i);
+
+  return tempos_predefinidos.at(0);
 }
 
 void SomNavegacao()
 {
+  if(DelegaSom(SomNavegacao))
+    return;
+
+  TRECHO_ESCOPO("SomNavegacao");
+
   tone(PINO_BUZZER, NOTE_B4, 40);
   delay(50);
   noTone(PINO_BUZZER); 
@@ -864,6 +1577,11 @@ void SomNavegacao()
 
 void SomConfirmar()
 {
+  if(DelegaSom(SomConfirmar))
+    return;
+
+  TRECHO_ESCOPO("SomConfirmar");
+
   tone(PINO_BUZZER, NOTE_E7, 50);
   delay(60);
   noTone(PINO_BUZZER);
@@ -874,6 +1592,11 @@ void SomConfirmar()
 
 void SomConfigurarTempo()
 {
+  if(DelegaSom(SomConfigurarTempo))
+    return;
+
+  TRECHO_ESCOPO("SomConfigurarTempo");
+
   tone(PINO_BUZZER, NOTE_B4, 30);
   delay(40);
   noTone(PINO_BUZZER);
@@ -885,6 +1608,11 @@ void SomConfigurarTempo()
 
 void SomPause()
 {
+  if(DelegaSom(SomPause))
+    return;
+
+  TRECHO_ESCOPO("SomPause");
+
   tone(PINO_BUZZER, NOTE_DS6, 30);
   delay(50);
   tone(PINO_BUZZER, NOTE_AS5, 60);
@@ -894,12 +1622,22 @@ void SomPause()
 
 void SomFimPartida()
 {
+  if(DelegaSom(SomFimPartida))
+    return;
+
+  TRECHO_ESCOPO("SomFimPartida");
+
   for(int frequencia = 1000; frequencia > 300; frequencia -= 30)
     tone(PINO_BUZZER, frequencia, 20);
 }
 
 void SomIniciarPartida()
 {
+  if(DelegaSom(SomIniciarPartida))
+    return;
+
+  TRECHO_ESCOPO("SomIniciarPartida");
+
   tone(PINO_BUZZER, NOTE_G6, 40);
   delay(50);
   tone(PINO_BUZZER, NOTE_E7, 30);
@@ -907,11 +1645,11 @@ void SomIniciarPartida()
   tone(PINO_BUZZER, NOTE_AS7, 150);
 }
 
-void PrintaTextoComSom(unsigned int coluna, unsigned int linha, string texto)
+void PrintaTextoComSom(unsigned int coluna, unsigned int linha, const char *texto)
 {
   lcd.setCursor(coluna, linha);
 
-  for (unsigned int i = 0; i < texto.length(); ++i)
+  for (unsigned int i = 0; texto[i] != '\0'; ++i)
   {
     lcd.print(texto[i]);
     delay(10);
@@ -920,29 +1658,13 @@ void PrintaTextoComSom(unsigned int coluna, unsigned int linha, string texto)
   }
 }
 
-void CalculaIndicesOrigemDestino()
+void SomLanceInvalido()
 {
-  for(int i=0; i<estado_atual.size(); i++)
-    {
-      if(estado_atual.at(i) != estado_anterior.at(i))
-      {
-        if(estado_atual.at(i) == "V")
-          indice_origem = i;
-        else
-          indice_destino = i;
-      }
-    }
-}
+  if(DelegaSom(SomLanceInvalido))
+    return;
 
-void CalculaNumeroAlteracoes()
-{
-  for(int i=0; i<estado_atual.size(); i++)
-    if(estado_atual.at(i) != estado_anterior.at(i))
-      quantidade_alteracoes_estado++;
-}
+  TRECHO_ESCOPO("SomLanceInvalido");
 
-void SomLanceInvalido()
-{
   tone(PINO_BUZZER, 1200, 75);
   delay(150);
   tone(PINO_BUZZER, 1600, 75);
@@ -957,43 +1679,64 @@ void LimparLinhaLanceInvalido()
 
 void AguardaMensagem(char primeiro_caractere, char ultimo_caractere)
 {
+  aguardando_host = true;
+  PublicaEstadoTelemetria(); //O host vê o lance pendente enquanto o relógio continua correndo
+
   while(true)
   {
-    mensagem_recebida = SerialBT.readStringUntil(ultimo_caractere);
+    memset(mensagem_recebida, 0, sizeof(mensagem_recebida)); //Posições além do fim da mensagem leem '\0'
+    size_t tamanho = RecebeResposta(ultimo_caractere, mensagem_recebida, TAMANHO_MAXIMO_MENSAGEM);
 
-    if(mensagem_recebida.length() != 0)
+    if(tamanho == 0)
     {
-      Serial.print("Mensagem recebida (depuracao)");
-      Serial.println(mensagem_recebida);
+      ContaRetentativa(TransporteAtual()); //O tempo limite da resposta esgotou, espera de novo
+
+      if(GeracaoConexao() != geracao_conexao_envio) //O host reconectou depois do envio: a mensagem pode ter se perdido
+      {
+        REGISTRA_INFO("Mensagem reenviada depois da reconexao");
+        EnviaAoHost(mensagem_pendente);
+      }
+      continue;
     }
 
+    REGISTRA_TEXTO_DEPURACAO("Mensagem recebida: %s", mensagem_recebida);
+
     if(mensagem_recebida[0] == primeiro_caractere)
     {
-      mensagem_recebida += ultimo_caractere;
+      mensagem_recebida[tamanho] = ultimo_caractere;
+      aguardando_host = false;
       return;
     }
 
-  } 
+    ContaQuadroMalformado(TransporteAtual()); //Resposta sem o primeiro caractere do quadro, é descartada
+  }
 }
 
-void PrintaEstadosAlteracoesIndices()
+void PrintaEstadosLance(const LanceReconhecido &lance)
 {
-  Serial.print("Estado anterior: ");
-  PrintaEstado(estado_anterior);
+  if(!REGISTRO_HABILITADO(REGISTRO_DEPURACAO))
+    return;
+
+  char estado[TAMANHO_TEXTO_REGISTRO]; //Oito casas de até duas letras separadas por espaço: 23 caracteres
+
+  FormataEstado(estado_anterior, estado);
+  REGISTRA_TEXTO_DEPURACAO("Estado anterior: %s", estado);
 
-  Serial.print("Estado atual: ");
-  PrintaEstado(estado_atual);
+  FormataEstado(estado_atual, estado);
+  REGISTRA_TEXTO_DEPURACAO("Estado atual: %s", estado);
 
-  Serial.print("Quantidade alteracoes: ");
-  Serial.println(quantidade_alteracoes_estado);
-  Serial.print("Indice origem: ");
-  Serial.println(indice_origem);
-  Serial.print("Indice_destino: ");
-  Serial.println(indice_destino);
+  REGISTRA_TEXTO_DEPURACAO("Lance: %s", NomeResultadoLance(lance.resultado));
+  REGISTRA_DEPURACAO("Eventos: %d em %d ms, so retrato: %d", lance.eventos, lance.duracao_ms, lance.pelo_retrato);
+  REGISTRA_DEPURACAO("Indice origem: %d, indice destino: %d", indice_origem, indice_destino);
 }
 
 void SomVitoria()
 {
+  if(DelegaSom(SomVitoria))
+    return;
+
+  TRECHO_ESCOPO("SomVitoria");
+
   tone(PINO_BUZZER, 880, 150);
   delay(85);
   tone(PINO_BUZZER, 988, 150);
@@ -1007,6 +1750,11 @@ void SomVitoria()
 
 void SomEmpate()
 {
+  if(DelegaSom(SomEmpate))
+    return;
+
+  TRECHO_ESCOPO("SomEmpate");
+
   tone(PINO_BUZZER, 1318, 150);
   delay(85);
   tone(PINO_BUZZER, 1047, 150);
@@ -1034,25 +1782,556 @@ void ResetaVariaveis()
 {
   turno = BRANCAS;
   primeiro_loop = false;
-  tempo_restante_brancas = tempo_configurado;
-  tempo_restante_pretas = tempo_configurado;
-  estado_anterior = {"RB", "CB", "TB", "V", "V", "TP", "CP", "RP"};
+  DefineRelogios(tempo_configurado * 1000UL, tempo_configurado * 1000UL);
+  estado_anterior = posicao_inicial_partida;
+  IniciaReconhecimento(estado_anterior);
+  IniciaLanceAutomatico();
+  tabuleiro_conferido = false;
   indice_destino = -1;
   indice_origem = -1;
   resultado_jogo = '\0';
+  inicio_pausa_us = 0;
+}
+
+bool ConfereTabuleiro() //Varredura rápida de todas as casas; true se estão assentadas na posição esperada
+{
+  TRECHO_ESCOPO("ConfereTabuleiro");
+
+  for(int i=0; i<LEITURAS_JANELA_CASA; i++) //Histórico inteiro renovado: leituras de antes da tela não contam
+  {
+    if(i > 0)
+      delay(INTERVALO_ACOMODACAO_MS);
+    CapturaEstadoAtual();
+  }
+
+  return CasasAssentadas() && estado_atual == posicao_inicial_partida;
 }
 
-void VerificaClienteConectado()
+bool IniciaPartidaConferida()
 {
-  existe_cliente = SerialBT.hasClient();
+  if(posicao_inicial_partida != ESTADO_INICIAL && !EnviaPosicaoInicial()) //A posição inicial o host já conhece
+  {
+    posicao_inicial_partida = ESTADO_INICIAL;
+    PrintaConferenciaTabuleiro();
+    PrintaAvisoConferencia("Host recusou");
+    SomLanceInvalido();
+    return false;
+  }
+
+  estado_anterior = posicao_inicial_partida;
+  IniciaReconhecimento(estado_anterior); //Os eventos da montagem do tabuleiro não entram no primeiro lance
+  IniciaLanceAutomatico();
+  IniciaHistorico();
+  IniciaSessao(posicao_inicial_partida, tempo_configurado);
+  tabuleiro_conferido = true;
+  lance_invalido = false;
+  aviso_lance = false;
+  tempo_inicio_turno = millis();
+  MarcaInicioVez();
+
+  opcao_selecionada = INICIAR_JOGADOR_VS_JOGADOR;
+  primeiro_loop = true;
+  lcd.clear();
+  return true;
+}
+
+bool EnviaPosicaoInicial() //true se o host aceitou a posição
+{
+  char fen[TAMANHO_FEN];
+  char mensagem[TAMANHO_MAXIMO_MENSAGEM + 1];
+
+  FormataFen(posicao_inicial_partida, true, fen);
+  snprintf(mensagem, sizeof(mensagem), "[\"fen\", \"%s\"]", fen);
+  REGISTRA_TEXTO_INFO("Posicao inicial adotada: %s", fen);
+
+  EnviaAoHost(mensagem);
+  AguardaMensagem('[', ']');
 
-  if(existe_cliente != existe_cliente_anterior)
+  return mensagem_recebida[1] == LANCE_VALIDO;
+}
+
+void AtualizaConferenciaTabuleiro()
+{
+  if(lance_invalido && millis() - tempo_notificacao_lance_invalido >= TEMPO_AVISO_CONFERENCIA_MS)
+  {
+    PrintaAvisoConferencia(nullptr);
+    lance_invalido = false;
+  }
+
+  if(ESTADO_BOTAO_CENTRO == ACIONADO)
   {
-    if(existe_cliente)
-      digitalWrite(PINO_LED_BLUETOOTH, HIGH);
+    opcao_selecionada = JOGADOR_VS_JOGADOR;
+    primeiro_loop = true;
+    posicao_seta = 0;
+    lance_invalido = false;
+    lcd.clear();
+    SomConfirmar();
+  }
+  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO)
+    return;
+  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO) //Adota o que está no tabuleiro, com as brancas jogando
+  {
+    if(CasasAssentadas() && PosicaoLegal(estado_atual, true))
+    {
+      posicao_inicial_partida = estado_atual; //Na próxima varredura confere e a partida começa
+      PrintaConferenciaTabuleiro();
+    }
     else
-      digitalWrite(PINO_LED_BLUETOOTH, LOW);
+    {
+      PrintaAvisoConferencia("Posicao ilegal");
+      SomLanceInvalido();
+    }
+  }
+}
+
+void PrintaConferenciaTabuleiro()
+{
+  char casas_esperadas[QUANTIDADE_CASAS + 1] = {};
+
+  for(int i=0; i<QUANTIDADE_CASAS; i++)
+    casas_esperadas[i] = LetraPeca(posicao_inicial_partida.at(i));
+
+  lcd.setCursor(0, 0);
+  lcd.print("Esperada:");
+  lcd.setCursor(COLUNA_CASAS_CONFERENCIA, 0);
+  lcd.print(casas_esperadas);
+
+  lcd.setCursor(0, 1);
+  lcd.print("Lida:");
+
+  PrintaAvisoConferencia(nullptr);
+}
 
-    existe_cliente_anterior = existe_cliente;
+void PrintaLeituraConferencia() //Casa ainda acomodando aparece como '?' e toda casa errada é marcada com '^'
+{
+  char casas_lidas[QUANTIDADE_CASAS + 1] = {};
+  char marcas[QUANTIDADE_CASAS + 1] = {};
+
+  for(int i=0; i<QUANTIDADE_CASAS; i++)
+  {
+    bool assentada = CasaAssentada(i);
+
+    casas_lidas[i] = assentada ? LetraPeca(estado_atual.at(i)) : '?';
+    marcas[i] = assentada && estado_atual.at(i) == posicao_inicial_partida.at(i) ? ' ' : '^';
+  }
+
+  lcd.setCursor(COLUNA_CASAS_CONFERENCIA, 1);
+  lcd.print(casas_lidas);
+  lcd.setCursor(COLUNA_CASAS_CONFERENCIA, 2);
+  lcd.print(marcas);
+}
+
+void PrintaAvisoConferencia(const char *aviso) //nullptr volta à ajuda dos botões
+{
+  LimparLinhaLanceInvalido();
+  lcd.setCursor(0, 3);
+
+  if(aviso)
+  {
+    lcd.write(NOTIFICACAO);
+    lcd.print(" ");
+    lcd.print(aviso);
+
+    lance_invalido = true;
+    tempo_notificacao_lance_invalido = millis();
   }
+  else
+    lcd.print("Esq:adota Centro:sai");
+}
+
+void VerificaClienteConectado() //Sem cliente WiFi em jogo e sem evento novo, não consulta os rádios
+{
+#if TIX_WIFI
+  if(wifi_ativo && (estacao_wifi_associada || cliente_wifi_aceito) &&
+     millis() - tempo_consulta_cliente_wifi >= PERIODO_CONSULTA_CLIENTE_WIFI_MS)
+  {
+    tempo_consulta_cliente_wifi = millis();
+    ConsultaClienteWifi();
+  }
+#endif
+
+  if(!AtendeConexao(millis()))
+    return;
+
+  if(TransporteConectado() != SEM_TRANSPORTE)
+    digitalWrite(PINO_LED, HIGH);
+  else
+    digitalWrite(PINO_LED, LOW);
+}
+
+#if TIX_BLUETOOTH
+void EventoBluetooth(esp_spp_cb_event_t evento, esp_spp_cb_param_t *parametro) //Na tarefa da pilha Bluetooth
+{
+  if(evento == ESP_SPP_SRV_OPEN_EVT)
+    SinalizaConexao(TRANSPORTE_BLUETOOTH, true);
+  else if(evento == ESP_SPP_CLOSE_EVT)
+    SinalizaConexao(TRANSPORTE_BLUETOOTH, false);
+}
+
+void AtivaBluetooth()
+{
+  if(bluetooth_ativo)
+    return;
+
+  SerialBT.begin(ID_BLUETOOTH_WIFI); //Inicia a comunicação Bluetooth
+  bluetooth_ativo = true;
+  REGISTRA_INFO("Bluetooth ativado");
+}
+
+void DesativaBluetooth()
+{
+  if(!bluetooth_ativo)
+    return;
+
+  SerialBT.end();
+  SinalizaConexao(TRANSPORTE_BLUETOOTH, false); //O SPP pode não gerar o evento de fechamento ao ser encerrado
+  bluetooth_ativo = false;
+  REGISTRA_INFO("Bluetooth desativado");
+}
+#endif
+
+#if TIX_WIFI
+void EventoWifi(WiFiEvent_t evento, WiFiEventInfo_t informacao) //Na tarefa de eventos do WiFi
+{
+  if(evento == ARDUINO_EVENT_WIFI_AP_STACONNECTED)
+    estacao_wifi_associada = true;
+  else if(evento == ARDUINO_EVENT_WIFI_AP_STADISCONNECTED)
+    estacao_wifi_associada = false; //O socket é conferido na próxima consulta
+}
+
+void ConsultaClienteWifi() //Aceita o socket de uma estação associada ao ponto de acesso, ou confere se ele fechou
+{
+  if(!cliente_wifi_aceito)
+  {
+    client = server.available();
+    if(client)
+    {
+      cliente_wifi_aceito = true;
+      SinalizaConexao(TRANSPORTE_WIFI, true);
+    }
+  }
+  else if(!client.connected())
+  {
+    client.stop();
+    cliente_wifi_aceito = false;
+    SinalizaConexao(TRANSPORTE_WIFI, false);
+    REGISTRA_INFO("Cliente WiFi desconectou");
+  }
+}
+
+void AtivaWifi()
+{
+  if(wifi_ativo)
+    return;
+
+  WiFi.softAP(ID_BLUETOOTH_WIFI, SENHA_WIFI); //Configura o ESP32 como ponto de acesso
+  server.begin();
+  LigaPainel(true); //A página ao vivo, no mesmo ponto de acesso
+  wifi_ativo = true;
+  REGISTRA_INFO("WiFi ativado");
+}
+
+void DesativaWifi()
+{
+  if(!wifi_ativo)
+    return;
+
+  if(cliente_wifi_aceito)
+  {
+    client.stop();
+    cliente_wifi_aceito = false;
+    SinalizaConexao(TRANSPORTE_WIFI, false);
+  }
+  estacao_wifi_associada = false;
+  server.end();
+  LigaPainel(false);
+  WiFi.softAPdisconnect(true);
+  wifi_ativo = false;
+  REGISTRA_INFO("WiFi desativado");
+}
+#endif
+
+#if TIX_BLUETOOTH && TIX_WIFI
+void LigaRadio(uint8_t transporte, bool ligado) //Chamada pelo gerenciador de conexão, com histerese e espera e com o rádio travado
+{
+  if(transporte == TRANSPORTE_WIFI && ligado)
+    AtivaWifi();
+  else if(transporte == TRANSPORTE_WIFI)
+    DesativaWifi();
+  else if(ligado)
+    AtivaBluetooth();
+  else
+    DesativaBluetooth();
+}
+#endif
+
+uint8_t TransporteAtual()
+{
+  return TransporteConectado() == TRANSPORTE_WIFI ? TRANSPORTE_WIFI : TRANSPORTE_PADRAO;
+}
+
+void AtualizaDiagnostico()
+{
+  if(ESTADO_BOTAO_CENTRO == ACIONADO && pagina_diagnostico == PAGINA_DIAGNOSTICO_CALIBRACAO)
+  {
+    opcao_selecionada = MENU_CALIBRACAO;
+    primeiro_loop = true;
+    SomConfirmar();
+    return;
+  }
+  else if(ESTADO_BOTAO_CENTRO == ACIONADO)
+  {
+    opcao_selecionada = MENU_INICIAL;
+    primeiro_loop = true;
+    posicao_seta = 0;
+    lcd.clear();
+    SomConfirmar();
+    return;
+  }
+  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO && ESTADO_BOTAO_DIREITA == ACIONADO)
+    return;
+  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO || ESTADO_BOTAO_DIREITA == ACIONADO)
+  {
+    if(ESTADO_BOTAO_DIREITA == ACIONADO)
+      pagina_diagnostico = (pagina_diagnostico + 1) % QUANTIDADE_PAGINAS_DIAGNOSTICO;
+    else
+      pagina_diagnostico = (pagina_diagnostico + QUANTIDADE_PAGINAS_DIAGNOSTICO - 1) % QUANTIDADE_PAGINAS_DIAGNOSTICO;
+
+    PrintaPaginaDiagnostico();
+    SomNavegacao();
+  }
+  else if(millis() - tempo_atualizacao_diagnostico >= (pagina_diagnostico == PAGINA_DIAGNOSTICO_CASAS || pagina_diagnostico == PAGINA_DIAGNOSTICO_CALIBRACAO ? PERIODO_ATUALIZACAO_CASAS_MS : PERIODO_ATUALIZACAO_DIAGNOSTICO_MS))
+    PrintaPaginaDiagnostico();
+}
+
+void PrintaPaginaDiagnostico() //Linhas completas de 20 caracteres para sobrescrever a página anterior sem limpar o LCD
+{
+  if(pagina_diagnostico == PAGINA_DIAGNOSTICO_MEMORIA)
+    PrintaPaginaMemoria();
+  else if(pagina_diagnostico == PAGINA_DIAGNOSTICO_CICLO)
+    PrintaPaginaCiclo();
+  else if(pagina_diagnostico == PAGINA_DIAGNOSTICO_CASAS)
+    PrintaPaginaCasas();
+  else if(pagina_diagnostico == PAGINA_DIAGNOSTICO_CALIBRACAO)
+    PrintaPaginaCalibracao();
+  else
+    PrintaPaginaLatencia();
+
+  tempo_atualizacao_diagnostico = millis();
+}
+
+void PrintaLinhaDiagnostico(unsigned int linha, const char *texto) //Um número grande demais é cortado na coluna 20, em vez de invadir outra linha do LCD
+{
+  lcd.setCursor(0, linha);
+  for(unsigned int i = 0; i < COLUNAS_LCD && texto[i] != '\0'; i++)
+    lcd.write(texto[i]);
+}
+
+void PrintaPaginaLatencia()
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  ResumoLatencia resumo = ResumeLatencia(pagina_diagnostico);
+
+  snprintf(linha, sizeof(linha), "%-17s%u/%u", pagina_diagnostico == PAGINA_DIAGNOSTICO_WIFI ? "WiFi (ms)" : "Bluetooth (ms)",
+           pagina_diagnostico + 1, QUANTIDADE_PAGINAS_DIAGNOSTICO);
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Lances %-4lu p50 %4lu", (unsigned long)resumo.quantidade, (unsigned long)(resumo.mediana_us / 1000));
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "p99 %5lu max %5lu", (unsigned long)(resumo.p99_us / 1000), (unsigned long)(resumo.maximo_us / 1000));
+  PrintaLinhaDiagnostico(2, linha);
+
+  snprintf(linha, sizeof(linha), "Esp %-3lu Err %-2lu Rc %-2lu", (unsigned long)resumo.retentativas, (unsigned long)resumo.quadros_malformados,
+           (unsigned long)resumo.reconexoes);
+  PrintaLinhaDiagnostico(3, linha);
+}
+
+void PrintaPaginaMemoria()
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  char pilha[5] = "   -"; //Sem tarefas monitoradas (simulador)
+  ResumoMemoria resumo = ResumeMemoria();
+
+  snprintf(linha, sizeof(linha), "%-17s%u/%u", "Memoria (KB)", pagina_diagnostico + 1, QUANTIDADE_PAGINAS_DIAGNOSTICO);
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Livre %4lu  min %4lu", (unsigned long)(resumo.livre.atual / 1024), (unsigned long)(resumo.livre.minimo / 1024));
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "Bloco %4lu  min %4lu", (unsigned long)(resumo.maior_bloco.atual / 1024),
+           (unsigned long)(resumo.maior_bloco.minimo / 1024));
+  PrintaLinhaDiagnostico(2, linha);
+
+  if(resumo.pilha_minima)
+    snprintf(pilha, sizeof(pilha), "%4lu", (unsigned long)(resumo.pilha_minima < 9999 ? resumo.pilha_minima : 9999));
+  snprintf(linha, sizeof(linha), "%cFrg %3lu%% Pilha %s", resumo.alarme_ativo ? '!' : ' ', (unsigned long)resumo.fragmentacao.atual, pilha); //Pilha em bytes
+  PrintaLinhaDiagnostico(3, linha);
+}
+
+void PrintaPaginaCiclo()
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  ResumoCiclo resumo = ResumeCiclo();
+
+  snprintf(linha, sizeof(linha), "%-17s%u/%u", "Loop (ms)", pagina_diagnostico + 1, QUANTIDADE_PAGINAS_DIAGNOSTICO);
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Min %4lu  Med %5lu ", (unsigned long)(resumo.minimo_us / 1000), (unsigned long)(resumo.media_us / 1000));
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "Max %5lu  >%d %5lu", (unsigned long)(resumo.maximo_us / 1000), LIMITE_ITERACAO_LENTA_MS, (unsigned long)resumo.lentas);
+  PrintaLinhaDiagnostico(2, linha);
+
+  snprintf(linha, sizeof(linha), "Varr %3lu/s I2C %5lu", (unsigned long)resumo.varreduras_por_segundo,
+           (unsigned long)resumo.bytes_lcd_por_segundo * ESCRITAS_I2C_POR_BYTE_LCD); //Escritas no PCF8574 por segundo
+  PrintaLinhaDiagnostico(3, linha);
+}
+
+void PrintaPaginaCasas() //Leitura crua do ADC e peça reconhecida em cada casa, duas casas por linha
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+
+  CapturaEstadoAtual();
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i += 2)
+  {
+    snprintf(linha, sizeof(linha), "%d %4u %-2s  %d %4u %-2s", i, leituras_casas.at(i), NomePeca(estado_lido.at(i)),
+             i + 1, leituras_casas.at(i + 1), NomePeca(estado_lido.at(i + 1)));
+    PrintaLinhaDiagnostico(i / 2, linha);
+  }
+}
+
+void PrintaPaginaCalibracao() //Perfil em uso e a casa com a leitura menos confiável no momento
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  int pior_casa = 0;
+
+  CapturaEstadoAtual();
+  for(int i = 1; i < QUANTIDADE_CASAS; i++)
+    if(ConfiancaCasa(i) < ConfiancaCasa(pior_casa))
+      pior_casa = i;
+
+  snprintf(linha, sizeof(linha), "%-17s%u/%u", "Calibracao", pagina_diagnostico + 1, QUANTIDADE_PAGINAS_DIAGNOSTICO);
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Perfil %-13s", CalibracaoSalva() ? "por casa" : "nominal");
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "Conf. min %3u%% (%d) ", ConfiancaCasa(pior_casa), pior_casa);
+  PrintaLinhaDiagnostico(2, linha);
+
+  snprintf(linha, sizeof(linha), "%-20s", "Centro: calibrar");
+  PrintaLinhaDiagnostico(3, linha);
+}
+
+void AtualizaCalibracao()
+{
+  if(passo_calibracao == PASSOS_CALIBRACAO) //Tela de resultado
+  {
+    if(ESTADO_BOTAO_ESQUERDA == ACIONADO || ESTADO_BOTAO_CENTRO == ACIONADO || ESTADO_BOTAO_DIREITA == ACIONADO)
+      SaiCalibracao();
+  }
+  else if(ESTADO_BOTAO_ESQUERDA == ACIONADO) //Cancela sem alterar o perfil em uso
+    SaiCalibracao();
+  else if(ESTADO_BOTAO_CENTRO == ACIONADO)
+  {
+    AmostraPassoCalibracao();
+    passo_calibracao++;
+    SomConfirmar();
+
+    if(passo_calibracao == PASSOS_CALIBRACAO)
+      PrintaResultadoCalibracao(ConcluiCalibracao());
+    else
+      PrintaPassoCalibracao();
+  }
+  else if(millis() - tempo_atualizacao_diagnostico >= PERIODO_ATUALIZACAO_CASAS_MS)
+    PrintaLeituraCalibracao();
+}
+
+void AmostraPassoCalibracao() //Bloqueia por AMOSTRAS_CALIBRACAO * INTERVALO_AMOSTRAS_CALIBRACAO_MS, bem abaixo de LIMITE_VIGIA_LOOP_MS
+{
+  TRECHO_ESCOPO("AmostraPassoCalibracao");
+
+  lcd.setCursor(0, 3);
+  lcd.print("Lendo...            ");
+
+  for(int amostra = 0; amostra < AMOSTRAS_CALIBRACAO; amostra++)
+  {
+    uint16_t leituras[QUANTIDADE_CASAS];
+    LeituraCasas(leituras);
+
+    for(unsigned int i = 0; i < casas.size(); i++)
+      AcumulaCalibracao(passo_calibracao, i, leituras[i]);
+
+    delay(INTERVALO_AMOSTRAS_CALIBRACAO_MS);
+  }
+}
+
+void PrintaPassoCalibracao() //Peças esperadas em notação FEN, casa 0 à esquerda
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  char pecas[QUANTIDADE_CASAS + 1];
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    pecas[i] = LetraPeca(PecaPassoCalibracao(passo_calibracao, i));
+  pecas[QUANTIDADE_CASAS] = '\0';
+
+  snprintf(linha, sizeof(linha), "%-17s%u/%u", "Calibracao", passo_calibracao + 1, PASSOS_CALIBRACAO);
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Coloque  %-11s", pecas);
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "%-20s", "Centro:ler Esq:sair");
+  PrintaLinhaDiagnostico(3, linha);
+
+  PrintaLeituraCalibracao();
+}
+
+void PrintaLeituraCalibracao() //O que o classificador em uso vê agora, para conferir as peças antes de ler
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+  char pecas[QUANTIDADE_CASAS + 1];
+
+  CapturaEstadoAtual();
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    pecas[i] = LetraPeca(estado_lido.at(i));
+  pecas[QUANTIDADE_CASAS] = '\0';
+
+  snprintf(linha, sizeof(linha), "Lido     %-11s", pecas);
+  PrintaLinhaDiagnostico(2, linha);
+
+  tempo_atualizacao_diagnostico = millis();
+}
+
+void PrintaResultadoCalibracao(const ResultadoCalibracao &resultado)
+{
+  char linha[TAMANHO_LINHA_DIAGNOSTICO];
+
+  snprintf(linha, sizeof(linha), "%-20s", resultado.valida ? "Calibracao salva" : "Calibracao falhou");
+  PrintaLinhaDiagnostico(0, linha);
+
+  snprintf(linha, sizeof(linha), "Casa %d: %-2s x %-2s    ", resultado.casa, NomePeca(resultado.peca_a), NomePeca(resultado.peca_b));
+  PrintaLinhaDiagnostico(1, linha);
+
+  snprintf(linha, sizeof(linha), "Sep %2u.%u dp (min %d) ", resultado.separacao_decimos / 10, resultado.separacao_decimos % 10,
+           SEPARACAO_MINIMA_CALIBRACAO);
+  PrintaLinhaDiagnostico(2, linha);
+
+  snprintf(linha, sizeof(linha), "%-20s", "Botao: voltar");
+  PrintaLinhaDiagnostico(3, linha);
+
+  if(!resultado.valida)
+    SomLanceInvalido();
+}
+
+void SaiCalibracao() //Volta para a página de calibração do diagnóstico
+{
+  opcao_selecionada = MENU_DIAGNOSTICO;
+  primeiro_loop = false;
+  pagina_diagnostico = PAGINA_DIAGNOSTICO_CALIBRACAO;
+  lcd.clear();
+  PrintaPaginaDiagnostico();
+  SomConfirmar();
 }
\ No newline at end of file
@@ -4,6 +4,8 @@ import tkinter as tk
 from tkinter import filedialog
 import threading
 import re
+import json
+import time
 import serial
 
 WINDOW_WIDTH = 1600
@@ -17,6 +19,7 @@ PIECE_START_ORDER = [
     'wK', 'wN', 'wR', None, None, 'bR', 'bN', 'bK'
 ]
 TIME_CONTROL = 600
+START_FEN = 'KNR2rnk w'
 
 pygame.font.init()
 FONT = pygame.font.Font('../assets/fonts/DelaGothicOne-Regular.ttf',30)
@@ -231,6 +234,8 @@ def save_moves(moves_list):
             print("Invalid result. Saving without result.")
             result_str = None
     with open(file_path, "w") as file:
+        if start_fen != START_FEN:
+            file.write(f"FEN {start_fen}\n")
         for turn_num, turn_moves in enumerate(moves_list):
             pgn_line = f"{turn_num + 1}. "
             if len(turn_moves) > 0:
@@ -238,53 +243,271 @@ def save_moves(moves_list):
             if len(turn_moves) > 1:
                 pgn_line += f" {turn_moves[1]}"
             file.write(pgn_line + "\n")
+            ms_line = timing_line(move_history[2 * turn_num:2 * turn_num + len(turn_moves)])
+            if ms_line:
+                file.write(ms_line + "\n")
         if result_str:
             file.write(result_str + "\n")
 
+def timing_line(entries):
+    # "MS <remaining ms> <think ms> [<remaining ms> <think ms>]" after a move line: readers that only know
+    # "N4 590" skip it, as any line that does not start with a digit. "-" marks a think time the host never got.
+    if not entries or any('time_ms' not in entry for entry in entries):
+        return None
+    fields = []
+    for entry in entries:
+        fields += [str(entry['time_ms']), '-' if entry['think_ms'] is None else str(entry['think_ms'])]
+    return "MS " + " ".join(fields)
+
 def reset_board():
+    global start_fen, move_history, redo_stack
+    start_fen = START_FEN
+    move_history = []
+    redo_stack = []
     return PIECE_START_ORDER.copy(), 0, [], None, {}
 
+def parse_fen(fen):
+    # "KNR2rnk w": squares 0 to 7 (uppercase white, lowercase black, digits for empty runs) and the side to move
+    parts = fen.split()
+    if len(parts) != 2 or parts[1] not in ('w', 'b'):
+        return None, None
+    order = []
+    for char in parts[0]:
+        if char.isdigit():
+            order.extend([None] * int(char))
+        elif char.upper() in PIECE_TYPES:
+            order.append(('w' if char.isupper() else 'b') + char.upper())
+        else:
+            return None, None
+    pieces = [p for p in order if p is not None]
+    if len(order) != 8 or len(pieces) != len(set(pieces)) or 'wK' not in pieces or 'bK' not in pieces:
+        return None, None
+    color = parts[1]
+    enemy_color = 'b' if color == 'w' else 'w'
+    if is_king_attacked(find_king(enemy_color, order), enemy_color, order) or not has_legal_moves(color, order):
+        return None, None
+    return order, color
+
+def position_fen(order, color):
+    fen = ''
+    empty = 0
+    for piece in order:
+        if piece is None:
+            empty += 1
+            continue
+        if empty:
+            fen += str(empty)
+        empty = 0
+        fen += piece[1] if piece[0] == 'w' else piece[1].lower()
+    if empty:
+        fen += str(empty)
+    return f"{fen} {color}"
+
+def fen_hash(fen):
+    # 32-bit FNV-1a, the same hash the board sends with undo and redo
+    value = 2166136261
+    for char in fen.encode():
+        value = ((value ^ char) * 16777619) & 0xFFFFFFFF
+    return value
+
 serial_port = None  
 SERIAL_PORT_NAME = 'COM3'  
+SERIAL_FALLBACK_PORTS = ['socket://192.168.4.1:5000']  # the board's WiFi access point, tried when the first port fails
 SERIAL_BAUDRATE = 9600
+RECONNECT_DELAY = 1
+
+# Session resume: the board numbers every game message and keeps the recent events, so after a reconnection over
+# any port the host asks once for what it missed ("?retoma <session> <last seq>") instead of restarting the game
+session_id = 0
+last_seq = 0
+last_request = None
+last_response = None
+replaying = False
+
+# Live telemetry: the board pushes ["t", fields, values...] frames with the clocks in ms, the side to move, the packed
+# board and the pending-move flag, only the fields that changed (clocks as ms differences) plus a keyframe every second
+TELEMETRY_HZ = 10
+TELEMETRY_FIELDS = ['white_ms', 'black_ms', 'white_turn', 'board', 'pending', 'running']
+TELEMETRY_KEYFRAME = 0x40
+TELEMETRY_PIECES = [None, 'wK', 'wN', 'wR', 'bK', 'bN', 'bR']  # the board's piece codes, 4 bits per square
+telemetry = None  # None until the first keyframe
+
+# Clock sync, NTP style: "?relogio <t1>" is answered with {"relogio": [t1, t2, t3]}, t2 and t3 in board microseconds.
+# Moves carry the board instants of the turn start and of the clock press, translated to the host clock with the
+# offset and drift fitted over the exchanges with the smallest round trip
+CLOCK_SYNC_BURST = 8  # exchanges right after connecting, CLOCK_SYNC_BURST_INTERVAL apart
+CLOCK_SYNC_BURST_INTERVAL = 0.1
+CLOCK_SYNC_INTERVAL = 2
+CLOCK_SYNC_SAMPLES = 64
+CLOCK_SYNC_DRIFT_SPAN = 60_000_000  # us of samples before the drift is fitted (offset alone until then): 1 ms of noise is 17 ppm
+CLOCK_SYNC_MAX_DRIFT = 500e-6
+
+def host_us():
+    return time.monotonic_ns() // 1000
+
+class ClockSync:
+    def __init__(self):
+        self.samples = []  # (host midpoint, offset, round trip), in microseconds
+        self.reference = 0
+        self.offset = 0
+        self.drift = 0.0
+
+    def add(self, t1, t2, t3, t4):
+        self.samples.append(((t1 + t4) / 2, ((t2 - t1) + (t3 - t4)) / 2, (t4 - t1) - (t3 - t2)))
+        del self.samples[:-CLOCK_SYNC_SAMPLES]
+        # The half with the smallest round trip: the least queueing on either leg, so the most symmetric
+        best = sorted(self.samples, key=lambda sample: sample[2])[:max(1, len(self.samples) // 2)]
+        self.reference = sum(sample[0] for sample in best) / len(best)
+        self.offset = sum(sample[1] for sample in best) / len(best)
+        spread = sum((sample[0] - self.reference) ** 2 for sample in best)
+        if max(sample[0] for sample in best) - min(sample[0] for sample in best) < CLOCK_SYNC_DRIFT_SPAN:
+            self.drift = 0.0
+        else:
+            slope = sum((sample[0] - self.reference) * (sample[1] - self.offset) for sample in best) / spread
+            self.drift = max(-CLOCK_SYNC_MAX_DRIFT, min(CLOCK_SYNC_MAX_DRIFT, slope))
+
+    def ready(self):
+        return bool(self.samples)
+
+    def to_host(self, board_us):
+        # board = host + offset + drift * (host - reference), solved for host
+        return (board_us - self.offset + self.drift * self.reference) / (1 + self.drift)
 
-def serial_listener(callback):
+clock_sync = ClockSync()
+
+def serial_listener(callback, command_callbacks, resume_callback):
     def listen():
-        global serial_port
-        try:
-            serial_port = serial.Serial(SERIAL_PORT_NAME, SERIAL_BAUDRATE, timeout=1)
-            print(f"Listening for serial data on {SERIAL_PORT_NAME} at {SERIAL_BAUDRATE} baud...")
-            while True:
-                if serial_port.in_waiting > 0:
-                    data = serial_port.readline().decode(errors='ignore').strip()
-                    if data:
-                        try:
-                            arr = eval(data) 
-                            if isinstance(arr, list):
-                                callback(*arr)
-                        except Exception as e:
-                            print(f"Error decoding serial message: {e}")
-        except Exception as e:
-            print(f"Serial connection error: {e}")
+        global serial_port, last_request, clock_sync
+        while True:
+            for port_name in [SERIAL_PORT_NAME] + SERIAL_FALLBACK_PORTS:
+                try:
+                    serial_port = serial.serial_for_url(port_name, SERIAL_BAUDRATE, timeout=1)
+                except Exception as e:
+                    print(f"Serial connection error on {port_name}: {e}")
+                    continue
+                print(f"Listening for serial data on {port_name} at {SERIAL_BAUDRATE} baud...")
+                try:
+                    serial_port.write(f"?retoma {session_id} {last_seq}\n".encode())
+                    serial_port.write(f"?telemetria {TELEMETRY_HZ}\n".encode())
+                    clock_sync = ClockSync()  # the board may have restarted
+                    sync_exchanges = 0
+                    next_sync = time.monotonic()
+                    while True:
+                        if time.monotonic() >= next_sync:
+                            serial_port.write(f"?relogio {host_us()}\n".encode())
+                            sync_exchanges += 1
+                            next_sync = time.monotonic() + (CLOCK_SYNC_BURST_INTERVAL if sync_exchanges < CLOCK_SYNC_BURST else CLOCK_SYNC_INTERVAL)
+                        if serial_port.in_waiting > 0:
+                            data = serial_port.readline()
+                            received_us = host_us()
+                            data = data.decode(errors='ignore').strip()
+                            if not data:
+                                continue
+                            if data.startswith('{"relogio"'):
+                                clock_sync.add(*json.loads(data)['relogio'], received_us)
+                                continue
+                            if data.startswith('["t"'):
+                                # Never answered and never a last_request: a resent move must still match
+                                try:
+                                    handle_telemetry(*json.loads(data)[1:])
+                                except Exception as e:
+                                    print(f"Error decoding telemetry frame: {e}")
+                                continue
+                            if data == last_request:
+                                # The board sent it again after reconnecting: same reply, the move was already handled
+                                serial_port.write(str(last_response).encode())
+                                continue
+                            try:
+                                if data.startswith('{'):
+                                    resume_callback(json.loads(data))
+                                    continue
+                                last_request = data
+                                arr = eval(data) 
+                                if isinstance(arr, list) and len(arr) >= 2 and arr[0] in command_callbacks:
+                                    command_callbacks[arr[0]](*arr[1:])
+                                elif isinstance(arr, list):
+                                    callback(*arr)
+                            except Exception as e:
+                                print(f"Error decoding serial message: {e}")
+                except Exception as e:
+                    print(f"Serial connection lost on {port_name}: {e}")
+                finally:
+                    serial_port.close()
+                    stop_telemetry()
+            time.sleep(RECONNECT_DELAY)
     thread = threading.Thread(target=listen, daemon=True)
     thread.start()
 
 def send_serial_response(response_arr):
-    global serial_port
+    global serial_port, last_response
+    last_response = response_arr
+    if replaying:
+        return
     try:
         if serial_port and serial_port.is_open:
             serial_port.write((str(response_arr)).encode())
     except Exception as e:
         print(f"Error sending serial response: {e}")
 
+def handle_telemetry(fields, *values):
+    global telemetry
+    keyframe = fields & TELEMETRY_KEYFRAME
+    if keyframe:
+        telemetry = {}
+    elif telemetry is None:
+        return
+    values = iter(values)
+    for bit, name in enumerate(TELEMETRY_FIELDS):
+        if fields & (1 << bit):
+            value = next(values)
+            telemetry[name] = value if keyframe or not name.endswith('_ms') else telemetry[name] + value
+    # The clocks run locally between frames, from the board's values
+    white_clock.time_left = telemetry['white_ms'] / 1000
+    black_clock.time_left = telemetry['black_ms'] / 1000
+    for clock, white in ((white_clock, 1), (black_clock, 0)):
+        if telemetry['running'] and telemetry['white_turn'] == white:
+            clock.start()
+        else:
+            clock.stop()
+
+def stop_telemetry():
+    global telemetry
+    telemetry = None
+    if white_clock and black_clock:
+        white_clock.stop()
+        black_clock.stop()
+
+def telemetry_board():
+    # The squares as the board reads them now, lifted pieces included; None without telemetry
+    state = telemetry
+    if state is None:
+        return None
+    return [TELEMETRY_PIECES[(state['board'] >> (4 * i)) & 0xF] for i in range(8)]
+
+def remember_sequence(seq):
+    global last_seq
+    if seq is not None:
+        last_seq = seq
+
 piece_order = None
+start_fen = START_FEN
 moves = None
+move_history = []
+redo_stack = []
 white_clock = None
 black_clock = None
 current_turn = 0
 
-def handle_serial_message(origin, destination, time_remaining, time_control):
+def think_time_ms(turn_start_us, board_us):
+    # Board instants of the turn start (pauses excluded) and of the clock press, on the host clock
+    if turn_start_us is None or board_us is None or not clock_sync.ready():
+        return None
+    return round((clock_sync.to_host(board_us) - clock_sync.to_host(turn_start_us)) / 1000)
+
+def handle_serial_message(origin, destination, time_remaining, time_control, seq=None, turn_start_us=None, board_us=None,
+                          time_remaining_ms=None, think_ms=None):
     global piece_order, moves, white_clock, black_clock, current_turn, TIME_CONTROL
+    remember_sequence(seq)
     TIME_CONTROL = time_control
     piece = piece_order[origin]
     if piece is None:
@@ -311,7 +534,14 @@ def handle_serial_message(origin, destination, time_remaining, time_control):
             print(f"Serial move: {origin}->{destination}, {piece}, time: {time_remaining}")
             print(moves)
             return
+    if time_remaining_ms is None:
+        # Boards before the millisecond fields: whole seconds, think time only from the synchronized instants
+        time_remaining_ms = time_remaining * 1000
+        think_ms = think_time_ms(turn_start_us, board_us)
     captured = piece_order[destination]
+    entry = {'origin': origin, 'destination': destination, 'piece': piece, 'captured': captured, 'turn': current_turn,
+             'white_before': white_clock.time_left, 'black_before': black_clock.time_left,
+             'time_ms': time_remaining_ms, 'think_ms': think_ms}
     piece_order[destination] = piece
     piece_order[origin] = None
     move_str = notation(piece, destination, 'b' if piece[0] == 'w' else 'w', captured is not None, piece_order)
@@ -321,11 +551,16 @@ def handle_serial_message(origin, destination, time_remaining, time_control):
     else:
         moves[-1].append(move_with_time)
     if piece[0] == 'w':
-        white_clock.time_left = time_remaining
+        white_clock.time_left = time_remaining_ms / 1000
         current_turn = 1
     else:
-        black_clock.time_left = time_remaining
+        black_clock.time_left = time_remaining_ms / 1000
         current_turn = 0
+    entry['notation'] = move_with_time
+    entry['white_after'] = white_clock.time_left
+    entry['black_after'] = black_clock.time_left
+    move_history.append(entry)
+    redo_stack.clear()
     winner = 0
     if is_checkmate('b', piece_order):
         winner = 1
@@ -334,30 +569,179 @@ def handle_serial_message(origin, destination, time_remaining, time_control):
     elif is_stalemate('w', piece_order) or is_stalemate('b', piece_order) or is_insufficient_material(piece_order):
         winner = 3
     send_serial_response([1, winner])
-    print(f"Serial move: {origin}->{destination}, {piece}, time: {time_remaining}")
+    print(f"Serial move: {origin}->{destination}, {piece}, time: {time_remaining}, think: {entry['think_ms']} ms")
+    print(moves)
+
+def load_position(fen):
+    global piece_order, moves, white_clock, black_clock, current_turn, start_fen, move_history, redo_stack
+    order, color = parse_fen(fen)
+    if order is None:
+        return False
+    piece_order = order
+    moves = []
+    move_history = []
+    redo_stack = []
+    start_fen = fen
+    white_clock = ChessClock(TIME_CONTROL)
+    black_clock = ChessClock(TIME_CONTROL)
+    current_turn = 0 if color == 'w' else 1
+    return True
+
+def handle_position_message(fen):
+    if not load_position(fen):
+        print(f"Illegal start position: {fen}")
+        send_serial_response([0, 0])
+        return
+    send_serial_response([1, 0])
+    print(f"Start position: {fen}")
+
+def handle_undo_message(expected_hash, seq=None, board_us=None):
+    global current_turn
+    remember_sequence(seq)
+    if not move_history:
+        send_serial_response([0, 0])
+        return
+    entry = move_history[-1]
+    order = piece_order.copy()
+    order[entry['origin']] = entry['piece']
+    order[entry['destination']] = entry['captured']
+    if fen_hash(position_fen(order, 'w' if entry['turn'] == 0 else 'b')) != expected_hash:
+        print("Undo refused: board and host positions differ")
+        send_serial_response([0, 0])
+        return
+    piece_order[:] = order
+    current_turn = entry['turn']
+    white_clock.time_left = entry['white_before']
+    black_clock.time_left = entry['black_before']
+    if len(moves[-1]) == 2:
+        moves[-1].pop()
+    else:
+        moves.pop()
+    redo_stack.append(move_history.pop())
+    send_serial_response([1, 0])
+    print(f"Undo: {entry['notation']}")
+    print(moves)
+
+def handle_redo_message(expected_hash, seq=None, board_us=None):
+    global current_turn
+    remember_sequence(seq)
+    if not redo_stack:
+        send_serial_response([0, 0])
+        return
+    entry = redo_stack[-1]
+    order = piece_order.copy()
+    order[entry['destination']] = entry['piece']
+    order[entry['origin']] = None
+    if fen_hash(position_fen(order, 'b' if entry['turn'] == 0 else 'w')) != expected_hash:
+        print("Redo refused: board and host positions differ")
+        send_serial_response([0, 0])
+        return
+    piece_order[:] = order
+    current_turn = 1 - entry['turn']
+    white_clock.time_left = entry['white_after']
+    black_clock.time_left = entry['black_after']
+    if len(moves) == 0 or len(moves[-1]) == 2:
+        moves.append([entry['notation']])
+    else:
+        moves[-1].append(entry['notation'])
+    move_history.append(redo_stack.pop())
+    send_serial_response([1, 0])
+    print(f"Redo: {entry['notation']}")
+    print(moves)
+
+def session_clocks(event):
+    # White and black ms and the think time; boards before the millisecond fields only have seconds
+    if len(event) >= 11:
+        return event[8], event[9], event[10]
+    return event[5] * 1000, event[6] * 1000, None
+
+def apply_session_event(event):
+    # [seq, kind, origin, destination, result, white time, black time, FEN after the event, white ms, black ms,
+    # think ms], as the board sent it
+    global TIME_CONTROL, last_seq
+    seq, kind, origin, destination, result, white_time, black_time, fen = event[:8]
+    white_ms, black_ms, think_ms = session_clocks(event)
+    if kind == 'inicio':
+        TIME_CONTROL = white_time
+        load_position(fen)
+    elif kind == 'lance':
+        white_moved = fen.endswith('b')
+        handle_serial_message(origin, destination, white_time if white_moved else black_time, TIME_CONTROL, seq,
+                              time_remaining_ms=white_ms if white_moved else black_ms, think_ms=think_ms)
+    elif kind == 'desfaz':
+        handle_undo_message(fen_hash(fen), seq)
+    elif kind == 'refaz':
+        handle_redo_message(fen_hash(fen), seq)
+    if position_fen(piece_order, 'w' if current_turn == 0 else 'b') != fen:
+        print(f"Resume: host and board positions differ, adopting {fen}")
+        load_position(fen)
+    white_clock.time_left = white_ms / 1000
+    black_clock.time_left = black_ms / 1000
+    last_seq = seq
+
+def handle_resume_message(reply):
+    global session_id, last_seq, replaying
+    if 'sessao' not in reply or not reply['sessao']:
+        return
+    if reply['sessao'] != session_id:
+        # Another game (or the first resume): the events start at the beginning of the session
+        session_id = reply['sessao']
+        last_seq = 0
+    replaying = True
+    try:
+        if not reply['completo']:
+            print("Resume: missed events no longer on the board, starting from its current position")
+            event = reply['eventos'][-1]
+            white_ms, black_ms, _ = session_clocks(event)
+            load_position(event[7])
+            white_clock.time_left = white_ms / 1000
+            black_clock.time_left = black_ms / 1000
+        else:
+            for event in reply['eventos']:
+                if event[0] > last_seq:
+                    apply_session_event(event)
+    finally:
+        replaying = False
+    last_seq = max(last_seq, reply['seq'])
+    print(f"Resumed session {session_id} at sequence {last_seq}")
     print(moves)
 
 current_scene = "main"
 analysis_moves = []
 analysis_times = []
+analysis_thinks = []
 analysis_index = 0
 analysis_piece_order = None
 analysis_white_clock = None
 analysis_black_clock = None
 analysis_result = None
+analysis_start_order = None
 
 def parse_game_file(file_path):
     moves = []
     times = []
+    thinks = []
     result = None
+    start_order = PIECE_START_ORDER.copy()
     with open(file_path, 'r') as f:
         for line in f:
             line = line.strip()
             if not line:
                 continue
+            if line.startswith('FEN '):
+                order, _ = parse_fen(line[4:])
+                if order is not None:
+                    start_order = order
+                continue
             if line in ['1-0', '0-1', '1/2-1/2']:
                 result = line
                 continue
+            if line.startswith('MS ') and moves:
+                # Milliseconds for the move line above; replaces its whole-second times
+                fields = line.split()[1:]
+                times[-1] = tuple(int(ms) / 1000 for ms in fields[0::2][:len(times[-1])])
+                thinks[-1] = tuple(None if ms == '-' else int(ms) for ms in fields[1::2][:len(times[-1])])
+                continue
             if line[0].isdigit() is False:
                 continue
             parts = line.split()
@@ -365,14 +749,22 @@ def parse_game_file(file_path):
                 if len(parts) >= 5:
                     moves.append((parts[1], parts[3]))
                     times.append((int(parts[2]), int(parts[4])))
+                    thinks.append((None, None))
                 else:
                     moves.append((parts[1],))
                     times.append((int(parts[2]),))
-    return moves, times, result
+                    thinks.append((None,))
+    return moves, times, thinks, result, start_order
+
+def analysis_think_ms(index):
+    if index < 0:
+        return None
+    think_pair = analysis_thinks[index // 2]
+    return think_pair[index % 2] if index % 2 < len(think_pair) else None
 
 def set_analysis_state(index):
     global analysis_piece_order, analysis_white_clock, analysis_black_clock
-    analysis_piece_order, _, _, _, _ = reset_board()
+    analysis_piece_order = analysis_start_order.copy()
     analysis_white_clock = ChessClock(TIME_CONTROL)
     analysis_black_clock = ChessClock(TIME_CONTROL)
     if index < 0:
@@ -432,6 +824,10 @@ def draw_analysis_scene(window, board, board_rect, logo_img, logo_rect, piece_im
     pygame.draw.rect(window, (160, 160, 160), black_clock_rect, border_radius=8, width=2)
     black_time_surface = FONT.render(analysis_black_clock.get_time_str(), True, (160, 160, 160))
     window.blit(black_time_surface, (black_clock_rect.centerx - black_time_surface.get_width() // 2, black_clock_rect.centery - black_time_surface.get_height() // 2))
+    think_ms = analysis_think_ms(analysis_index)
+    if think_ms is not None:
+        think_surface = FONT.render(f"{think_ms / 1000:.3f} s", True, (149, 171, 129))
+        window.blit(think_surface, (board_rect_left.centerx - think_surface.get_width() // 2, white_clock_rect.centery - think_surface.get_height() // 2))
     move_list_x = board_rect_left.right + 60
     move_list_y = board_rect_left.top
     move_list_width = 260
@@ -463,13 +859,14 @@ def draw_analysis_scene(window, board, board_rect, logo_img, logo_rect, piece_im
 
 def main():
     global TIME_CONTROL, piece_order, moves, white_clock, black_clock, current_turn
-    global current_scene, analysis_moves, analysis_times, analysis_index, analysis_piece_order, analysis_white_clock, analysis_black_clock, analysis_result
+    global current_scene, analysis_moves, analysis_times, analysis_thinks, analysis_index, analysis_piece_order, analysis_white_clock, analysis_black_clock, analysis_result, analysis_start_order
     pygame.init()
     piece_order, _, moves, _, _ = reset_board()
     white_clock = ChessClock(TIME_CONTROL)
     black_clock = ChessClock(TIME_CONTROL)
     current_turn = 0
-    serial_listener(handle_serial_message)
+    serial_listener(handle_serial_message, {'fen': handle_position_message, 'desfaz': handle_undo_message, 'refaz': handle_redo_message},
+                    handle_resume_message)
     window = pygame.display.set_mode((WINDOW_WIDTH, WINDOW_HEIGHT))
     board_img, logo_img, piece_images = load_assets()
     board = pygame.Surface(BOARD_SIZE, pygame.SRCALPHA)
@@ -546,7 +943,7 @@ def main():
                             title="Load Game File"
                         )
                         if file_path:
-                            analysis_moves, analysis_times, analysis_result = parse_game_file(file_path)
+                            analysis_moves, analysis_times, analysis_thinks, analysis_result, analysis_start_order = parse_game_file(file_path)
                             analysis_index = -1
                             set_analysis_state(analysis_index)
                             current_scene = "analysis"
@@ -584,7 +981,7 @@ def main():
                             title="Load Game File"
                         )
                         if file_path:
-                            analysis_moves, analysis_times, analysis_result = parse_game_file(file_path)
+                            analysis_moves, analysis_times, analysis_thinks, analysis_result, analysis_start_order = parse_game_file(file_path)
                             analysis_index = -1
                             set_analysis_state(analysis_index)
                             current_scene = "analysis"
@@ -601,7 +998,9 @@ def main():
         if current_scene == "main":
             window.blit(board, board_rect)
             window.blit(logo_img, logo_rect)
-            draw_strip_pieces(window, piece_order, board_rect, piece_images)
+            draw_strip_pieces(window, telemetry_board() or piece_order, board_rect, piece_images)
+            white_clock.update()
+            black_clock.update()
             clock_width, clock_height = 200, 50
             clock_y_offset = board_rect.bottom + 20
             white_clock_rect = pygame.Rect(board_rect.left, clock_y_offset, clock_width, clock_height)
@@ -0,0 +1,148 @@
+#include "memoria.h"
+#include "registro.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+struct TarefaMonitorada
+{
+  const char *nome;
+  void *tarefa;
+  HistoricoMemoria pilha_livre;
+};
+
+static HistoricoMemoria livre;
+static HistoricoMemoria maior_bloco;
+static HistoricoMemoria fragmentacao;
+static TarefaMonitorada tarefas[QUANTIDADE_MAXIMA_TAREFAS_MEMORIA];
+static volatile unsigned int quantidade_tarefas = 0;
+static uint32_t alarmes = 0;
+static bool alarme_ativo = false;
+static bool amostrou = false;
+static unsigned long tempo_ultima_amostra = 0;
+
+static void AtualizaHistorico(HistoricoMemoria &historico, uint32_t valor, bool primeira)
+{
+  historico.atual = valor;
+
+  if(primeira || valor < historico.minimo)
+    historico.minimo = valor;
+  if(primeira || valor > historico.maximo)
+    historico.maximo = valor;
+}
+
+void MonitoraPilhaTarefa(const char *nome, void *tarefa)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(quantidade_tarefas >= QUANTIDADE_MAXIMA_TAREFAS_MEMORIA)
+    return;
+
+  TarefaMonitorada &nova = tarefas[quantidade_tarefas];
+  nova.nome = nome;
+  nova.tarefa = tarefa ? tarefa : (void *)xTaskGetCurrentTaskHandle();
+  nova.pilha_livre = {0, 0, 0};
+  quantidade_tarefas++; //Só depois de preencher, AmostraMemoria() pode estar rodando em outra tarefa
+#endif
+}
+
+static void AmostraPilhas(bool primeira)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  for(unsigned int i = 0; i < quantidade_tarefas; i++)
+  {
+    //No ESP-IDF a marca d'água já vem em bytes
+    uint32_t folga = uxTaskGetStackHighWaterMark((TaskHandle_t)tarefas[i].tarefa);
+    AtualizaHistorico(tarefas[i].pilha_livre, folga, primeira || tarefas[i].pilha_livre.maximo == 0);
+  }
+#endif
+}
+
+void AmostraMemoria()
+{
+  if(amostrou && millis() - tempo_ultima_amostra < PERIODO_AMOSTRA_MEMORIA_MS)
+    return;
+
+  bool primeira = !amostrou;
+  uint32_t bytes_livres = ESP.getFreeHeap();
+  uint32_t bytes_maior_bloco = ESP.getMaxAllocHeap();
+
+  AtualizaHistorico(livre, bytes_livres, primeira);
+  AtualizaHistorico(maior_bloco, bytes_maior_bloco, primeira);
+  AtualizaHistorico(fragmentacao, bytes_livres ? 100 - (uint32_t)((uint64_t)bytes_maior_bloco * 100 / bytes_livres) : 100, primeira);
+  AmostraPilhas(primeira);
+
+  if(bytes_maior_bloco < LIMITE_MAIOR_BLOCO_MEMORIA && !alarme_ativo)
+  {
+    alarme_ativo = true;
+    alarmes++;
+    REGISTRA_AVISO("Memoria: maior bloco livre %d bytes (livres %d), abaixo de %d", bytes_maior_bloco, bytes_livres,
+                   LIMITE_MAIOR_BLOCO_MEMORIA);
+  }
+  else if(bytes_maior_bloco >= LIMITE_MAIOR_BLOCO_MEMORIA && alarme_ativo)
+  {
+    alarme_ativo = false;
+    REGISTRA_INFO("Memoria: maior bloco livre voltou a %d bytes", bytes_maior_bloco);
+  }
+
+  amostrou = true;
+  tempo_ultima_amostra = millis();
+}
+
+ResumoMemoria ResumeMemoria()
+{
+  ResumoMemoria resumo;
+
+  resumo.livre = livre;
+  resumo.maior_bloco = maior_bloco;
+  resumo.fragmentacao = fragmentacao;
+  resumo.pilha_minima = 0;
+  resumo.alarmes = alarmes;
+  resumo.alarme_ativo = alarme_ativo;
+
+  for(unsigned int i = 0; i < quantidade_tarefas; i++)
+    if(resumo.pilha_minima == 0 || tarefas[i].pilha_livre.minimo < resumo.pilha_minima)
+      resumo.pilha_minima = tarefas[i].pilha_livre.minimo;
+
+  return resumo;
+}
+
+static void EscreveHistorico(Print &saida, const char *nome, const HistoricoMemoria &historico, bool primeiro)
+{
+  char texto[96];
+
+  snprintf(texto, sizeof(texto), "%s\"%s\": {\"atual\": %lu, \"min\": %lu, \"max\": %lu}", primeiro ? "" : ", ", nome,
+           (unsigned long)historico.atual, (unsigned long)historico.minimo, (unsigned long)historico.maximo);
+  saida.print(texto);
+}
+
+void EscreveMemoria(Print &saida)
+{
+  char texto[96];
+
+  saida.print("{");
+  EscreveHistorico(saida, "livre", livre, true);
+  EscreveHistorico(saida, "maior_bloco", maior_bloco, false);
+  EscreveHistorico(saida, "fragmentacao_pct", fragmentacao, false);
+
+  saida.print(", \"pilhas\": {");
+  for(unsigned int i = 0; i < quantidade_tarefas; i++)
+    EscreveHistorico(saida, tarefas[i].nome, tarefas[i].pilha_livre, i == 0);
+
+  snprintf(texto, sizeof(texto), "}, \"limite_maior_bloco\": %d, \"alarmes\": %lu, \"alarme_ativo\": %s}", LIMITE_MAIOR_BLOCO_MEMORIA,
+           (unsigned long)alarmes, alarme_ativo ? "true" : "false");
+  saida.println(texto);
+}
+
+void LimpaMemoria()
+{
+  alarmes = 0;
+  alarme_ativo = false;
+  amostrou = false; //A próxima amostra recomeça todos os históricos
+
+  AmostraMemoria();
+}
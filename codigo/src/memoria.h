@@ -0,0 +1,44 @@
+//Monitor de memória: heap livre, maior bloco livre, fragmentação e pilha mínima de cada tarefa
+//
+//AmostraMemoria() é chamada a cada loop() e lê o heap uma vez por PERIODO_AMOSTRA_MEMORIA_MS, guardando o mínimo e
+//o máximo de cada métrica desde o início (ou desde o último LimpaMemoria()). Quando o maior bloco livre fica abaixo
+//de LIMITE_MAIOR_BLOCO_MEMORIA um aviso é registrado, antes que uma alocação do caminho do lance falhe e reinicie
+//o ESP32 no meio da partida.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+
+#define PERIODO_AMOSTRA_MEMORIA_MS 1000
+#define QUANTIDADE_MAXIMA_TAREFAS_MEMORIA 8
+
+//Maior alocação que ainda acontece ao enviar um lance: a pilha Bluedroid copia cada escrita do SerialBT em um
+//buffer do tamanho do MTU do SPP (990 bytes) mais o cabeçalho. Abaixo disso o próximo EnviaMensagem() pode falhar.
+#ifndef LIMITE_MAIOR_BLOCO_MEMORIA
+#define LIMITE_MAIOR_BLOCO_MEMORIA 1024
+#endif
+
+struct HistoricoMemoria
+{
+  uint32_t atual;
+  uint32_t minimo;
+  uint32_t maximo;
+};
+
+struct ResumoMemoria
+{
+  HistoricoMemoria livre; //Bytes
+  HistoricoMemoria maior_bloco; //Bytes
+  HistoricoMemoria fragmentacao; //Percentual do heap livre que não está no maior bloco
+  uint32_t pilha_minima; //Menor folga de pilha entre as tarefas monitoradas, em bytes (0 se nenhuma)
+  uint32_t alarmes;
+  bool alarme_ativo;
+};
+
+//Passa a acompanhar a folga mínima de pilha da tarefa (TaskHandle_t do FreeRTOS; nullptr = a tarefa que chama).
+//Fora do ESP32 não há tarefas e a chamada não faz nada.
+void MonitoraPilhaTarefa(const char *nome, void *tarefa = nullptr);
+void AmostraMemoria();
+ResumoMemoria ResumeMemoria();
+void EscreveMemoria(Print &saida); //Resposta JSON do comando "?memoria"
+void LimpaMemoria();
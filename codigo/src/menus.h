@@ -0,0 +1,40 @@
+//Opções dos menus do LCD: a linha de cada item e o valor de opcao_selecionada (main.cpp) em cada tela
+//
+//Usadas também pela bancada (bancada.cpp), que põe o firmware numa partida e o devolve ao menu inicial.
+#pragma once
+
+//Linhas em que as funcionalidades são exibidas no LCD
+#define LINHA_CONTINUAR 0
+#define LINHA_ENCERRAR_PARTIDA 1
+#define LINHA_CONFIGURAR_TEMPO 0
+#define LINHA_JOGADOR_VS_JOGADOR 0
+#define LINHA_JOGADOR_VS_MAQUINA 1
+#define LINHA_DEFINIR_DIFICULDADE 1
+#define LINHA_MENU_CONFIGURAR_TEMPO 1
+#define LINHA_VOLTAR_CONFIGURAR_TEMPO 1
+#define LINHA_LANCE_AUTOMATICO 2
+#define LINHA_VOLTAR_JOGADOR_VS_JOGADOR 3
+#define LINHA_VOLTAR_JOGADOR_VS_MAQUINA 2
+#define LINHA_INICIAR_JOGADOR_VS_MAQUINA 0
+#define LINHA_INICIAR_JOGADOR_VS_JOGADOR 0
+#define LINHA_JOGAR_NOVAMENTE 2
+#define LINHA_VOLTAR_FIM_PARTIDA 3
+
+//A relação entre LINHA_X e X é: se LINHA_X e X existem o valor de X é equivalente ao valor da linha incrementado pelo parâmetro "incremento_linha" da função "AtualizaOpcaoSelecionadaMenu"
+#define MENU_PAUSE 200 //Valor fixo não atrelado a nenhuma linha
+#define MENU_FIM_PARTIDA 300
+#define MENU_DIAGNOSTICO 400 //Tela escondida, aberta com esquerda + direita no menu inicial
+#define MENU_CALIBRACAO 500 //Assistente de calibração, aberto pela página de calibração do diagnóstico
+#define MENU_CONFERE_TABULEIRO 600 //Antes de cada partida nova, até as peças estarem na posição inicial
+#define MENU_INICIAL 100 //Valor qualquer (entrará no caso default da estrutura switch)
+#define JOGADOR_VS_JOGADOR LINHA_JOGADOR_VS_JOGADOR
+#define JOGADOR_VS_MAQUINA LINHA_JOGADOR_VS_MAQUINA
+#define MENU_CONFIGURAR_TEMPO LINHA_MENU_CONFIGURAR_TEMPO + 10
+#define INICIAR_JOGADOR_VS_JOGADOR LINHA_INICIAR_JOGADOR_VS_JOGADOR + 10
+#define ALTERNAR_LANCE_AUTOMATICO LINHA_LANCE_AUTOMATICO + 10
+#define DEFINIR_DIFICULDADE LINHA_DEFINIR_DIFICULDADE + 20
+#define INICIAR_JOGADOR_VS_MAQUINA LINHA_INICIAR_JOGADOR_VS_MAQUINA + 20
+#define CONTINUAR LINHA_CONTINUAR + 30
+#define CONFIGURAR_TEMPO LINHA_CONFIGURAR_TEMPO + 40
+#define VOLTAR_CONFIGURAR_TEMPO LINHA_VOLTAR_CONFIGURAR_TEMPO + 40
+#define JOGAR_NOVAMENTE LINHA_JOGAR_NOVAMENTE + 50
@@ -0,0 +1,84 @@
+//Gerado por pagina_web.py a partir de assets/pagina/index.html; não edite à mão
+//Resposta HTTP completa: 149 bytes de cabeçalho e 1292 de corpo em gzip (2521 sem compressão)
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t resposta_pagina[] = {
+  0x48, 0x54, 0x54, 0x50, 0x2f, 0x31, 0x2e, 0x31, 0x20, 0x32, 0x30, 0x30, 0x20, 0x4f, 0x4b, 0x0d, 0x0a, 0x43, 0x6f, 0x6e,
+  0x74, 0x65, 0x6e, 0x74, 0x2d, 0x54, 0x79, 0x70, 0x65, 0x3a, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2f, 0x68, 0x74, 0x6d, 0x6c,
+  0x3b, 0x20, 0x63, 0x68, 0x61, 0x72, 0x73, 0x65, 0x74, 0x3d, 0x75, 0x74, 0x66, 0x2d, 0x38, 0x0d, 0x0a, 0x43, 0x6f, 0x6e,
+  0x74, 0x65, 0x6e, 0x74, 0x2d, 0x45, 0x6e, 0x63, 0x6f, 0x64, 0x69, 0x6e, 0x67, 0x3a, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x0d,
+  0x0a, 0x43, 0x6f, 0x6e, 0x74, 0x65, 0x6e, 0x74, 0x2d, 0x4c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x3a, 0x20, 0x31, 0x32, 0x39,
+  0x32, 0x0d, 0x0a, 0x43, 0x61, 0x63, 0x68, 0x65, 0x2d, 0x43, 0x6f, 0x6e, 0x74, 0x72, 0x6f, 0x6c, 0x3a, 0x20, 0x6e, 0x6f,
+  0x2d, 0x63, 0x61, 0x63, 0x68, 0x65, 0x0d, 0x0a, 0x43, 0x6f, 0x6e, 0x6e, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x3a, 0x20,
+  0x63, 0x6c, 0x6f, 0x73, 0x65, 0x0d, 0x0a, 0x0d, 0x0a, 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95,
+  0x56, 0xdb, 0x8e, 0xdb, 0x36, 0x10, 0x7d, 0xf7, 0x57, 0xcc, 0x3a, 0x68, 0x24, 0x21, 0x96, 0x7c, 0xc9, 0x26, 0x75, 0x24,
+  0xdb, 0x41, 0xba, 0xd9, 0xa2, 0x97, 0x24, 0x2d, 0xb2, 0x41, 0x51, 0x60, 0xb1, 0x28, 0x68, 0x89, 0xb2, 0x99, 0x95, 0x48,
+  0x95, 0xa4, 0xe5, 0x75, 0x1c, 0xff, 0x45, 0x51, 0xb4, 0x45, 0xd1, 0x97, 0x7e, 0x42, 0x3f, 0x21, 0x7f, 0xd2, 0x2f, 0xe9,
+  0xf0, 0xe2, 0x5d, 0xfb, 0x21, 0x2d, 0xfa, 0x62, 0x0e, 0x87, 0x73, 0x3b, 0x33, 0x87, 0x94, 0x27, 0x27, 0x85, 0xc8, 0xf5,
+  0xa6, 0xa1, 0xb0, 0xd4, 0x75, 0x35, 0xeb, 0x4c, 0xcc, 0x02, 0x15, 0xe1, 0x8b, 0x69, 0xb7, 0xd1, 0xf1, 0x5c, 0x76, 0x8d,
+  0x8e, 0x92, 0x02, 0x97, 0x9a, 0x6a, 0x02, 0xf9, 0x92, 0x48, 0x45, 0xf5, 0xb4, 0xbb, 0xd2, 0x65, 0x3c, 0xee, 0xee, 0xd5,
+  0x9c, 0xd4, 0x74, 0xda, 0x6d, 0x19, 0x5d, 0x37, 0x42, 0xea, 0x2e, 0xe4, 0x82, 0x6b, 0xca, 0xd1, 0x6c, 0xcd, 0x0a, 0xbd,
+  0x9c, 0x16, 0xb4, 0x65, 0x39, 0x8d, 0xed, 0xa6, 0xc7, 0x38, 0xd3, 0x8c, 0x54, 0xb1, 0xca, 0x49, 0x45, 0xa7, 0x43, 0x13,
+  0x43, 0x33, 0x5d, 0xd1, 0xd9, 0x1b, 0xf6, 0x3d, 0x10, 0x01, 0x2d, 0x6b, 0xc5, 0xa4, 0xef, 0x54, 0x9d, 0x89, 0xd2, 0x1b,
+  0xb3, 0xce, 0x45, 0xb1, 0xd9, 0xd6, 0x44, 0x2e, 0x18, 0x4f, 0x07, 0x59, 0x43, 0x8a, 0x82, 0xf1, 0x45, 0x7a, 0xda, 0xae,
+  0x61, 0x90, 0x95, 0x98, 0x2c, 0x2e, 0x49, 0xcd, 0xaa, 0x4d, 0xaa, 0x08, 0x57, 0xb1, 0xa2, 0x92, 0x95, 0xd9, 0x9c, 0xe4,
+  0xd7, 0x0b, 0x29, 0x56, 0xbc, 0x48, 0xef, 0x9d, 0xce, 0x4f, 0xc7, 0xa7, 0x9f, 0x66, 0xb9, 0xa8, 0x84, 0x4c, 0xef, 0x15,
+  0x45, 0x91, 0x69, 0x7a, 0xa3, 0x63, 0x52, 0xb1, 0x05, 0x4f, 0x73, 0xac, 0x94, 0xca, 0x5d, 0xe7, 0x5e, 0x4e, 0x14, 0x51,
+  0xdb, 0x82, 0xa9, 0xa6, 0x22, 0x9b, 0xb4, 0xac, 0xe8, 0x4d, 0xf6, 0x76, 0xa5, 0x34, 0x2b, 0x37, 0xb1, 0x07, 0xe4, 0x6d,
+  0x33, 0x5f, 0x89, 0xcd, 0xbf, 0x77, 0x84, 0x82, 0xb5, 0x5b, 0x0b, 0x31, 0x1d, 0x0e, 0xdb, 0x75, 0xb6, 0xa4, 0x6c, 0xb1,
+  0xd4, 0x4e, 0xae, 0xc9, 0x8d, 0x43, 0x9f, 0x8e, 0x07, 0xcd, 0x8d, 0xdd, 0xfa, 0x63, 0xbb, 0xb7, 0x08, 0x14, 0x7b, 0x47,
+  0xd3, 0x9a, 0xf1, 0x70, 0xdc, 0xae, 0x7b, 0x8f, 0xc6, 0xcd, 0x4d, 0x94, 0x55, 0x8c, 0xd3, 0xbd, 0xa1, 0x39, 0x31, 0xb1,
+  0x7a, 0xc6, 0x23, 0x3a, 0x42, 0xf7, 0xe4, 0x11, 0x99, 0x8f, 0x87, 0x7b, 0x74, 0xc3, 0xe1, 0xf0, 0xb0, 0xa4, 0x94, 0xeb,
+  0x65, 0x9c, 0x2f, 0x59, 0x55, 0x84, 0xb4, 0xa5, 0x3c, 0xda, 0x1e, 0x7a, 0xd2, 0x39, 0xcd, 0x0b, 0x44, 0x90, 0x48, 0x5a,
+  0x89, 0x05, 0x13, 0xb7, 0xe0, 0x19, 0xb7, 0xb9, 0xe7, 0x95, 0xc8, 0xaf, 0x33, 0x57, 0xf9, 0xc3, 0xf1, 0x11, 0x90, 0xd1,
+  0x63, 0x87, 0xc4, 0x8d, 0x04, 0x46, 0x78, 0xb8, 0x1f, 0xcb, 0xe8, 0x6e, 0x2c, 0xb7, 0xa0, 0x9e, 0x18, 0x50, 0x8f, 0x6d,
+  0xe5, 0x42, 0x16, 0x54, 0xc6, 0x92, 0x14, 0x6c, 0xa5, 0x52, 0xc4, 0x79, 0x84, 0x65, 0x94, 0x8f, 0xe6, 0xa3, 0x27, 0xde,
+  0x28, 0x7d, 0xd8, 0xdc, 0x80, 0x12, 0x15, 0x2b, 0xc0, 0x1f, 0x60, 0xa9, 0x2d, 0x7d, 0xb7, 0xf5, 0x31, 0x3c, 0x62, 0x87,
+  0x1f, 0x41, 0x53, 0xa5, 0x49, 0x21, 0xb6, 0xc7, 0x99, 0x71, 0x48, 0xbd, 0xd1, 0xa9, 0xc9, 0x2c, 0x1a, 0x92, 0x33, 0xbd,
+  0x49, 0x93, 0xf1, 0xae, 0x33, 0xe9, 0x7b, 0x66, 0x4d, 0xfa, 0x9e, 0xdf, 0x86, 0x62, 0xb8, 0x60, 0xcb, 0x80, 0x15, 0xd3,
+  0xae, 0x6d, 0x60, 0x77, 0x36, 0xe9, 0xa3, 0xc2, 0xf0, 0xb0, 0x21, 0x1c, 0xf2, 0x8a, 0x28, 0x35, 0xed, 0xfa, 0x66, 0x75,
+  0xad, 0xdd, 0xba, 0x3b, 0x8b, 0xd3, 0x38, 0xc6, 0x78, 0x68, 0x31, 0xfb, 0xb8, 0xdd, 0xfc, 0xc8, 0xae, 0x33, 0x69, 0xac,
+  0xd6, 0x55, 0xdc, 0x9d, 0x9d, 0x09, 0x4e, 0x73, 0x4d, 0x78, 0x21, 0x92, 0x24, 0x99, 0xf4, 0x1b, 0x93, 0x31, 0x97, 0xac,
+  0xd1, 0xb3, 0x4e, 0x4b, 0x24, 0x7c, 0x7b, 0x7e, 0xf6, 0xec, 0x02, 0xa6, 0xb0, 0xfd, 0x3a, 0x85, 0xe0, 0xef, 0x5f, 0x7f,
+  0x0a, 0x7a, 0xf0, 0xca, 0x4a, 0xbf, 0xa0, 0xf4, 0xda, 0x4a, 0x3f, 0xa3, 0x74, 0x6d, 0xa5, 0xdf, 0x50, 0xe2, 0x56, 0xfa,
+  0x03, 0x25, 0x69, 0xa5, 0xdf, 0x83, 0x5d, 0x66, 0x23, 0xb9, 0x84, 0x18, 0x8a, 0xaf, 0xaa, 0x0a, 0x4f, 0x69, 0x4e, 0xe7,
+  0xcc, 0x2a, 0x06, 0x59, 0xa7, 0x53, 0xae, 0x78, 0xae, 0x99, 0xe0, 0xe0, 0x4b, 0x0f, 0x6b, 0x15, 0xc1, 0xb6, 0x03, 0x60,
+  0x5c, 0x15, 0x1a, 0xbd, 0x24, 0x7a, 0x99, 0xe4, 0x94, 0x55, 0xa1, 0x95, 0x90, 0x0e, 0x68, 0xd2, 0x83, 0x41, 0x04, 0x7d,
+  0x18, 0x0e, 0x06, 0x83, 0x28, 0x03, 0xe8, 0xf7, 0xf1, 0xfe, 0xd7, 0x02, 0x04, 0xbc, 0x38, 0x7b, 0x9e, 0xe2, 0xa2, 0xe8,
+  0x02, 0x67, 0x2b, 0x50, 0x2b, 0xa5, 0xb9, 0x3f, 0x40, 0x18, 0x2f, 0xf0, 0xd1, 0xf8, 0xf0, 0xa7, 0x80, 0x52, 0x30, 0x28,
+  0xa8, 0x32, 0xf7, 0x0b, 0xeb, 0xc2, 0x4c, 0x92, 0xea, 0x95, 0xe4, 0x2e, 0x51, 0x59, 0x09, 0x21, 0x43, 0x85, 0xb1, 0x1f,
+  0x63, 0x86, 0x07, 0x10, 0xa4, 0x01, 0xfe, 0x86, 0xc1, 0xc0, 0x2c, 0x0a, 0x3e, 0x31, 0xea, 0x44, 0x55, 0xf8, 0xb6, 0x84,
+  0xf1, 0x28, 0xca, 0x3a, 0xbb, 0x03, 0x04, 0x76, 0x7e, 0x61, 0x89, 0x8c, 0xbf, 0x05, 0x60, 0x1f, 0xb7, 0x29, 0x04, 0x41,
+  0x86, 0x8a, 0x52, 0x48, 0x08, 0x8d, 0x36, 0x07, 0x51, 0x02, 0xda, 0x25, 0xc8, 0x7c, 0xa6, 0xc3, 0x00, 0x82, 0xe8, 0x72,
+  0x70, 0x15, 0xa1, 0x09, 0x38, 0x8f, 0x07, 0x53, 0xb4, 0x99, 0xa1, 0xdf, 0x30, 0x80, 0xfb, 0xf7, 0x51, 0x9e, 0xa0, 0x3c,
+  0x0e, 0xe0, 0x29, 0x04, 0x86, 0x2d, 0x9e, 0x22, 0x01, 0xde, 0xa1, 0x86, 0x12, 0x1d, 0x3e, 0xc8, 0x23, 0x48, 0xfd, 0x91,
+  0xa9, 0xd3, 0xce, 0xee, 0x32, 0xbf, 0x32, 0xf5, 0x7b, 0x53, 0x93, 0x1f, 0x1f, 0xde, 0x55, 0x8d, 0xdd, 0x48, 0x16, 0x54,
+  0x9f, 0x57, 0xd4, 0x88, 0x9f, 0x6d, 0xbe, 0x2c, 0xc2, 0xc0, 0x16, 0x1e, 0x44, 0x09, 0xe3, 0x9c, 0xca, 0x2f, 0xde, 0xbc,
+  0x7c, 0x81, 0x25, 0x9b, 0x3a, 0x8e, 0xe1, 0x61, 0xcf, 0x28, 0x5f, 0x92, 0xd0, 0xa1, 0x63, 0x25, 0x84, 0x6e, 0xb2, 0x6e,
+  0xef, 0xf0, 0xe2, 0x4d, 0x41, 0x5f, 0xa7, 0x4f, 0x2c, 0x42, 0xd7, 0xaa, 0x61, 0xd4, 0x43, 0x7f, 0x33, 0x0d, 0x37, 0x79,
+  0x6f, 0xe1, 0xc6, 0x83, 0x9a, 0xa7, 0xf0, 0x9c, 0x68, 0x9a, 0x70, 0xb1, 0xc6, 0xf0, 0xf1, 0x1d, 0x47, 0x52, 0xc3, 0x11,
+  0x13, 0xfc, 0x32, 0x58, 0x23, 0xb3, 0x82, 0x79, 0x70, 0x95, 0x60, 0x1b, 0xcf, 0x49, 0xbe, 0x0c, 0x6f, 0x0b, 0x0b, 0x31,
+  0xcc, 0xbe, 0x08, 0x57, 0x06, 0x35, 0x4d, 0xff, 0x18, 0x5c, 0x63, 0x9d, 0x79, 0x63, 0x5a, 0x25, 0xe6, 0x59, 0x3e, 0x73,
+  0x6f, 0x2d, 0x3a, 0xed, 0x59, 0xe8, 0x0a, 0xbc, 0x44, 0x5b, 0x98, 0x62, 0xef, 0xd7, 0xb6, 0xf7, 0x73, 0x49, 0x38, 0xf6,
+  0xea, 0x87, 0x5a, 0x05, 0xa6, 0xdf, 0x0d, 0x12, 0xc7, 0xed, 0xae, 0xb0, 0xe6, 0xd0, 0xdb, 0x9a, 0x16, 0x3c, 0x3d, 0x00,
+  0x8b, 0x10, 0xa2, 0xc3, 0x7c, 0xf6, 0xa6, 0xbe, 0xc2, 0xaf, 0x97, 0xe1, 0x85, 0x4f, 0x67, 0x39, 0xe6, 0x7b, 0xd2, 0x10,
+  0xa9, 0x19, 0x72, 0xd5, 0xcc, 0xfd, 0x30, 0x62, 0x60, 0x56, 0x9b, 0x37, 0xf0, 0xe1, 0x76, 0x76, 0xdd, 0x59, 0x06, 0xff,
+  0xb8, 0x42, 0xf7, 0x67, 0x9c, 0xd5, 0xc4, 0xb4, 0xe4, 0x73, 0x89, 0xf1, 0x43, 0x3f, 0x30, 0xc7, 0x52, 0xdb, 0x16, 0x7c,
+  0x8d, 0xb5, 0x30, 0x97, 0x8a, 0xd3, 0x35, 0x9c, 0x9b, 0xdd, 0x85, 0x58, 0x49, 0x1c, 0x50, 0xd0, 0xf7, 0x67, 0x26, 0xb6,
+  0x17, 0x13, 0xc1, 0x6b, 0xaa, 0x14, 0x59, 0x98, 0x4a, 0xef, 0x9a, 0x5d, 0xdf, 0xb1, 0x9b, 0x8b, 0xd6, 0x0c, 0xf3, 0xab,
+  0x8b, 0x6f, 0x5e, 0x99, 0xb2, 0x15, 0x0d, 0xeb, 0xa4, 0x20, 0x9a, 0xd8, 0xba, 0x0c, 0x41, 0x4e, 0xfc, 0xdd, 0x7f, 0xff,
+  0xde, 0xda, 0x1a, 0x46, 0xc0, 0xc9, 0x21, 0x3f, 0x1c, 0xe7, 0xdd, 0xc5, 0xd9, 0x5b, 0x58, 0xef, 0xbb, 0x47, 0x03, 0xb5,
+  0x99, 0x85, 0x78, 0xfb, 0x6c, 0xdc, 0x51, 0xe5, 0x5f, 0x59, 0xed, 0x42, 0x20, 0xad, 0x8f, 0x27, 0x7c, 0x62, 0xf3, 0xec,
+  0xbb, 0x8c, 0x7d, 0xbd, 0xa0, 0x35, 0xf8, 0xad, 0x69, 0xaf, 0x3b, 0x46, 0x56, 0xda, 0x77, 0x03, 0xcf, 0x5f, 0xe0, 0xd0,
+  0x29, 0x50, 0xde, 0x32, 0x53, 0x11, 0xfe, 0x5d, 0x58, 0x0a, 0xa5, 0xd1, 0xd2, 0x96, 0xee, 0xa2, 0x1d, 0xf0, 0x38, 0x78,
+  0x4d, 0xab, 0x0f, 0x7f, 0xe1, 0x4c, 0x4d, 0x4c, 0x93, 0x7f, 0x1f, 0xf2, 0xe8, 0x36, 0x1c, 0x90, 0xea, 0x3b, 0x9c, 0x6e,
+  0x81, 0x1f, 0x4e, 0x4f, 0x2e, 0x3b, 0xe1, 0xbd, 0xce, 0x31, 0x0c, 0x2f, 0xef, 0xee, 0x70, 0x2a, 0x54, 0x4a, 0x43, 0x8c,
+  0x83, 0x99, 0xe0, 0x48, 0xfe, 0x77, 0x1f, 0xb0, 0xd0, 0xfc, 0xf0, 0x13, 0x10, 0x64, 0x80, 0x59, 0xfe, 0x8b, 0x49, 0xf8,
+  0x31, 0xf1, 0x1f, 0x89, 0x49, 0xdf, 0x7f, 0xbe, 0xfa, 0xee, 0x8f, 0xdc, 0x3f, 0x06, 0x05, 0xc0, 0x28, 0xd9, 0x09, 0x00,
+  0x00
+};
+
+static const size_t tamanho_resposta_pagina = sizeof(resposta_pagina);
@@ -0,0 +1,343 @@
+#include "painel.h"
+#include "transportes.h"
+
+#if TIX_WIFI
+
+#include "pagina_web.h"
+#include "telemetria.h"
+#include "regras.h"
+#include "registro.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <atomic>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#define SEM_SINAL 0
+#else
+#include <sys/socket.h>
+#define SEM_SINAL MSG_NOSIGNAL //Um espectador que fechou não derruba o simulador com SIGPIPE
+#endif
+
+//Respostas fixas, também na flash
+static const char resposta_eventos[] = "HTTP/1.1 200 OK\r\n"
+                                       "Content-Type: text/event-stream\r\n"
+                                       "Cache-Control: no-cache\r\n"
+                                       "Connection: keep-alive\r\n"
+                                       "\r\n"
+                                       "retry: 2000\n\n";
+static const char resposta_nao_encontrado[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+static const char resposta_ocupado[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+enum EstadoConexaoPainel : uint8_t
+{
+  CONEXAO_LIVRE,
+  CONEXAO_PEDIDO, //Esperando a linha do pedido
+  CONEXAO_RESPOSTA, //Enviando uma resposta fixa, direto da flash
+  CONEXAO_EVENTOS //Espectador: recebe cada evento
+};
+
+struct ConexaoPainel
+{
+  WiFiClient cliente;
+  uint8_t estado;
+  bool espectador; //Depois da resposta: os eventos, em vez de fechar
+  uint32_t inicio_ms;
+  const uint8_t *resposta;
+  size_t tamanho_resposta;
+  size_t enviados;
+  char pedido[TAMANHO_PEDIDO_PAINEL];
+  uint8_t tamanho_pedido;
+};
+
+struct EstatisticasPainel
+{
+  uint32_t paginas;
+  uint32_t recusadas; //Com todas as conexões ocupadas
+  uint32_t descartados; //Espectadores lentos demais para um evento
+  uint32_t envios; //Eventos, cada um para todos os espectadores
+  uint32_t envios_espectador; //Soma dos espectadores de cada envio
+  uint32_t ultimo_ciclos;
+  uint32_t maximo_ciclos;
+  uint64_t total_ciclos;
+  uint8_t maximo_espectadores;
+};
+
+static WiFiServer servidor_painel(PORTA_PAINEL, MAXIMO_CONEXOES_PAINEL + 1); //Uma a mais, para responder 503
+static ConexaoPainel conexoes[MAXIMO_CONEXOES_PAINEL];
+static EstatisticasPainel estatisticas;
+
+static std::atomic<bool> painel_pedido{false};
+static bool painel_aberto = false;
+
+//O último evento enviado
+static EstadoTelemetria enviado;
+static char fen_enviada[TAMANHO_FEN] = "";
+static uint32_t instante_evento_ms = 0;
+static bool novo_espectador = false;
+
+void LigaPainel(bool ligado)
+{
+  painel_pedido.store(ligado, std::memory_order_relaxed);
+}
+
+//Bytes aceitos pelo socket, sem esperar; -1 com a conexão perdida
+static long Envia(ConexaoPainel &conexao, const void *dados, size_t tamanho)
+{
+  long enviados = send(conexao.cliente.fd(), dados, tamanho, MSG_DONTWAIT | SEM_SINAL);
+
+  if(enviados < 0)
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+  return enviados;
+}
+
+static void Fecha(ConexaoPainel &conexao)
+{
+  conexao.cliente.stop();
+  conexao.estado = CONEXAO_LIVRE;
+}
+
+static void Responde(ConexaoPainel &conexao, const void *resposta, size_t tamanho, bool espectador)
+{
+  conexao.estado = CONEXAO_RESPOSTA;
+  conexao.resposta = (const uint8_t *)resposta;
+  conexao.tamanho_resposta = tamanho;
+  conexao.enviados = 0;
+  conexao.espectador = espectador;
+}
+
+//Só o caminho importa: "GET /eventos HTTP/1.1"
+static void AtendePedido(ConexaoPainel &conexao)
+{
+  char *caminho = strchr(conexao.pedido, ' ');
+  char *fim = caminho ? strchr(caminho + 1, ' ') : nullptr;
+
+  if(fim)
+    *fim = '\0';
+
+  if(strncmp(conexao.pedido, "GET ", 4) != 0 || !caminho)
+    Responde(conexao, resposta_nao_encontrado, sizeof(resposta_nao_encontrado) - 1, false);
+  else if(strcmp(caminho + 1, "/") == 0 || strcmp(caminho + 1, "/index.html") == 0)
+  {
+    Responde(conexao, resposta_pagina, tamanho_resposta_pagina, false);
+    estatisticas.paginas++;
+  }
+  else if(strcmp(caminho + 1, "/eventos") == 0)
+    Responde(conexao, resposta_eventos, sizeof(resposta_eventos) - 1, true);
+  else
+    Responde(conexao, resposta_nao_encontrado, sizeof(resposta_nao_encontrado) - 1, false);
+
+  REGISTRA_TEXTO_DEPURACAO("Painel: %s", caminho ? caminho + 1 : conexao.pedido);
+}
+
+//Guarda a linha do pedido e descarta o resto; a entrada é sempre drenada, para que o fechamento não vire um reset
+//que apague a resposta ainda em trânsito
+static bool LeEntrada(ConexaoPainel &conexao)
+{
+  char recebidos[64];
+  long tamanho;
+
+  while((tamanho = recv(conexao.cliente.fd(), recebidos, sizeof(recebidos), MSG_DONTWAIT)) > 0)
+  {
+    for(long i = 0; i < tamanho && conexao.estado == CONEXAO_PEDIDO; i++)
+    {
+      if(recebidos[i] == '\r' || recebidos[i] == '\n' || conexao.tamanho_pedido == TAMANHO_PEDIDO_PAINEL - 1)
+      {
+        conexao.pedido[conexao.tamanho_pedido] = '\0';
+        AtendePedido(conexao);
+      }
+      else
+        conexao.pedido[conexao.tamanho_pedido++] = recebidos[i];
+    }
+  }
+
+  return tamanho < 0 && (errno == EAGAIN || errno == EWOULDBLOCK); //0: o outro lado fechou
+}
+
+static void AceitaConexoes(uint32_t agora_ms)
+{
+  WiFiClient cliente;
+
+  while((cliente = servidor_painel.available()))
+  {
+    ConexaoPainel *livre = nullptr;
+    for(uint8_t i = 0; i < MAXIMO_CONEXOES_PAINEL && !livre; i++)
+      if(conexoes[i].estado == CONEXAO_LIVRE)
+        livre = &conexoes[i];
+
+    if(!livre)
+    {
+      send(cliente.fd(), resposta_ocupado, sizeof(resposta_ocupado) - 1, MSG_DONTWAIT | SEM_SINAL);
+      cliente.stop();
+      estatisticas.recusadas++;
+      continue;
+    }
+
+    livre->cliente = cliente;
+    livre->estado = CONEXAO_PEDIDO;
+    livre->inicio_ms = agora_ms;
+    livre->tamanho_pedido = 0;
+  }
+}
+
+static void AtendeConexao(ConexaoPainel &conexao, uint32_t agora_ms)
+{
+  if(!LeEntrada(conexao))
+  {
+    Fecha(conexao);
+    return;
+  }
+
+  if(conexao.estado == CONEXAO_PEDIDO && agora_ms - conexao.inicio_ms >= TEMPO_LIMITE_PEDIDO_PAINEL_MS)
+    Fecha(conexao);
+  else if(conexao.estado == CONEXAO_RESPOSTA)
+  {
+    long enviados = Envia(conexao, conexao.resposta + conexao.enviados, conexao.tamanho_resposta - conexao.enviados);
+
+    if(enviados < 0)
+      Fecha(conexao);
+    else if((conexao.enviados += enviados) == conexao.tamanho_resposta)
+    {
+      if(!conexao.espectador)
+        Fecha(conexao);
+      else
+      {
+        conexao.estado = CONEXAO_EVENTOS;
+        novo_espectador = true; //Recebe a posição já no próximo evento
+      }
+    }
+  }
+}
+
+//Um evento por mudança de posição, vez, relógio parado ou lance pendente, e pelo menos um por PERIODO_PAINEL_MS
+static void EnviaEventos(uint32_t agora_ms, uint8_t espectadores)
+{
+  EstadoTelemetria estado;
+  char fen[TAMANHO_FEN];
+  uint32_t desde_evento = agora_ms - instante_evento_ms;
+
+  if(!espectadores || desde_evento < INTERVALO_MINIMO_PAINEL_MS || !LeEstadoPublicado(agora_ms, estado))
+    return;
+
+  uint32_t inicio_ciclos = ESP.getCycleCount();
+
+  FormataFen(estado.tabuleiro, estado.vez_brancas, fen);
+  bool mudou = novo_espectador || strcmp(fen, fen_enviada) != 0 || estado.em_partida != enviado.em_partida ||
+               estado.relogio_correndo != enviado.relogio_correndo || estado.lance_pendente != enviado.lance_pendente;
+
+  if(!mudou && desde_evento < PERIODO_PAINEL_MS)
+    return;
+
+  char evento[TAMANHO_EVENTO_PAINEL];
+  int tamanho = snprintf(evento, sizeof(evento),
+                         "data: {\"fen\": \"%s\", \"brancas_ms\": %lu, \"pretas_ms\": %lu, \"correndo\": %d, \"pendente\": %d, \"partida\": %d}\n\n",
+                         fen, (unsigned long)estado.tempo_brancas_ms, (unsigned long)estado.tempo_pretas_ms, estado.relogio_correndo,
+                         estado.lance_pendente, estado.em_partida);
+
+  for(uint8_t i = 0; i < MAXIMO_CONEXOES_PAINEL; i++)
+  {
+    if(conexoes[i].estado != CONEXAO_EVENTOS)
+      continue;
+
+    if(Envia(conexoes[i], evento, tamanho) != tamanho) //Um evento cortado estragaria o fluxo: o navegador reconecta
+    {
+      Fecha(conexoes[i]);
+      estatisticas.descartados++;
+    }
+  }
+
+  uint32_t ciclos = ESP.getCycleCount() - inicio_ciclos;
+
+  estatisticas.envios++;
+  estatisticas.envios_espectador += espectadores;
+  estatisticas.ultimo_ciclos = ciclos;
+  estatisticas.total_ciclos += ciclos;
+  if(ciclos > estatisticas.maximo_ciclos)
+    estatisticas.maximo_ciclos = ciclos;
+  if(espectadores > estatisticas.maximo_espectadores)
+    estatisticas.maximo_espectadores = espectadores;
+
+  enviado = estado;
+  memcpy(fen_enviada, fen, sizeof(fen));
+  instante_evento_ms = agora_ms;
+  novo_espectador = false;
+}
+
+void AtendePainel(uint32_t agora_ms)
+{
+  bool pedido = painel_pedido.load(std::memory_order_relaxed);
+
+  if(pedido != painel_aberto)
+  {
+    painel_aberto = pedido;
+
+    if(pedido)
+      servidor_painel.begin();
+    else
+    {
+      for(uint8_t i = 0; i < MAXIMO_CONEXOES_PAINEL; i++)
+        if(conexoes[i].estado != CONEXAO_LIVRE)
+          Fecha(conexoes[i]);
+      servidor_painel.end();
+      PedePublicacao(false);
+    }
+    REGISTRA_TEXTO_INFO("Painel %s", pedido ? "aberto" : "fechado");
+  }
+
+  if(!painel_aberto)
+    return;
+
+  AceitaConexoes(agora_ms);
+
+  uint8_t espectadores = 0;
+  for(uint8_t i = 0; i < MAXIMO_CONEXOES_PAINEL; i++)
+  {
+    if(conexoes[i].estado != CONEXAO_LIVRE)
+      AtendeConexao(conexoes[i], agora_ms);
+    espectadores += conexoes[i].estado == CONEXAO_EVENTOS;
+  }
+
+  PedePublicacao(espectadores > 0); //Sem espectadores o loop() volta a não publicar nada
+  EnviaEventos(agora_ms, espectadores);
+}
+
+void EscrevePainel(Print &saida)
+{
+  uint8_t conexoes_abertas = 0, espectadores = 0;
+  for(uint8_t i = 0; i < MAXIMO_CONEXOES_PAINEL; i++)
+  {
+    conexoes_abertas += conexoes[i].estado != CONEXAO_LIVRE;
+    espectadores += conexoes[i].estado == CONEXAO_EVENTOS;
+  }
+
+  uint32_t frequencia_mhz = ESP.getCpuFreqMHz();
+  uint32_t media_ciclos = estatisticas.envios ? (uint32_t)(estatisticas.total_ciclos / estatisticas.envios) : 0;
+  uint32_t media_espectador = estatisticas.envios_espectador ? (uint32_t)(estatisticas.total_ciclos / estatisticas.envios_espectador) : 0;
+  char texto[200];
+
+  snprintf(texto, sizeof(texto), "{\"aberto\": %s, \"conexoes\": %u, \"espectadores\": %u, \"maximo_espectadores\": %u, \"paginas\": %lu, ",
+           painel_aberto ? "true" : "false", conexoes_abertas, espectadores, estatisticas.maximo_espectadores,
+           (unsigned long)estatisticas.paginas);
+  saida.print(texto);
+
+  snprintf(texto, sizeof(texto), "\"recusadas\": %lu, \"descartados\": %lu, \"envios\": %lu, \"ciclos\": {\"ultimo\": %lu, \"media\": %lu, ",
+           (unsigned long)estatisticas.recusadas, (unsigned long)estatisticas.descartados, (unsigned long)estatisticas.envios,
+           (unsigned long)estatisticas.ultimo_ciclos, (unsigned long)media_ciclos);
+  saida.print(texto);
+
+  snprintf(texto, sizeof(texto), "\"max\": %lu, \"por_espectador\": %lu}, \"us\": {\"media\": %lu, \"max\": %lu, \"por_espectador\": %lu}}",
+           (unsigned long)estatisticas.maximo_ciclos, (unsigned long)media_espectador, (unsigned long)(media_ciclos / frequencia_mhz),
+           (unsigned long)(estatisticas.maximo_ciclos / frequencia_mhz), (unsigned long)(media_espectador / frequencia_mhz));
+  saida.println(texto);
+}
+
+void LimpaPainel()
+{
+  memset(&estatisticas, 0, sizeof(estatisticas));
+}
+
+#endif
@@ -0,0 +1,27 @@
+//Painel ao vivo: página para espectadores conectados ao ponto de acesso WiFi do tabuleiro
+//
+//Um celular associado ao ponto de acesso abre http://192.168.4.1/ e vê as casas e os dois relógios, sem o host.
+//A página fica pronta na flash (pagina_web.h, gerado por pagina_web.py): a resposta HTTP inteira já comprimida em
+//gzip, enviada como está, sem cópia para a RAM. "GET /eventos" abre um fluxo de Server-Sent Events com a posição e
+//os relógios, lidos do mesmo estado que o loop() publica para a telemetria (telemetria.h).
+//
+//Tudo roda na tarefa de comunicação, com sockets sem bloqueio: um espectador lento que não aceita o evento inteiro
+//é desconectado (o EventSource do navegador reconecta sozinho) e nunca atrasa o rádio do host. Cada evento é
+//formatado uma vez e enviado a todos; o custo em ciclos por envio, e por espectador, é respondido por "?painel".
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+
+#define PORTA_PAINEL 80
+#define MAXIMO_CONEXOES_PAINEL 4 //Páginas sendo enviadas e espectadores, juntos; a próxima recebe 503
+#define PERIODO_PAINEL_MS 1000 //Sem mudança, um evento por período, que também acerta o relógio extrapolado na página
+#define INTERVALO_MINIMO_PAINEL_MS 50 //Entre dois eventos, mesmo com uma mudança de casa ou de vez
+#define TEMPO_LIMITE_PEDIDO_PAINEL_MS 2000 //Para a linha do pedido chegar
+#define TAMANHO_PEDIDO_PAINEL 64 //Só a linha do pedido é guardada; o resto do cabeçalho é descartado
+#define TAMANHO_EVENTO_PAINEL 128 //data: {"fen": "KN1Rr1nk w", "brancas_ms": 4294967295, ...}
+
+void LigaPainel(bool ligado); //Do loop(), junto com o ponto de acesso; a tarefa de comunicação abre ou fecha a porta
+void AtendePainel(uint32_t agora_ms); //Da tarefa de comunicação
+void EscrevePainel(Print &saida); //Resposta JSON do comando "?painel"
+void LimpaPainel();
@@ -0,0 +1,156 @@
+#include "rastreamento.h"
+#include "tarefas.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#endif
+
+#define NUCLEOS 2
+#define LINHAS_RASTREAMENTO (QUANTIDADE_TAREFAS + 1) //As tarefas e os demais contextos (pilhas dos rádios)
+
+struct EventoTrecho
+{
+  const char *nome;
+  uint32_t ciclos;
+  uint16_t voltas; //Quantas vezes o contador de ciclos de 32 bits deu a volta (a cada ~18 s a 240 MHz)
+  char fase;
+  uint8_t tarefa; //TAREFA_... (tarefas.h): os trechos se aninham dentro de cada tarefa, não de cada núcleo
+};
+
+static EventoTrecho eventos[CAPACIDADE_RASTREAMENTO];
+static std::atomic<uint32_t> proximo_evento(0);
+static std::atomic<bool> rastreamento_pausado(false);
+
+//Cada núcleo do ESP32 tem o seu contador de ciclos, então as voltas são contadas por núcleo
+static uint32_t ultimo_ciclo[NUCLEOS];
+static uint16_t voltas_ciclo[NUCLEOS];
+#if defined(ARDUINO_ARCH_ESP32)
+static portMUX_TYPE trava_voltas = portMUX_INITIALIZER_UNLOCKED; //A tarefa de som interrompe o loop() no mesmo núcleo
+#endif
+
+static inline uint8_t NucleoAtual()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  return xPortGetCoreID();
+#else
+  return 0;
+#endif
+}
+
+static inline uint32_t CicloAtual()
+{
+#ifdef TIX_SIMULADOR
+  return micros() * ESP.getCpuFreqMHz(); //No simulador o relógio virtual mostra o tempo estimado no ESP32
+#else
+  return ESP.getCycleCount();
+#endif
+}
+
+static inline uint32_t ProximoEvento()
+{
+#ifdef TIX_SIMULADOR
+  uint32_t indice = proximo_evento.load(std::memory_order_relaxed); //Uma thread só: sem a instrução atômica, que pesa em cada trecho
+  proximo_evento.store(indice + 1, std::memory_order_relaxed);
+  return indice;
+#else
+  return proximo_evento.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+void RegistraTrecho(const char *nome, char fase)
+{
+  if(fase == 'B')
+    EntraFase(nome);
+  else
+    SaiFase();
+
+  if(rastreamento_pausado.load(std::memory_order_relaxed))
+    return;
+
+  uint8_t tarefa = TarefaAtual();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  portENTER_CRITICAL(&trava_voltas);
+#endif
+  uint32_t ciclos = CicloAtual();
+  uint8_t nucleo = NucleoAtual();
+
+  if(ciclos < ultimo_ciclo[nucleo])
+    voltas_ciclo[nucleo]++;
+  ultimo_ciclo[nucleo] = ciclos;
+  uint16_t voltas = voltas_ciclo[nucleo];
+#if defined(ARDUINO_ARCH_ESP32)
+  portEXIT_CRITICAL(&trava_voltas);
+#endif
+
+  EventoTrecho &evento = eventos[ProximoEvento() & (CAPACIDADE_RASTREAMENTO - 1)];
+  evento.nome = nome;
+  evento.ciclos = ciclos;
+  evento.voltas = voltas;
+  evento.fase = fase;
+  evento.tarefa = tarefa;
+}
+
+void LimpaRastreamento()
+{
+  proximo_evento.store(0, std::memory_order_relaxed);
+}
+
+void ExportaRastreamento(Print &saida)
+{
+  rastreamento_pausado.store(true);
+
+  uint32_t total = proximo_evento.load(std::memory_order_relaxed);
+  uint32_t primeiro = total > CAPACIDADE_RASTREAMENTO ? total - CAPACIDADE_RASTREAMENTO : 0;
+  uint32_t frequencia_mhz = ESP.getCpuFreqMHz();
+  uint64_t inicio = 0;
+  unsigned int profundidade[LINHAS_RASTREAMENTO] = {0};
+  bool primeiro_evento = true;
+
+  saida.print("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+  saida.print("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"TiX\"}}");
+  for(uint8_t i = 0; i < LINHAS_RASTREAMENTO; i++)
+  {
+    char linha[96];
+    snprintf(linha, sizeof(linha), ", {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+             i, i < QUANTIDADE_TAREFAS ? ResumeTarefa(i).nome : "outras");
+    saida.print(linha);
+  }
+
+  for(uint32_t i = primeiro; i < total; i++)
+  {
+    const EventoTrecho &evento = eventos[i & (CAPACIDADE_RASTREAMENTO - 1)];
+    uint64_t ciclos = ((uint64_t)evento.voltas << 32) | evento.ciclos;
+
+    //Fins cujo início já foi sobrescrito no buffer confundiriam o visualizador
+    if(evento.fase == 'E')
+    {
+      if(profundidade[evento.tarefa] == 0)
+        continue;
+      profundidade[evento.tarefa]--;
+    }
+    else
+      profundidade[evento.tarefa]++;
+
+    if(primeiro_evento)
+    {
+      inicio = ciclos;
+      primeiro_evento = false;
+    }
+
+    uint64_t ciclos_relativos = ciclos - inicio;
+    char linha[128];
+    snprintf(linha, sizeof(linha), ", {\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %lu.%03lu, \"pid\": 1, \"tid\": %u}",
+             evento.nome, evento.fase, (unsigned long)(ciclos_relativos / frequencia_mhz),
+             (unsigned long)(ciclos_relativos % frequencia_mhz * 1000 / frequencia_mhz), evento.tarefa);
+    saida.print(linha);
+  }
+
+  saida.println("]}");
+
+  rastreamento_pausado.store(false);
+}
@@ -0,0 +1,44 @@
+//Rastreamento de trechos do caminho crítico (captura, validação, ida e volta pelo rádio, LCD e som)
+//
+//INICIA_TRECHO/FINALIZA_TRECHO gravam o nome e o contador de ciclos do processador em um buffer circular fixo na
+//RAM, sobrescrevendo os eventos mais antigos. ExportaRastreamento escreve o buffer no formato trace_event do
+//Chrome (comando "?rastro" pelo Bluetooth ou pela serial), que pode ser aberto em chrome://tracing ou no Perfetto.
+//Cada evento guarda a tarefa que o gravou (tarefas.h) e cada tarefa vira uma linha (tid) no visualizador: os sons
+//tocados pela tarefa de som abrem e fecham trechos durante os delay() deles, intercalados com os do loop().
+//Compilar com TIX_RASTREAMENTO=0 remove o buffer; os trechos continuam marcando as fases do loop() (ciclo.h).
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include "ciclo.h"
+
+#ifndef TIX_RASTREAMENTO
+#define TIX_RASTREAMENTO 1
+#endif
+
+#define CAPACIDADE_RASTREAMENTO 512 //Eventos (início ou fim), potência de 2
+
+#if TIX_RASTREAMENTO
+#define INICIA_TRECHO(nome) RegistraTrecho(nome, 'B')
+#define FINALIZA_TRECHO(nome) RegistraTrecho(nome, 'E')
+#define TRECHO_ESCOPO(nome) TrechoEscopo trecho_escopo(nome) //Finaliza o trecho ao sair do bloco
+#else
+#define INICIA_TRECHO(nome) EntraFase(nome)
+#define FINALIZA_TRECHO(nome) SaiFase()
+#define TRECHO_ESCOPO(nome) FaseEscopo fase_escopo(nome)
+#endif
+
+//O nome deve ser uma string literal (apenas o ponteiro é guardado)
+void RegistraTrecho(const char *nome, char fase);
+void ExportaRastreamento(Print &saida);
+void LimpaRastreamento();
+
+class TrechoEscopo
+{
+  public:
+    explicit TrechoEscopo(const char *nome) : nome(nome) { RegistraTrecho(nome, 'B'); }
+    ~TrechoEscopo() { RegistraTrecho(nome, 'E'); }
+
+  private:
+    const char *nome;
+};
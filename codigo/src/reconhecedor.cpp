@@ -0,0 +1,147 @@
+#include "reconhecedor.h"
+
+static EstadoTabuleiro posicao_inicial = ESTADO_INICIAL;
+static EventoCasa eventos[CAPACIDADE_EVENTOS_LANCE];
+static uint8_t quantidade_eventos = 0;
+static bool eventos_perdidos = false;
+static uint32_t geracao_eventos = 0;
+
+void IniciaReconhecimento(const EstadoTabuleiro &posicao)
+{
+  posicao_inicial = posicao;
+  quantidade_eventos = 0;
+  eventos_perdidos = false;
+  geracao_eventos++;
+}
+
+void RegistraEventoCasa(uint32_t tempo_ms, uint8_t casa, Peca antes, Peca depois)
+{
+  geracao_eventos++;
+
+  if(quantidade_eventos == CAPACIDADE_EVENTOS_LANCE)
+  {
+    eventos_perdidos = true;
+    return;
+  }
+
+  eventos[quantidade_eventos++] = {tempo_ms, casa, antes, depois};
+}
+
+uint32_t GeracaoEventos()
+{
+  return geracao_eventos;
+}
+
+//Posição a que os eventos levam; false se algum evento não parte do que já estava na casa
+static bool RepassaEventos(EstadoTabuleiro &posicao)
+{
+  posicao = posicao_inicial;
+
+  for(uint8_t i = 0; i < quantidade_eventos; i++)
+  {
+    if(eventos[i].casa >= QUANTIDADE_CASAS || posicao[eventos[i].casa] != eventos[i].antes)
+      return false;
+
+    posicao[eventos[i].casa] = eventos[i].depois;
+  }
+
+  return true;
+}
+
+//Casa de cada peça, FORA_DO_TABULEIRO se ela não está na posição; false se a mesma peça estiver em duas casas
+static bool LocalizaPecas(const EstadoTabuleiro &posicao, int8_t casas[QUANTIDADE_PECAS])
+{
+  for(uint8_t peca = 0; peca < QUANTIDADE_PECAS; peca++)
+    casas[peca] = FORA_DO_TABULEIRO;
+
+  for(uint8_t casa = 0; casa < QUANTIDADE_CASAS; casa++)
+  {
+    Peca peca = posicao[casa];
+
+    if(peca == VAZIO)
+      continue;
+    if(peca >= QUANTIDADE_PECAS || casas[peca] != FORA_DO_TABULEIRO)
+      return false;
+
+    casas[peca] = casa;
+  }
+
+  return true;
+}
+
+LanceReconhecido ReconheceLance(const EstadoTabuleiro &lida, bool vez_brancas)
+{
+  LanceReconhecido lance = {LANCE_AMBIGUO, -1, -1, VAZIO, VAZIO, quantidade_eventos, false, 0, 0};
+  EstadoTabuleiro final;
+  int8_t casas_inicio[QUANTIDADE_PECAS];
+  int8_t casas_final[QUANTIDADE_PECAS];
+  bool sumiu_da_vez = false;
+
+  uint32_t primeiro_evento_ms = quantidade_eventos ? eventos[0].tempo_ms : 0;
+
+  for(uint8_t i = 0; i < quantidade_eventos; i++) //Cada evento leva o início da sua mudança: não chegam em ordem
+  {
+    if(eventos[i].tempo_ms < primeiro_evento_ms)
+      primeiro_evento_ms = eventos[i].tempo_ms;
+    if(eventos[i].tempo_ms > lance.ultimo_evento_ms)
+      lance.ultimo_evento_ms = eventos[i].tempo_ms;
+  }
+  lance.duracao_ms = lance.ultimo_evento_ms - primeiro_evento_ms;
+
+  if(eventos_perdidos || !RepassaEventos(final) || final != lida)
+  {
+    final = lida;
+    lance.pelo_retrato = true;
+  }
+
+  if(!LocalizaPecas(posicao_inicial, casas_inicio) || !LocalizaPecas(final, casas_final))
+    return lance;
+
+  for(uint8_t i = 1; i < QUANTIDADE_PECAS; i++)
+  {
+    Peca peca = (Peca)i;
+    bool da_vez = vez_brancas ? PecaBranca(peca) : PecaPreta(peca);
+
+    if(casas_inicio[peca] == casas_final[peca])
+      continue;
+
+    if(casas_inicio[peca] == FORA_DO_TABULEIRO) //Apareceu sem ter saído de casa alguma
+      return lance;
+
+    if(casas_final[peca] == FORA_DO_TABULEIRO)
+    {
+      if(da_vez)
+        sumiu_da_vez = true;
+      else if(lance.capturada == VAZIO)
+        lance.capturada = peca;
+      else
+        return lance; //Duas peças adversárias sumiram
+    }
+    else if(da_vez && lance.peca == VAZIO)
+    {
+      lance.peca = peca;
+      lance.origem = casas_inicio[peca];
+      lance.destino = casas_final[peca];
+    }
+    else
+      return lance; //Segunda peça da vez movida, ou peça adversária movida
+  }
+
+  if(lance.peca == VAZIO)
+  {
+    lance.resultado = sumiu_da_vez ? LANCE_INCOMPLETO : lance.capturada == VAZIO ? SEM_LANCE : LANCE_AMBIGUO;
+    return lance;
+  }
+
+  if(sumiu_da_vez || (lance.capturada != VAZIO && casas_inicio[lance.capturada] != lance.destino))
+    return lance;
+
+  lance.resultado = LANCE_RECONHECIDO;
+  return lance;
+}
+
+const char *NomeResultadoLance(ResultadoLance resultado)
+{
+  static const char *const nomes[] = {"reconhecido", "sem_lance", "incompleto", "ambiguo"};
+  return resultado <= LANCE_AMBIGUO ? nomes[resultado] : "?";
+}
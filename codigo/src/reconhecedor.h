@@ -0,0 +1,61 @@
+//Reconhecimento do lance a partir da sequência de eventos das casas entre dois apertos do relógio
+//
+//Cada troca da peça estável de uma casa (estado_casas.h) vira um evento com o instante, a casa, a peça de antes e a
+//de depois. Os eventos desde o início da vez são repassados sobre a posição daquele momento. Levantar uma peça
+//deixa a casa vazia e a peça na mão; colocar devolve a peça ao tabuleiro. Uma captura rápida, entre duas varreduras,
+//aparece como troca direta de peça. No relógio, cada peça é localizada pela identidade na posição do início e na
+//posição final:
+//- o lance é a única peça da vez que terminou em outra casa;
+//- a única peça adversária que sumiu tem de ter saído da casa de destino (captura);
+//- peças levantadas e devolvidas à mesma casa e casas intermediárias por onde a peça passou não contam.
+//O lance é recusado só quando a sequência não se explica por um lance:
+//- duas peças da vez mudaram de casa;
+//- uma peça adversária mudou de casa ou sumiu fora do destino;
+//- uma peça apareceu sem ter saído de casa alguma;
+//- a mesma peça está em duas casas.
+//Se a fila de eventos encher, ou se os eventos não levarem à posição lida no relógio, vale só a posição lida (retrato
+//antes e depois, como antes).
+//
+//Não depende do Arduino: o simulador repassa sequências de eventos escritas à mão (tix_lances).
+#pragma once
+
+#include <stdint.h>
+#include "tabuleiro.h"
+
+#define CAPACIDADE_EVENTOS_LANCE 32 //Um lance com captura e algumas hesitações passa de dez eventos
+#define FORA_DO_TABULEIRO -1 //Peça na mão do jogador ou capturada
+
+enum ResultadoLance : uint8_t
+{
+  LANCE_RECONHECIDO,
+  SEM_LANCE, //Nenhuma peça mudou de casa (inclusive peça levantada e devolvida)
+  LANCE_INCOMPLETO, //Peça da vez ainda na mão
+  LANCE_AMBIGUO
+};
+
+struct EventoCasa
+{
+  uint32_t tempo_ms;
+  uint8_t casa;
+  Peca antes;
+  Peca depois;
+};
+
+struct LanceReconhecido
+{
+  ResultadoLance resultado;
+  int8_t origem;
+  int8_t destino;
+  Peca peca;
+  Peca capturada; //VAZIO sem captura
+  uint8_t eventos;
+  bool pelo_retrato; //Eventos perdidos ou inconsistentes: só a posição lida no relógio foi usada
+  uint32_t duracao_ms; //Do primeiro ao último evento
+  uint32_t ultimo_evento_ms; //Início da última mudança: a peça chegou à casa ali, antes da confirmação
+};
+
+void IniciaReconhecimento(const EstadoTabuleiro &posicao); //No início de cada vez
+void RegistraEventoCasa(uint32_t tempo_ms, uint8_t casa, Peca antes, Peca depois);
+LanceReconhecido ReconheceLance(const EstadoTabuleiro &lida, bool vez_brancas);
+uint32_t GeracaoEventos(); //Muda a cada evento e a cada IniciaReconhecimento; sem mudança, o lance da mesma posição lida é o mesmo
+const char *NomeResultadoLance(ResultadoLance resultado);
@@ -0,0 +1,180 @@
+#include "registro.h"
+#include "memoria.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+#include <stdio.h>
+
+#define PRIORIDADE_TAREFA_REGISTRO 0 //Mesma prioridade da tarefa ociosa: só escreve quando nada mais precisa da CPU
+#define PERIODO_TAREFA_REGISTRO_MS 20
+
+#define ARGUMENTOS_INTEIROS 0
+#define ARGUMENTO_TEXTO 1
+
+struct RegistroBinario
+{
+  uint32_t tempo_us;
+  const char *formato;
+  uint8_t nivel;
+  uint8_t tipo_argumentos;
+  union
+  {
+    int32_t inteiros[4];
+    char texto[TAMANHO_TEXTO_REGISTRO];
+  };
+};
+
+//Fila circular limitada com um número de sequência por posição: vários produtores (loop(), outras tarefas)
+//reservam posições com compare-and-swap e um único consumidor (a tarefa de registro) as libera
+struct PosicaoRegistro
+{
+  std::atomic<uint32_t> sequencia;
+  RegistroBinario registro;
+};
+
+static PosicaoRegistro posicoes[CAPACIDADE_REGISTRO];
+static std::atomic<uint32_t> posicao_escrita(0);
+static uint32_t posicao_leitura = 0;
+static std::atomic<uint32_t> registros_descartados(0);
+static uint32_t descartados_informados = 0;
+
+static const char niveis[] = {'D', 'I', 'A', 'E'};
+
+static RegistroBinario *ReservaPosicao(uint32_t &posicao)
+{
+  posicao = posicao_escrita.load(std::memory_order_relaxed);
+
+  while(true)
+  {
+    PosicaoRegistro &candidata = posicoes[posicao & (CAPACIDADE_REGISTRO - 1)];
+    int32_t diferenca = (int32_t)(candidata.sequencia.load(std::memory_order_acquire) - posicao);
+
+    if(diferenca == 0)
+    {
+      if(posicao_escrita.compare_exchange_weak(posicao, posicao + 1, std::memory_order_relaxed))
+        return &candidata.registro;
+    }
+    else if(diferenca < 0) //Buffer cheio: o consumidor ainda não liberou esta posição
+    {
+      registros_descartados.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    else
+      posicao = posicao_escrita.load(std::memory_order_relaxed);
+  }
+}
+
+static void PublicaPosicao(uint32_t posicao)
+{
+  posicoes[posicao & (CAPACIDADE_REGISTRO - 1)].sequencia.store(posicao + 1, std::memory_order_release);
+}
+
+void Registra(uint8_t nivel, const char *formato, int32_t a, int32_t b, int32_t c, int32_t d)
+{
+  uint32_t posicao;
+  RegistroBinario *registro = ReservaPosicao(posicao);
+
+  if(!registro)
+    return;
+
+  registro->tempo_us = micros();
+  registro->formato = formato;
+  registro->nivel = nivel;
+  registro->tipo_argumentos = ARGUMENTOS_INTEIROS;
+  registro->inteiros[0] = a;
+  registro->inteiros[1] = b;
+  registro->inteiros[2] = c;
+  registro->inteiros[3] = d;
+
+  PublicaPosicao(posicao);
+}
+
+void RegistraTexto(uint8_t nivel, const char *formato, const char *texto)
+{
+  uint32_t posicao;
+  RegistroBinario *registro = ReservaPosicao(posicao);
+
+  if(!registro)
+    return;
+
+  registro->tempo_us = micros();
+  registro->formato = formato;
+  registro->nivel = nivel;
+  registro->tipo_argumentos = ARGUMENTO_TEXTO;
+  strncpy(registro->texto, texto, TAMANHO_TEXTO_REGISTRO - 1);
+  registro->texto[TAMANHO_TEXTO_REGISTRO - 1] = '\0';
+
+  PublicaPosicao(posicao);
+}
+
+unsigned int DrenaRegistro(Print &saida)
+{
+  unsigned int escritos = 0;
+  char linha[128];
+
+  while(true)
+  {
+    PosicaoRegistro &atual = posicoes[posicao_leitura & (CAPACIDADE_REGISTRO - 1)];
+
+    if(atual.sequencia.load(std::memory_order_acquire) != posicao_leitura + 1)
+      break;
+
+    const RegistroBinario &registro = atual.registro;
+    int tamanho = snprintf(linha, sizeof(linha), "[%6lu.%06lu] %c ", (unsigned long)(registro.tempo_us / 1000000),
+                           (unsigned long)(registro.tempo_us % 1000000), niveis[registro.nivel]);
+
+    //Os inteiros que o formato não usa são ignorados pelo snprintf
+    if(registro.tipo_argumentos == ARGUMENTO_TEXTO)
+      snprintf(linha + tamanho, sizeof(linha) - tamanho, registro.formato, registro.texto);
+    else
+      snprintf(linha + tamanho, sizeof(linha) - tamanho, registro.formato, registro.inteiros[0], registro.inteiros[1],
+               registro.inteiros[2], registro.inteiros[3]);
+
+    atual.sequencia.store(posicao_leitura + CAPACIDADE_REGISTRO, std::memory_order_release);
+    posicao_leitura++;
+
+    saida.println(linha);
+    escritos++;
+  }
+
+  uint32_t descartados = registros_descartados.load(std::memory_order_relaxed);
+  if(descartados != descartados_informados)
+  {
+    snprintf(linha, sizeof(linha), "[registro] %lu registros descartados (buffer cheio)", (unsigned long)(descartados - descartados_informados));
+    saida.println(linha);
+    descartados_informados = descartados;
+  }
+
+  return escritos;
+}
+
+uint32_t RegistrosDescartados()
+{
+  return registros_descartados.load(std::memory_order_relaxed);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+static void TarefaRegistro(void *parametro)
+{
+  while(true)
+  {
+    DrenaRegistro(Serial);
+    vTaskDelay(pdMS_TO_TICKS(PERIODO_TAREFA_REGISTRO_MS));
+  }
+}
+
+#endif
+
+void IniciaRegistro()
+{
+  for(uint32_t i = 0; i < CAPACIDADE_REGISTRO; i++)
+    posicoes[i].sequencia.store(i, std::memory_order_relaxed);
+
+#if defined(ARDUINO_ARCH_ESP32)
+  TaskHandle_t tarefa;
+  if(xTaskCreate(TarefaRegistro, "registro", 3072, NULL, PRIORIDADE_TAREFA_REGISTRO, &tarefa) == pdPASS)
+    MonitoraPilhaTarefa("registro", tarefa);
+#endif
+}
@@ -0,0 +1,64 @@
+//Registro (log) de depuração assíncrono
+//
+//As macros REGISTRA_* gravam um registro binário (instante, nível, ponteiro para o formato e até quatro inteiros ou
+//um texto curto) em um buffer circular sem travas. A formatação e a escrita na serial acontecem depois, em uma
+//tarefa de baixa prioridade, de forma que o loop() não espera pelos 9600 baud da serial. Se o buffer encher o
+//registro é descartado e contado. Níveis abaixo de NIVEL_REGISTRO não geram código algum (nem avaliam argumentos).
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+#define REGISTRO_DEPURACAO 0
+#define REGISTRO_INFO 1
+#define REGISTRO_AVISO 2
+#define REGISTRO_ERRO 3
+#define REGISTRO_NENHUM 4
+
+#ifndef NIVEL_REGISTRO
+#define NIVEL_REGISTRO REGISTRO_INFO
+#endif
+
+#define CAPACIDADE_REGISTRO 64 //Potência de 2
+#define TAMANHO_TEXTO_REGISTRO 24
+
+//O formato segue o printf e deve ser uma string literal (apenas o ponteiro é guardado)
+#if NIVEL_REGISTRO <= REGISTRO_DEPURACAO
+#define REGISTRA_DEPURACAO(formato, ...) Registra(REGISTRO_DEPURACAO, formato, ##__VA_ARGS__)
+#define REGISTRA_TEXTO_DEPURACAO(formato, texto) RegistraTexto(REGISTRO_DEPURACAO, formato, texto)
+#else
+#define REGISTRA_DEPURACAO(formato, ...) do {} while(0)
+#define REGISTRA_TEXTO_DEPURACAO(formato, texto) do {} while(0)
+#endif
+
+#if NIVEL_REGISTRO <= REGISTRO_INFO
+#define REGISTRA_INFO(formato, ...) Registra(REGISTRO_INFO, formato, ##__VA_ARGS__)
+#define REGISTRA_TEXTO_INFO(formato, texto) RegistraTexto(REGISTRO_INFO, formato, texto)
+#else
+#define REGISTRA_INFO(formato, ...) do {} while(0)
+#define REGISTRA_TEXTO_INFO(formato, texto) do {} while(0)
+#endif
+
+#if NIVEL_REGISTRO <= REGISTRO_AVISO
+#define REGISTRA_AVISO(formato, ...) Registra(REGISTRO_AVISO, formato, ##__VA_ARGS__)
+#define REGISTRA_TEXTO_AVISO(formato, texto) RegistraTexto(REGISTRO_AVISO, formato, texto)
+#else
+#define REGISTRA_AVISO(formato, ...) do {} while(0)
+#define REGISTRA_TEXTO_AVISO(formato, texto) do {} while(0)
+#endif
+
+#if NIVEL_REGISTRO <= REGISTRO_ERRO
+#define REGISTRA_ERRO(formato, ...) Registra(REGISTRO_ERRO, formato, ##__VA_ARGS__)
+#else
+#define REGISTRA_ERRO(formato, ...) do {} while(0)
+#endif
+
+//Verdadeiro em tempo de compilação se o nível gera registros, para blocos que só preparam dados para o registro
+#define REGISTRO_HABILITADO(nivel) ((nivel) >= NIVEL_REGISTRO)
+
+void IniciaRegistro(); //Cria a tarefa que esvazia o buffer na serial (no simulador quem esvazia é o programa principal)
+void Registra(uint8_t nivel, const char *formato, int32_t a = 0, int32_t b = 0, int32_t c = 0, int32_t d = 0);
+void RegistraTexto(uint8_t nivel, const char *formato, const char *texto);
+unsigned int DrenaRegistro(Print &saida); //Formata e escreve os registros pendentes, devolve quantos foram escritos
+uint32_t RegistrosDescartados();
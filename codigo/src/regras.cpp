@@ -0,0 +1,130 @@
+#include "regras.h"
+
+static bool PecaDaCor(Peca peca, bool brancas)
+{
+  return brancas ? PecaBranca(peca) : PecaPreta(peca);
+}
+
+static bool MovimentoPermitido(const EstadoTabuleiro &posicao, int origem, int destino)
+{
+  int distancia = destino > origem ? destino - origem : origem - destino;
+
+  switch(posicao[origem])
+  {
+    case REI_BRANCAS:
+    case REI_PRETAS:
+      return distancia == 1;
+
+    case CAVALO_BRANCAS:
+    case CAVALO_PRETAS:
+      return distancia == 2;
+
+    case TORRE_BRANCAS:
+    case TORRE_PRETAS:
+    {
+      int passo = destino > origem ? 1 : -1;
+
+      if(distancia == 0)
+        return false;
+
+      for(int i = origem + passo; i != destino; i += passo)
+        if(posicao[i] != VAZIO)
+          return false;
+
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+bool ReiAtacado(const EstadoTabuleiro &posicao, bool brancas)
+{
+  Peca rei = brancas ? REI_BRANCAS : REI_PRETAS;
+  int casa_rei = -1;
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    if(posicao[i] == rei)
+      casa_rei = i;
+
+  if(casa_rei < 0)
+    return false;
+
+  EstadoTabuleiro sem_rei = posicao; //Como no main.py, o caminho do atacante é conferido sem o rei
+  sem_rei[casa_rei] = VAZIO;
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    if(PecaDaCor(posicao[i], !brancas) && MovimentoPermitido(sem_rei, i, casa_rei))
+      return true;
+
+  return false;
+}
+
+bool LanceLegal(const EstadoTabuleiro &posicao, int origem, int destino)
+{
+  if(origem < 0 || origem >= QUANTIDADE_CASAS || destino < 0 || destino >= QUANTIDADE_CASAS || posicao[origem] == VAZIO)
+    return false;
+
+  bool brancas = PecaBranca(posicao[origem]);
+
+  if(PecaDaCor(posicao[destino], brancas) || !MovimentoPermitido(posicao, origem, destino))
+    return false;
+
+  EstadoTabuleiro depois = posicao;
+  depois[destino] = depois[origem];
+  depois[origem] = VAZIO;
+
+  return !ReiAtacado(depois, brancas);
+}
+
+bool ExisteLanceLegal(const EstadoTabuleiro &posicao, bool brancas)
+{
+  for(int origem = 0; origem < QUANTIDADE_CASAS; origem++)
+    if(PecaDaCor(posicao[origem], brancas))
+      for(int destino = 0; destino < QUANTIDADE_CASAS; destino++)
+        if(LanceLegal(posicao, origem, destino))
+          return true;
+
+  return false;
+}
+
+bool PosicaoLegal(const EstadoTabuleiro &posicao, bool vez_brancas)
+{
+  uint8_t quantidade[QUANTIDADE_PECAS] = {};
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+    if(posicao[i] >= QUANTIDADE_PECAS || (posicao[i] != VAZIO && ++quantidade[posicao[i]] > 1))
+      return false;
+
+  if(quantidade[REI_BRANCAS] != 1 || quantidade[REI_PRETAS] != 1)
+    return false;
+
+  return !ReiAtacado(posicao, !vez_brancas) && ExisteLanceLegal(posicao, vez_brancas); //Quem não joga não pode estar em xeque
+}
+
+void FormataFen(const EstadoTabuleiro &posicao, bool vez_brancas, char destino[TAMANHO_FEN])
+{
+  uint8_t tamanho = 0, vazias = 0;
+
+  for(int i = 0; i < QUANTIDADE_CASAS; i++)
+  {
+    if(posicao[i] == VAZIO)
+    {
+      vazias++;
+      continue;
+    }
+
+    if(vazias > 0)
+      destino[tamanho++] = '0' + vazias;
+    vazias = 0;
+    destino[tamanho++] = LetraPeca(posicao[i]);
+  }
+
+  if(vazias > 0)
+    destino[tamanho++] = '0' + vazias;
+
+  destino[tamanho++] = ' ';
+  destino[tamanho++] = vez_brancas ? 'w' : 'b';
+  destino[tamanho] = '\0';
+}
@@ -0,0 +1,22 @@
+//Regras do xadrez 1D no tabuleiro, as mesmas do main.py (movement_rules, legal_move, is_king_attacked)
+//
+//Rei anda uma casa, cavalo salta duas e torre anda quantas casas quiser sem pular peças; nenhum lance pode deixar o
+//próprio rei atacado. O host continua sendo quem valida o lance e decide o fim da partida: estas funções servem para
+//o tabuleiro não enviar sozinho (lance automático) um lance que o host vai recusar, nem propor como início de partida
+//uma posição que não pode ser jogada.
+//
+//A posição é passada ao host num formato parecido com o FEN, com as letras de LetraPeca: as oito casas da 0 à 7,
+//maiúsculas para as brancas, minúsculas para as pretas e algarismos para casas vazias seguidas, depois a cor da vez
+//("w" ou "b"). A posição inicial é "KNR2rnk w".
+#pragma once
+
+#include <stdint.h>
+#include "tabuleiro.h"
+
+#define TAMANHO_FEN (QUANTIDADE_CASAS + 3) //Casas, espaço, cor da vez e '\0'
+
+bool LanceLegal(const EstadoTabuleiro &posicao, int origem, int destino);
+bool ReiAtacado(const EstadoTabuleiro &posicao, bool brancas);
+bool ExisteLanceLegal(const EstadoTabuleiro &posicao, bool brancas);
+bool PosicaoLegal(const EstadoTabuleiro &posicao, bool vez_brancas); //Um rei de cada cor, sem peças repetidas, jogável
+void FormataFen(const EstadoTabuleiro &posicao, bool vez_brancas, char destino[TAMANHO_FEN]);
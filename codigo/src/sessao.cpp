@@ -0,0 +1,135 @@
+#include "sessao.h"
+#include "regras.h"
+#include "registro.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_system.h>
+#endif
+
+static EventoSessao eventos[CAPACIDADE_EVENTOS_SESSAO]; //Circular: o evento mais antigo é sobrescrito
+static uint8_t inicio = 0;
+static uint8_t quantidade = 0;
+static uint32_t identificador_sessao = 0;
+static uint32_t sequencia = 0; //Da última mensagem enviada
+static uint32_t sequencia_descartada = 0; //Do evento mais novo que já saiu do buffer, 0 se nenhum saiu
+
+static const char *const nomes_eventos[] = {"inicio", "lance", "desfaz", "refaz", "fim"};
+
+static uint32_t NovoIdentificador()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  uint32_t identificador = esp_random();
+#else
+  uint32_t identificador = identificador_sessao * 2654435761u + 0x9E3779B9u; //Determinístico no simulador
+#endif
+
+  identificador &= 0x7FFFFFFF; //Cabe num inteiro com sinal do lado do host
+  return identificador ? identificador : 1;
+}
+
+static const EventoSessao &Evento(uint8_t posicao)
+{
+  return eventos[(inicio + posicao) % CAPACIDADE_EVENTOS_SESSAO];
+}
+
+void IniciaSessao(const EstadoTabuleiro &posicao, uint16_t tempo_configurado)
+{
+  identificador_sessao = NovoIdentificador();
+  inicio = 0;
+  quantidade = 0;
+  sequencia = 0;
+  sequencia_descartada = 0;
+
+  ProximaSequenciaSessao();
+  RegistraEventoSessao(EVENTO_INICIO, -1, -1, '0', posicao, true, tempo_configurado * 1000UL, tempo_configurado * 1000UL, 0);
+  REGISTRA_INFO("Sessao %d iniciada", (int32_t)identificador_sessao);
+}
+
+uint32_t ProximaSequenciaSessao()
+{
+  return ++sequencia;
+}
+
+void RegistraEventoSessao(uint8_t tipo, int origem, int destino, char resultado, const EstadoTabuleiro &posicao, bool vez_brancas,
+                          uint32_t tempo_brancas_ms, uint32_t tempo_pretas_ms, uint32_t pensamento_ms)
+{
+  if(quantidade == CAPACIDADE_EVENTOS_SESSAO)
+  {
+    sequencia_descartada = eventos[inicio].sequencia;
+    inicio = (inicio + 1) % CAPACIDADE_EVENTOS_SESSAO;
+    quantidade--;
+  }
+
+  EventoSessao &evento = eventos[(inicio + quantidade++) % CAPACIDADE_EVENTOS_SESSAO];
+  evento.sequencia = sequencia;
+  evento.tipo = tipo;
+  evento.origem = (int8_t)origem;
+  evento.destino = (int8_t)destino;
+  evento.resultado = resultado;
+  evento.tempo_brancas_ms = tempo_brancas_ms;
+  evento.tempo_pretas_ms = tempo_pretas_ms;
+  evento.pensamento_ms = pensamento_ms;
+  evento.posicao = posicao;
+  evento.vez_brancas = vez_brancas;
+}
+
+uint32_t IdentificadorSessao()
+{
+  return identificador_sessao;
+}
+
+static unsigned long SegundosRelogio(uint32_t tempo_ms) //Como o relógio mostra: o segundo corrente ainda não foi descontado
+{
+  return (tempo_ms + 999) / 1000;
+}
+
+//Os relógios em segundos vêm antes da posição, como antes; os campos em ms vão no fim
+static void EscreveEvento(const EventoSessao &evento, bool primeiro, Print &saida)
+{
+  char fen[TAMANHO_FEN];
+  char texto[128];
+
+  FormataFen(evento.posicao, evento.vez_brancas, fen);
+  snprintf(texto, sizeof(texto), "%s[%lu, \"%s\", %d, %d, %d, %lu, %lu, \"%s\", %lu, %lu, %lu]", primeiro ? "" : ", ",
+           (unsigned long)evento.sequencia, nomes_eventos[evento.tipo], evento.origem, evento.destino, evento.resultado - '0',
+           SegundosRelogio(evento.tempo_brancas_ms), SegundosRelogio(evento.tempo_pretas_ms), fen, (unsigned long)evento.tempo_brancas_ms,
+           (unsigned long)evento.tempo_pretas_ms, (unsigned long)evento.pensamento_ms);
+  saida.print(texto);
+}
+
+void RetomaSessao(const char *argumentos, Print &saida)
+{
+  char *fim;
+  unsigned long sessao = strtoul(argumentos, &fim, 10);
+  unsigned long ultima = strtoul(fim, nullptr, 10);
+
+  if(sessao != identificador_sessao) //Outra sessão, ou o host ainda não tem nenhuma: tudo desde o início
+    ultima = 0;
+
+  bool completo = ultima >= sequencia_descartada;
+  char texto[80];
+
+  snprintf(texto, sizeof(texto), "{\"sessao\": %lu, \"seq\": %lu, \"completo\": %s, \"eventos\": [",
+           (unsigned long)identificador_sessao, (unsigned long)sequencia, completo ? "true" : "false");
+  saida.print(texto);
+
+  if(!completo) //Só o último evento, com a posição e os relógios de agora
+    EscreveEvento(Evento(quantidade - 1), true, saida);
+  else
+  {
+    bool primeiro = true;
+    for(uint8_t i = 0; i < quantidade; i++)
+    {
+      if(Evento(i).sequencia <= ultima)
+        continue;
+      EscreveEvento(Evento(i), primeiro, saida);
+      primeiro = false;
+    }
+  }
+
+  saida.println("]}");
+  REGISTRA_INFO("Sessao retomada a partir de %d (completa: %d)", (int32_t)ultima, completo);
+}
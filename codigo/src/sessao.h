@@ -0,0 +1,44 @@
+//Sessão da partida com o host: identificador, número de sequência e eventos para retomar depois de uma reconexão
+//
+//Cada partida abre uma sessão com um identificador novo. Toda mensagem de partida enviada ao host (lance, desfazer,
+//refazer) leva o número de sequência seguinte, que só cresce dentro da sessão; os eventos que mudam a partida
+//(início, lance aceito, lance desfeito ou refeito, fim por tempo) ficam num buffer circular com a posição e os dois
+//relógios depois deles, em ms, e o tempo que a vez levou. Lances recusados consomem um número mas não viram evento.
+//
+//Quando o host reconecta, por qualquer transporte, ele envia "?retoma <sessao> <ultima_seq>" e recebe numa só
+//resposta os eventos que perdeu. Se a sessão é outra, recebe a sessão desde o início; se os eventos que faltam já
+//saíram do buffer, recebe só o último, com "completo": false, e recomeça daquela posição.
+#pragma once
+
+#include <stdint.h>
+#include <Print.h>
+#include "tabuleiro.h"
+
+#define CAPACIDADE_EVENTOS_SESSAO 32 //32 bytes por evento
+
+#define EVENTO_INICIO 0
+#define EVENTO_LANCE 1
+#define EVENTO_DESFAZ 2
+#define EVENTO_REFAZ 3
+#define EVENTO_FIM 4 //Tempo esgotado; um lance que termina a partida é EVENTO_LANCE com o resultado
+
+struct EventoSessao
+{
+  uint32_t sequencia;
+  uint8_t tipo;
+  int8_t origem; //-1 em eventos sem lance
+  int8_t destino;
+  char resultado; //Mesmo código do host: '0' continua, '1' brancas, '2' pretas, '3' empate
+  uint32_t tempo_brancas_ms; //Relógios depois do evento, com a fração do segundo do relógio da vez
+  uint32_t tempo_pretas_ms;
+  uint32_t pensamento_ms; //Da vez encerrada pelo lance ou pelo tempo esgotado; 0 nos outros eventos
+  EstadoTabuleiro posicao; //Depois do evento
+  bool vez_brancas;
+};
+
+void IniciaSessao(const EstadoTabuleiro &posicao, uint16_t tempo_configurado); //Partida nova: sessão nova e o evento de início
+uint32_t ProximaSequenciaSessao(); //Número da próxima mensagem ao host
+void RegistraEventoSessao(uint8_t tipo, int origem, int destino, char resultado, const EstadoTabuleiro &posicao, bool vez_brancas,
+                          uint32_t tempo_brancas_ms, uint32_t tempo_pretas_ms, uint32_t pensamento_ms); //Com o número da última mensagem enviada
+uint32_t IdentificadorSessao(); //0 antes da primeira partida
+void RetomaSessao(const char *argumentos, Print &saida); //Resposta JSON do comando "?retoma <sessao> <ultima_seq>"
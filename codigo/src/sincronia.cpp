@@ -0,0 +1,71 @@
+#include "sincronia.h"
+
+#include <Arduino.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#endif
+
+#define TAMANHO_MAXIMO_INSTANTE_HOST 20
+
+uint64_t RelogioTabuleiroUs()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  return (uint64_t)esp_timer_get_time();
+#else
+  static uint32_t anterior = 0;
+  static uint64_t voltas = 0;
+
+  uint32_t agora = micros();
+  if(agora < anterior)
+    voltas += 1ULL << 32;
+  anterior = agora;
+
+  return voltas | agora;
+#endif
+}
+
+//A printf do newlib do ESP32 nem sempre tem %llu: segundos e microssegundos separados, cada um num unsigned long
+void FormataMicros(uint64_t micros, char *destino, size_t tamanho)
+{
+  unsigned long segundos = (unsigned long)(micros / 1000000);
+  unsigned long resto = (unsigned long)(micros % 1000000);
+
+  if(segundos)
+    snprintf(destino, tamanho, "%lu%06lu", segundos, resto);
+  else
+    snprintf(destino, tamanho, "%lu", resto);
+}
+
+void RespondeRelogio(const char *argumentos, uint64_t chegada_us, Print &saida)
+{
+  //t1 volta como veio: o tabuleiro não precisa entender o relógio do host
+  char instante_host[TAMANHO_MAXIMO_INSTANTE_HOST + 1];
+  size_t tamanho = 0;
+
+  while(isdigit((unsigned char)argumentos[tamanho]) && tamanho < TAMANHO_MAXIMO_INSTANTE_HOST)
+  {
+    instante_host[tamanho] = argumentos[tamanho];
+    tamanho++;
+  }
+  if(tamanho == 0)
+    instante_host[tamanho++] = '0';
+  instante_host[tamanho] = '\0';
+
+  char chegada[TAMANHO_TEXTO_MICROS];
+  char resposta[TAMANHO_TEXTO_MICROS];
+  char texto[96];
+
+  FormataMicros(chegada_us, chegada, sizeof(chegada));
+  FormataMicros(RelogioTabuleiroUs(), resposta, sizeof(resposta)); //O mais perto possível da escrita
+  snprintf(texto, sizeof(texto), "{\"relogio\": [%s, %s, %s]}", instante_host, chegada, resposta);
+  saida.println(texto);
+}
+
+void RespondeRelogioComando(const char *argumentos, Print &saida)
+{
+  RespondeRelogio(argumentos, RelogioTabuleiroUs(), saida);
+}
@@ -0,0 +1,25 @@
+//Sincronia do relógio do tabuleiro com o do host, no estilo do NTP
+//
+//O host envia "?relogio <t1>", com t1 o instante do envio no relógio dele, e recebe {"relogio": [t1, t2, t3]}: t2 é
+//o instante em que o comando chegou e t3 o da resposta, em microssegundos de RelogioTabuleiroUs(). Com t4, o
+//instante em que a resposta chegou, o host tem a diferença entre os relógios, ((t2 - t1) + (t3 - t4)) / 2, e o
+//atraso da ida e volta, (t4 - t1) - (t3 - t2). Repetindo a troca, ele fica com as amostras de menor atraso e estima
+//também a deriva entre os dois cristais.
+//
+//No ESP32 o comando é respondido pela própria tarefa de comunicação, sem passar pela fila do loop(): t2 é o período
+//da tarefa em que o comando foi lido (até PERIODO_TAREFA_COMUNICACAO_MS depois de chegar, o que aparece como atraso
+//e é filtrado pelo host). Os lances e os eventos do relógio levam instantes do mesmo relógio, que o host converte
+//para o dele.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+
+#define COMANDO_RELOGIO "?relogio"
+#define TAMANHO_TEXTO_MICROS 21 //18446744073709551615 e o '\0'
+
+uint64_t RelogioTabuleiroUs(); //Microssegundos desde o boot, sem a volta de ~71 min do micros()
+void FormataMicros(uint64_t micros, char *destino, size_t tamanho); //Em decimal, sem o %llu
+void RespondeRelogio(const char *argumentos, uint64_t chegada_us, Print &saida);
+void RespondeRelogioComando(const char *argumentos, Print &saida); //Sem a tarefa: chegada e resposta no mesmo instante
@@ -0,0 +1,47 @@
+//Peças e casas do tabuleiro do TiX (uma fileira de oito casas com rei, cavalo e torre de cada cor)
+#pragma once
+
+#include <stdint.h>
+#include <array>
+
+#define QUANTIDADE_CASAS 8
+
+enum Peca : uint8_t
+{
+  VAZIO,
+  REI_BRANCAS,
+  CAVALO_BRANCAS,
+  TORRE_BRANCAS,
+  REI_PRETAS,
+  CAVALO_PRETAS,
+  TORRE_PRETAS,
+  QUANTIDADE_PECAS
+};
+
+typedef std::array<Peca, QUANTIDADE_CASAS> EstadoTabuleiro;
+
+constexpr EstadoTabuleiro ESTADO_INICIAL = {{REI_BRANCAS, CAVALO_BRANCAS, TORRE_BRANCAS, VAZIO, VAZIO, TORRE_PRETAS, CAVALO_PRETAS, REI_PRETAS}};
+
+//Código da peça no protocolo e nas mensagens de depuração: C = Cavalo, R = Rei, T = Torre, V = Vazio, B/P = cor
+inline const char *NomePeca(Peca peca)
+{
+  static const char *const nomes[QUANTIDADE_PECAS] = {"V", "RB", "CB", "TB", "RP", "CP", "TP"};
+  return peca < QUANTIDADE_PECAS ? nomes[peca] : "?";
+}
+
+//Letra da peça no estilo FEN (maiúsculas brancas, minúsculas pretas, '.' vazio), para caber uma fileira em 8 colunas
+inline char LetraPeca(Peca peca)
+{
+  static const char letras[QUANTIDADE_PECAS] = {'.', 'K', 'N', 'R', 'k', 'n', 'r'};
+  return peca < QUANTIDADE_PECAS ? letras[peca] : '?';
+}
+
+inline bool PecaBranca(Peca peca)
+{
+  return peca >= REI_BRANCAS && peca <= TORRE_BRANCAS;
+}
+
+inline bool PecaPreta(Peca peca)
+{
+  return peca >= REI_PRETAS && peca <= TORRE_PRETAS;
+}
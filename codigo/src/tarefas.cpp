@@ -0,0 +1,518 @@
+#include "tarefas.h"
+#include "comandos.h"
+#include "memoria.h"
+#include "registro.h"
+#include "conexao.h"
+#include "telemetria.h"
+#include "sincronia.h"
+#include "painel.h"
+#include "transportes.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/event_groups.h>
+#include <freertos/semphr.h>
+#endif
+
+#define BITS_NIVEL_BOTOES 0x0F //Botões apertados agora, já sem repique
+#define DESLOCAMENTO_APERTOS 4 //Apertos guardados até o próximo EsperaBotoes(), nos 4 bits acima dos níveis
+#define BITS_APERTOS_BOTOES (BITS_NIVEL_BOTOES << DESLOCAMENTO_APERTOS)
+
+struct DescricaoTarefa
+{
+  const char *nome;
+  uint8_t prioridade;
+  int8_t nucleo;
+  uint32_t periodo_ms; //0: tarefa acordada por fila
+  uint32_t pilha; //Bytes
+};
+
+struct EstatisticaTarefa
+{
+  volatile uint32_t ocupado_us; //Acumulado; escrito só pela própria tarefa
+  volatile uint32_t maximo_us;
+  uint32_t ocupado_inicio_janela_us;
+  uint32_t cpu_permil;
+};
+
+struct QuadroRadio
+{
+  char texto[TAMANHO_QUADRO_RADIO + 1];
+  uint8_t tamanho;
+};
+
+static_assert(TAMANHO_QUADRO_RADIO <= UINT8_MAX, "QuadroRadio::tamanho e os índices do quadro são uint8_t");
+
+struct VarreduraCasas
+{
+  uint32_t tempo_ms;
+  uint16_t leituras[QUANTIDADE_CASAS];
+};
+
+static const DescricaoTarefa descricoes[QUANTIDADE_TAREFAS] = {
+  {"loop", 1, NUCLEO_APLICACAO, 0, 0},
+  {"entrada", PRIORIDADE_TAREFA_ENTRADA, NUCLEO_APLICACAO, PERIODO_TAREFA_ENTRADA_MS, 2048},
+  {"comunicacao", PRIORIDADE_TAREFA_COMUNICACAO, NUCLEO_RADIO, PERIODO_TAREFA_COMUNICACAO_MS, 4096},
+  {"casas", PRIORIDADE_TAREFA_CASAS, NUCLEO_APLICACAO, PERIODO_TAREFA_CASAS_MS, 2048},
+  {"som", PRIORIDADE_TAREFA_SOM, NUCLEO_APLICACAO, 0, 2048},
+};
+
+static EstatisticaTarefa estatisticas[QUANTIDADE_TAREFAS];
+static uint32_t esperas_iteracao_us = 0; //Tempo do loop() parado em EsperaBotoes, LeituraCasas e RecebeResposta
+static volatile uint32_t instantes_aperto_ms[DESLOCAMENTO_APERTOS]; //Começo do aperto atual de cada botão, já sem repique
+static uint32_t inicio_janela_us = 0;
+static Stream *radio = nullptr;
+
+static void ContaTrabalho(uint8_t tarefa, uint32_t tempo_us)
+{
+  estatisticas[tarefa].ocupado_us += tempo_us;
+  if(tempo_us > estatisticas[tarefa].maximo_us)
+    estatisticas[tarefa].maximo_us = tempo_us;
+}
+
+static void MarcaApertos(uint8_t apertados, uint32_t agora_ms)
+{
+  for(uint8_t i = 0; i < DESLOCAMENTO_APERTOS; i++)
+    if(apertados & (1 << i))
+      instantes_aperto_ms[i] = agora_ms;
+}
+
+uint32_t InstanteAperto(uint8_t botao)
+{
+  return instantes_aperto_ms[botao];
+}
+
+static bool TentaTravarRadio();
+
+//Com o loop() escrevendo ao host, o quadro fica para o próximo período, já com o estado de então
+static void EnviaTelemetria()
+{
+  if(!TelemetriaLigada() || TransporteConectado() == SEM_TRANSPORTE || !TentaTravarRadio())
+    return;
+
+  char quadro[TAMANHO_QUADRO_TELEMETRIA];
+  if(MontaQuadroTelemetria(millis(), quadro, sizeof(quadro)) > 0)
+    radio->println(quadro);
+
+  LiberaRadio();
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+static TaskHandle_t tarefas[QUANTIDADE_TAREFAS];
+static EventGroupHandle_t grupo_botoes = NULL;
+static QueueHandle_t fila_respostas = NULL;
+static QueueHandle_t fila_comandos = NULL;
+static QueueHandle_t caixa_casas = NULL;
+static QueueHandle_t fila_som = NULL;
+static SemaphoreHandle_t trava_radio = NULL; //Linhas inteiras ao host (o loop() e os quadros de telemetria) e trocas de cliente
+
+static void TrabalhoEntrada()
+{
+  static uint8_t aceitos = 0, candidatos = 0, repeticoes = 0;
+  uint8_t amostra = AmostraBotoes() & BITS_NIVEL_BOTOES;
+
+  if(amostra != candidatos)
+  {
+    candidatos = amostra;
+    repeticoes = 1;
+  }
+  else if(repeticoes < AMOSTRAS_REPIQUE_BOTOES)
+    repeticoes++;
+
+  if(repeticoes < AMOSTRAS_REPIQUE_BOTOES || candidatos == aceitos)
+    return;
+
+  uint8_t apertados = candidatos & ~aceitos;
+  aceitos = candidatos;
+  MarcaApertos(apertados, millis()); //Antes dos bits: o loop() acordado pelo aperto já vê o instante
+
+  xEventGroupClearBits(grupo_botoes, BITS_NIVEL_BOTOES & ~aceitos);
+  xEventGroupSetBits(grupo_botoes, aceitos | (apertados << DESLOCAMENTO_APERTOS));
+}
+
+static void EntregaQuadro(QueueHandle_t fila, const char *texto, uint8_t tamanho)
+{
+  QuadroRadio quadro;
+
+  memcpy(quadro.texto, texto, tamanho);
+  quadro.texto[tamanho] = '\0';
+  quadro.tamanho = tamanho;
+
+  if(xQueueSend(fila, &quadro, 0) != pdTRUE)
+    REGISTRA_AVISO("Comunicacao: fila cheia, quadro de %d bytes descartado", tamanho);
+}
+
+//"?relogio" é respondido aqui, com o instante em que chegou, sem esperar o loop(); com o loop() escrevendo ao host
+//a troca se perde e o host simplesmente faz outra
+static bool AtendeRelogio(const char *texto, uint8_t tamanho, uint64_t chegada_us)
+{
+  const uint8_t tamanho_nome = sizeof(COMANDO_RELOGIO) - 1;
+
+  if(tamanho < tamanho_nome || memcmp(texto, COMANDO_RELOGIO, tamanho_nome) != 0 ||
+     (tamanho > tamanho_nome && texto[tamanho_nome] != ' '))
+    return false;
+
+  char argumentos[TAMANHO_QUADRO_RADIO + 1];
+  uint8_t tamanho_argumentos = tamanho > tamanho_nome ? tamanho - tamanho_nome - 1 : 0;
+
+  memcpy(argumentos, texto + tamanho - tamanho_argumentos, tamanho_argumentos);
+  argumentos[tamanho_argumentos] = '\0';
+
+  if(TentaTravarRadio())
+  {
+    RespondeRelogio(argumentos, chegada_us, *radio);
+    LiberaRadio();
+  }
+
+  return true;
+}
+
+//Comandos vão até o '\n'; todo o resto é resposta do host e vai até o ']' (o mesmo que o readBytesUntil fazia)
+static void TrabalhoComunicacao()
+{
+  static char texto[TAMANHO_QUADRO_RADIO];
+  static uint8_t tamanho = 0;
+
+  //Aceitar ou fechar um cliente, trocar de transporte e ligar ou desligar um rádio mudam o stream por trás do canal:
+  //nunca no meio de uma linha do loop(). Com o loop() escrevendo ao host, a conferência fica para o próximo período
+  if(TentaTravarRadio())
+  {
+    VerificaClienteConectado();
+    LiberaRadio();
+  }
+
+  uint64_t chegada_us = radio->available() > 0 ? RelogioTabuleiroUs() : 0;
+
+  while(radio->available() > 0)
+  {
+    char caractere = radio->read();
+    bool comando = tamanho > 0 ? texto[0] == '?' : caractere == '?';
+    bool fim = caractere == (comando ? '\n' : ']');
+
+    if(!fim)
+      texto[tamanho++] = caractere;
+
+    if(fim || tamanho == TAMANHO_QUADRO_RADIO)
+    {
+      if(!comando || !AtendeRelogio(texto, tamanho, chegada_us))
+        EntregaQuadro(comando ? fila_comandos : fila_respostas, texto, tamanho);
+      tamanho = 0;
+    }
+  }
+
+  EnviaTelemetria();
+#if TIX_WIFI
+  AtendePainel(millis());
+#endif
+}
+
+static void TrabalhoCasas()
+{
+  VarreduraCasas varredura;
+
+  AmostraCasas(varredura.leituras);
+  varredura.tempo_ms = millis();
+  xQueueOverwrite(caixa_casas, &varredura);
+}
+
+static void ExecutaTarefaPeriodica(void *parametro)
+{
+  uint8_t tarefa = (uint8_t)(uintptr_t)parametro;
+  void (*trabalho)() = tarefa == TAREFA_ENTRADA ? TrabalhoEntrada : tarefa == TAREFA_COMUNICACAO ? TrabalhoComunicacao : TrabalhoCasas;
+  TickType_t ultimo_despertar = xTaskGetTickCount();
+
+  while(true)
+  {
+    uint32_t inicio_us = micros();
+    trabalho();
+    ContaTrabalho(tarefa, micros() - inicio_us);
+
+    vTaskDelayUntil(&ultimo_despertar, pdMS_TO_TICKS(descricoes[tarefa].periodo_ms));
+  }
+}
+
+static void ExecutaTarefaSom(void *parametro)
+{
+  void (*som)();
+
+  while(true)
+  {
+    if(xQueueReceive(fila_som, &som, portMAX_DELAY) != pdTRUE)
+      continue;
+
+    uint32_t inicio_us = micros();
+    som(); //Quase todo o tempo é delay(): a CPU da tarefa de som é o tempo tocando
+    ContaTrabalho(TAREFA_SOM, micros() - inicio_us);
+  }
+}
+
+static void CriaTarefa(uint8_t tarefa, TaskFunction_t funcao)
+{
+  const DescricaoTarefa &descricao = descricoes[tarefa];
+
+  if(xTaskCreatePinnedToCore(funcao, descricao.nome, descricao.pilha, (void *)(uintptr_t)tarefa, descricao.prioridade,
+                             &tarefas[tarefa], descricao.nucleo) == pdPASS)
+    MonitoraPilhaTarefa(descricao.nome, tarefas[tarefa]);
+  else
+    REGISTRA_TEXTO_AVISO("Tarefa %s nao foi criada", descricao.nome);
+}
+
+#endif
+
+void IniciaTarefas(Stream &canal)
+{
+  radio = &canal;
+  inicio_janela_us = micros();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  tarefas[TAREFA_LOOP] = xTaskGetCurrentTaskHandle();
+
+  grupo_botoes = xEventGroupCreate();
+  fila_respostas = xQueueCreate(CAPACIDADE_FILA_RESPOSTAS, sizeof(QuadroRadio));
+  fila_comandos = xQueueCreate(CAPACIDADE_FILA_COMANDOS, sizeof(QuadroRadio));
+  caixa_casas = xQueueCreate(1, sizeof(VarreduraCasas));
+  fila_som = xQueueCreate(CAPACIDADE_FILA_SOM, sizeof(void (*)()));
+  trava_radio = xSemaphoreCreateMutex();
+
+  if(!grupo_botoes || !fila_respostas || !fila_comandos || !caixa_casas || !fila_som || !trava_radio)
+  {
+    REGISTRA_ERRO("Tarefas: sem memoria para filas, tudo continua no loop()");
+    grupo_botoes = NULL;
+    fila_respostas = fila_comandos = caixa_casas = fila_som = NULL;
+    trava_radio = NULL;
+    return;
+  }
+
+  CriaTarefa(TAREFA_ENTRADA, ExecutaTarefaPeriodica);
+  CriaTarefa(TAREFA_COMUNICACAO, ExecutaTarefaPeriodica);
+  CriaTarefa(TAREFA_CASAS, ExecutaTarefaPeriodica);
+  CriaTarefa(TAREFA_SOM, ExecutaTarefaSom);
+#endif
+}
+
+uint8_t EsperaBotoes(uint32_t espera_ms)
+{
+  uint32_t inicio_us = micros();
+
+#if defined(ARDUINO_ARCH_ESP32)
+  if(grupo_botoes)
+  {
+    if(espera_ms > 0) //Acorda antes se um botão for apertado
+      xEventGroupWaitBits(grupo_botoes, BITS_APERTOS_BOTOES, pdFALSE, pdFALSE, pdMS_TO_TICKS(espera_ms));
+    esperas_iteracao_us += micros() - inicio_us;
+
+    EventBits_t bits = xEventGroupClearBits(grupo_botoes, BITS_APERTOS_BOTOES); //Devolve os bits de antes de apagar
+    return (bits | (bits >> DESLOCAMENTO_APERTOS)) & BITS_NIVEL_BOTOES;
+  }
+#endif
+
+  static uint8_t amostrados = 0;
+
+  delay(espera_ms);
+  esperas_iteracao_us += micros() - inicio_us;
+
+  uint8_t acionados = AmostraBotoes();
+  MarcaApertos(acionados & ~amostrados, millis()); //Sem a tarefa de entrada, o aperto é visto na amostra
+  amostrados = acionados;
+  return acionados;
+}
+
+uint32_t LeituraCasas(uint16_t leituras[QUANTIDADE_CASAS])
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(caixa_casas)
+  {
+    VarreduraCasas varredura;
+    uint32_t inicio_us = micros();
+    bool recebida = xQueueReceive(caixa_casas, &varredura, pdMS_TO_TICKS(2 * PERIODO_TAREFA_CASAS_MS)) == pdTRUE;
+    esperas_iteracao_us += micros() - inicio_us;
+
+    if(recebida) //Lida há no máximo um período: a caixa é sobrescrita a cada varredura
+    {
+      memcpy(leituras, varredura.leituras, sizeof(varredura.leituras));
+      return varredura.tempo_ms;
+    }
+  }
+#endif
+
+  AmostraCasas(leituras);
+  return millis();
+}
+
+size_t RecebeResposta(char terminador, char *destino, size_t tamanho)
+{
+  uint32_t inicio_us = micros();
+  size_t recebidos = 0;
+
+#if defined(ARDUINO_ARCH_ESP32)
+  if(fila_respostas) //A tarefa de comunicação já separou o quadro no ']'
+  {
+    QuadroRadio quadro;
+
+    if(xQueueReceive(fila_respostas, &quadro, pdMS_TO_TICKS(TEMPO_LIMITE_RESPOSTA_MS)) == pdTRUE)
+    {
+      recebidos = quadro.tamanho < tamanho ? quadro.tamanho : tamanho;
+      memcpy(destino, quadro.texto, recebidos);
+    }
+
+    esperas_iteracao_us += micros() - inicio_us;
+    return recebidos;
+  }
+#endif
+
+  if(radio)
+    recebidos = radio->readBytesUntil(terminador, destino, tamanho);
+
+  esperas_iteracao_us += micros() - inicio_us;
+  return recebidos;
+}
+
+void AtendeRadio()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(fila_comandos)
+  {
+    QuadroRadio quadro;
+
+    if(xQueueReceive(fila_comandos, &quadro, 0) == pdTRUE)
+    {
+      TravaRadio(); //A resposta inteira antes do próximo quadro de telemetria
+      ExecutaComando(quadro.texto, *radio);
+      LiberaRadio();
+    }
+    return;
+  }
+#endif
+
+  VerificaClienteConectado();
+#if TIX_WIFI
+  AtendePainel(millis()); //Também sem o host conectado
+#endif
+  if(!radio)
+    return;
+
+  static EntradaComandos entrada = {};
+  ProcessaComandos(*radio, entrada, false);
+  EnviaTelemetria();
+}
+
+uint8_t TarefaAtual()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(!tarefas[TAREFA_LOOP]) //Antes de IniciaTarefas só há o setup()
+    return TAREFA_LOOP;
+
+  TaskHandle_t atual = xTaskGetCurrentTaskHandle();
+  for(uint8_t i = 0; i < QUANTIDADE_TAREFAS; i++)
+    if(tarefas[i] == atual)
+      return i;
+
+  return QUANTIDADE_TAREFAS;
+#else
+  return TAREFA_LOOP;
+#endif
+}
+
+static bool TentaTravarRadio()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  return !trava_radio || xSemaphoreTake(trava_radio, 0) == pdTRUE;
+#else
+  return true;
+#endif
+}
+
+void TravaRadio()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(trava_radio)
+    xSemaphoreTake(trava_radio, portMAX_DELAY);
+#endif
+}
+
+void LiberaRadio()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(trava_radio)
+    xSemaphoreGive(trava_radio);
+#endif
+}
+
+bool DelegaSom(void (*som)())
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if(!fila_som || xTaskGetCurrentTaskHandle() == tarefas[TAREFA_SOM])
+    return false;
+
+  xQueueSend(fila_som, &som, 0); //Com a fila cheia o som é perdido, mas o loop() não espera
+  return true;
+#else
+  return false;
+#endif
+}
+
+void ContaIteracaoLoop(uint32_t duracao_us)
+{
+  ContaTrabalho(TAREFA_LOOP, duracao_us > esperas_iteracao_us ? duracao_us - esperas_iteracao_us : 0);
+  esperas_iteracao_us = 0;
+
+  uint32_t agora_us = micros();
+  uint32_t janela_us = agora_us - inicio_janela_us;
+  if(janela_us < 1000000UL)
+    return;
+
+  for(uint8_t i = 0; i < QUANTIDADE_TAREFAS; i++)
+  {
+    uint32_t ocupado_us = estatisticas[i].ocupado_us;
+    estatisticas[i].cpu_permil = (uint32_t)((uint64_t)(ocupado_us - estatisticas[i].ocupado_inicio_janela_us) * 1000 / janela_us);
+    estatisticas[i].ocupado_inicio_janela_us = ocupado_us;
+  }
+  inicio_janela_us = agora_us;
+}
+
+ResumoTarefa ResumeTarefa(uint8_t tarefa)
+{
+  ResumoTarefa resumo;
+
+  resumo.nome = descricoes[tarefa].nome;
+  resumo.prioridade = descricoes[tarefa].prioridade;
+#if defined(ARDUINO_ARCH_ESP32)
+  resumo.nucleo = tarefas[tarefa] ? descricoes[tarefa].nucleo : -1;
+#else
+  resumo.nucleo = -1;
+#endif
+  resumo.cpu_permil = estatisticas[tarefa].cpu_permil;
+  resumo.maximo_us = estatisticas[tarefa].maximo_us;
+
+  return resumo;
+}
+
+void EscreveTarefas(Print &saida)
+{
+  char texto[128];
+
+  saida.print("{");
+  for(uint8_t i = 0; i < QUANTIDADE_TAREFAS; i++)
+  {
+    ResumoTarefa resumo = ResumeTarefa(i);
+
+    snprintf(texto, sizeof(texto), "%s\"%s\": {\"prioridade\": %u, \"nucleo\": %d, \"cpu_permil\": %lu, \"max_us\": %lu}",
+             i == 0 ? "" : ", ", resumo.nome, resumo.prioridade, resumo.nucleo, (unsigned long)resumo.cpu_permil,
+             (unsigned long)resumo.maximo_us);
+    saida.print(texto);
+  }
+  saida.println("}");
+}
+
+void LimpaTarefas()
+{
+  for(uint8_t i = 0; i < QUANTIDADE_TAREFAS; i++)
+    estatisticas[i].maximo_us = 0;
+}
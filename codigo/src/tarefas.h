@@ -0,0 +1,81 @@
+//Tarefas do FreeRTOS: entrada (botões), comunicação (rádio), casas (ADC) e som
+//
+//O loop() continua sendo a máquina de estados dos menus e o único dono do LCD, mas deixa de fazer o trabalho que
+//bloqueava tudo atrás dele:
+//- entrada: amostra os botões a cada PERIODO_TAREFA_ENTRADA_MS, com filtro de repique, num grupo de eventos. Um
+//  aperto dado enquanto o loop() está ocupado (LCD, espera do host) fica guardado até o próximo LeBotoes(), que
+//  também acorda assim que um botão novo é apertado, sem esperar o fim do ESPERA_BOTOES_MS;
+//- comunicação: no núcleo do rádio, confere a conexão com o rádio travado (um cliente aceito ou fechado, ou um rádio
+//  ligado ou desligado, nunca cai no meio de uma linha do loop()) e separa o que chega em quadros: respostas do host
+//  ("[...]") numa fila, comandos de diagnóstico ("?...") em outra, atendidos pelo loop(); envia também os quadros de
+//  telemetria (telemetria.h), sem intercalá-los com as linhas que o loop() escreve entre TravaRadio e LiberaRadio;
+//- casas: varre o ADC das oito casas a cada PERIODO_TAREFA_CASAS_MS e deixa a última varredura numa caixa (fila de
+//  uma posição) com o instante da leitura;
+//- som: toca as melodias, com os seus delay(), enfileiradas pelas funções Som...().
+//
+//O tempo de CPU de cada tarefa (trabalho de cada período) e o do loop() (iteração menos as esperas acima) são
+//acumulados e a cada segundo viram um percentual, respondido pelo comando "?tarefas". Fora do ESP32 não há
+//tarefas: cada chamada faz o trabalho na hora, como antes, e o simulador continua determinístico.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Stream.h>
+#include "tabuleiro.h"
+
+#define TAREFA_LOOP 0
+#define TAREFA_ENTRADA 1
+#define TAREFA_COMUNICACAO 2
+#define TAREFA_CASAS 3
+#define TAREFA_SOM 4
+#define QUANTIDADE_TAREFAS 5
+
+//Prioridades do FreeRTOS: o loop() do Arduino roda com 1 e a tarefa de registro com 0
+#define PRIORIDADE_TAREFA_ENTRADA 5
+#define PRIORIDADE_TAREFA_COMUNICACAO 4
+#define PRIORIDADE_TAREFA_CASAS 2
+#define PRIORIDADE_TAREFA_SOM 2
+
+#define NUCLEO_RADIO 0 //PRO_CPU, onde rodam as pilhas Bluetooth e WiFi
+#define NUCLEO_APLICACAO 1 //APP_CPU, o mesmo do loop()
+
+#define PERIODO_TAREFA_ENTRADA_MS 5
+#define PERIODO_TAREFA_COMUNICACAO_MS 5
+#define PERIODO_TAREFA_CASAS_MS 5
+#define AMOSTRAS_REPIQUE_BOTOES 2 //Amostras iguais seguidas para aceitar a mudança de um botão
+
+#define TAMANHO_MAXIMO_MENSAGEM 120 //Maior mensagem trocada com o host: o lance, com a sequência, os dois instantes em us e os dois tempos em ms (109)
+#define TAMANHO_QUADRO_RADIO TAMANHO_MAXIMO_MENSAGEM //Sem o ']' ou o '\n' que fecham o quadro
+#define CAPACIDADE_FILA_RESPOSTAS 4
+#define CAPACIDADE_FILA_COMANDOS 2
+#define CAPACIDADE_FILA_SOM 4
+#define TEMPO_LIMITE_RESPOSTA_MS 1000 //Mesmo tempo limite do readBytesUntil do Stream
+
+struct ResumoTarefa
+{
+  const char *nome;
+  uint8_t prioridade;
+  int8_t nucleo; //-1 fora do ESP32 ou sem afinidade
+  uint32_t cpu_permil; //Último segundo, em milésimos do tempo de um núcleo
+  uint32_t maximo_us; //Trabalho mais longo de um período (do loop(), a iteração mais longa sem as esperas)
+};
+
+//Definidas pelo firmware (main.cpp): o trabalho de cada período das tarefas
+uint8_t AmostraBotoes(); //Bit i aceso se o botão i está apertado agora
+void AmostraCasas(uint16_t leituras[QUANTIDADE_CASAS]);
+void VerificaClienteConectado();
+
+void IniciaTarefas(Stream &radio); //No fim do setup(); antes disso cada chamada faz o trabalho na hora
+uint8_t EsperaBotoes(uint32_t espera_ms); //Botões apertados agora ou desde a última chamada, depois da espera
+uint32_t InstanteAperto(uint8_t botao); //millis() do começo do aperto atual (ou do último) do botão, para repetir ao segurar
+uint32_t LeituraCasas(uint16_t leituras[QUANTIDADE_CASAS]); //Varredura nova das casas, devolve o instante em ms
+size_t RecebeResposta(char terminador, char *destino, size_t tamanho); //0 se o tempo limite esgotou
+void AtendeRadio(); //Comando "?..." recebido pelo rádio, se houver; sem a tarefa, confere também a conexão e envia a telemetria
+uint8_t TarefaAtual(); //TAREFA_... de quem chama; QUANTIDADE_TAREFAS fora delas (pilhas dos rádios, temporizadores)
+void TravaRadio(); //Antes de escrever uma linha ao host pelo loop()
+void LiberaRadio();
+bool DelegaSom(void (*som)()); //true se o som foi enfileirado para a tarefa de som; false: toque na hora
+void ContaIteracaoLoop(uint32_t duracao_us); //Chamada por FimIteracao()
+ResumoTarefa ResumeTarefa(uint8_t tarefa);
+void EscreveTarefas(Print &saida); //Resposta JSON do comando "?tarefas"
+void LimpaTarefas();
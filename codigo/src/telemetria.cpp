@@ -0,0 +1,203 @@
+#include "telemetria.h"
+#include "conexao.h"
+#include "registro.h"
+
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+
+static portMUX_TYPE trava_publicacao = portMUX_INITIALIZER_UNLOCKED; //O loop() e a tarefa de comunicação, em núcleos diferentes
+#define TRAVA_PUBLICACAO() portENTER_CRITICAL(&trava_publicacao)
+#define LIBERA_PUBLICACAO() portEXIT_CRITICAL(&trava_publicacao)
+#else
+#define TRAVA_PUBLICACAO()
+#define LIBERA_PUBLICACAO()
+#endif
+
+static std::atomic<uint32_t> periodo_ms{0}; //0: desligada
+static std::atomic<bool> chave_pedida{false};
+static std::atomic<bool> publicacao_pedida{false}; //Pelo painel
+static uint32_t frequencia_hz = 0;
+
+//Escritos pelo loop(), sob a trava
+static EstadoTelemetria publicado;
+static uint32_t instante_publicacao_ms = 0;
+static bool ha_publicacao = false;
+
+//Só da tarefa de comunicação: o último quadro enviado
+static EstadoTelemetria enviado;
+static bool ha_enviado = false;
+static uint32_t instante_quadro_ms = 0;
+static uint32_t instante_chave_ms = 0;
+static uint32_t geracao_enviada = 0;
+
+bool TelemetriaLigada()
+{
+  return periodo_ms.load(std::memory_order_relaxed) != 0;
+}
+
+bool PublicacaoLigada()
+{
+  return TelemetriaLigada() || publicacao_pedida.load(std::memory_order_relaxed);
+}
+
+void PedePublicacao(bool pedida)
+{
+  publicacao_pedida.store(pedida, std::memory_order_relaxed);
+}
+
+uint32_t CompactaTabuleiro(const EstadoTabuleiro &tabuleiro)
+{
+  uint32_t compactado = 0;
+
+  for(uint8_t i = 0; i < QUANTIDADE_CASAS; i++)
+    compactado |= (uint32_t)(tabuleiro[i] & 0x0F) << (4 * i);
+
+  return compactado;
+}
+
+void PublicaTelemetria(const EstadoTelemetria &estado, uint32_t agora_ms)
+{
+  if(!PublicacaoLigada())
+    return;
+
+  TRAVA_PUBLICACAO();
+  publicado = estado;
+  instante_publicacao_ms = agora_ms;
+  ha_publicacao = true;
+  LIBERA_PUBLICACAO();
+}
+
+static uint8_t CamposMudados(const EstadoTelemetria &atual, const EstadoTelemetria &anterior)
+{
+  uint8_t campos = 0;
+
+  if(atual.tempo_brancas_ms != anterior.tempo_brancas_ms)
+    campos |= CAMPO_TEMPO_BRANCAS;
+  if(atual.tempo_pretas_ms != anterior.tempo_pretas_ms)
+    campos |= CAMPO_TEMPO_PRETAS;
+  if(atual.vez_brancas != anterior.vez_brancas)
+    campos |= CAMPO_VEZ;
+  if(atual.tabuleiro != anterior.tabuleiro)
+    campos |= CAMPO_TABULEIRO;
+  if(atual.lance_pendente != anterior.lance_pendente)
+    campos |= CAMPO_PENDENTE;
+  if(atual.relogio_correndo != anterior.relogio_correndo)
+    campos |= CAMPO_RELOGIO;
+
+  return campos;
+}
+
+static void AcrescentaValor(char *destino, size_t tamanho, size_t &escritos, long valor)
+{
+  if(escritos < tamanho)
+    escritos += snprintf(destino + escritos, tamanho - escritos, ", %ld", valor);
+}
+
+bool LeEstadoPublicado(uint32_t agora_ms, EstadoTelemetria &estado)
+{
+  uint32_t instante_ms;
+  bool ha;
+
+  TRAVA_PUBLICACAO();
+  estado = publicado;
+  instante_ms = instante_publicacao_ms;
+  ha = ha_publicacao;
+  LIBERA_PUBLICACAO();
+
+  if(!ha)
+    return false;
+
+  if(!estado.em_partida)
+    estado.relogio_correndo = false;
+  else if(estado.relogio_correndo) //O relógio da vez continuou correndo desde a publicação
+  {
+    uint32_t decorrido = agora_ms - instante_ms;
+    if(decorrido > estado.folga_relogio_ms)
+      decorrido = estado.folga_relogio_ms;
+
+    uint32_t &tempo_vez = estado.vez_brancas ? estado.tempo_brancas_ms : estado.tempo_pretas_ms;
+    tempo_vez = tempo_vez > decorrido ? tempo_vez - decorrido : 0;
+  }
+
+  return true;
+}
+
+size_t MontaQuadroTelemetria(uint32_t agora_ms, char *destino, size_t tamanho)
+{
+  uint32_t periodo = periodo_ms.load(std::memory_order_relaxed);
+  if(!periodo)
+    return 0;
+
+  EstadoTelemetria atual;
+
+  if(!LeEstadoPublicado(agora_ms, atual) || (!atual.em_partida && !ha_enviado))
+    return 0;
+
+  uint32_t geracao = GeracaoConexao();
+  bool chave = atual.em_partida && (chave_pedida.exchange(false, std::memory_order_relaxed) || !ha_enviado || geracao != geracao_enviada ||
+                                    agora_ms - instante_chave_ms >= PERIODO_QUADRO_CHAVE_MS);
+  uint8_t campos = chave ? CAMPO_TEMPO_BRANCAS | CAMPO_TEMPO_PRETAS | CAMPO_VEZ | CAMPO_TABULEIRO | CAMPO_PENDENTE | CAMPO_RELOGIO | CAMPO_CHAVE
+                         : CamposMudados(atual, enviado);
+
+  if(!chave)
+  {
+    uint32_t desde_quadro = agora_ms - instante_quadro_ms;
+    bool evento = campos & (CAMPO_VEZ | CAMPO_TABULEIRO | CAMPO_PENDENTE | CAMPO_RELOGIO); //Sai sem esperar o período
+
+    if(!campos || desde_quadro < INTERVALO_MINIMO_TELEMETRIA_MS || (!evento && desde_quadro < periodo))
+      return 0;
+  }
+
+  size_t escritos = snprintf(destino, tamanho, "[\"t\", %u", (unsigned)campos);
+
+  if(campos & CAMPO_TEMPO_BRANCAS)
+    AcrescentaValor(destino, tamanho, escritos, chave ? (long)atual.tempo_brancas_ms : (long)atual.tempo_brancas_ms - (long)enviado.tempo_brancas_ms);
+  if(campos & CAMPO_TEMPO_PRETAS)
+    AcrescentaValor(destino, tamanho, escritos, chave ? (long)atual.tempo_pretas_ms : (long)atual.tempo_pretas_ms - (long)enviado.tempo_pretas_ms);
+  if(campos & CAMPO_VEZ)
+    AcrescentaValor(destino, tamanho, escritos, atual.vez_brancas);
+  if(campos & CAMPO_TABULEIRO)
+    AcrescentaValor(destino, tamanho, escritos, (long)CompactaTabuleiro(atual.tabuleiro));
+  if(campos & CAMPO_PENDENTE)
+    AcrescentaValor(destino, tamanho, escritos, atual.lance_pendente);
+  if(campos & CAMPO_RELOGIO)
+    AcrescentaValor(destino, tamanho, escritos, atual.relogio_correndo);
+
+  if(escritos + 1 >= tamanho) //Não acontece com TAMANHO_QUADRO_TELEMETRIA; um quadro cortado dessincronizaria o host
+    return 0;
+  destino[escritos++] = ']';
+  destino[escritos] = '\0';
+
+  enviado = atual;
+  ha_enviado = true;
+  instante_quadro_ms = agora_ms;
+  if(chave)
+  {
+    instante_chave_ms = agora_ms;
+    geracao_enviada = geracao;
+  }
+
+  return escritos;
+}
+
+void ConfiguraTelemetria(const char *argumentos, Print &saida)
+{
+  if(*argumentos)
+  {
+    uint32_t hz = strtoul(argumentos, nullptr, 10);
+    frequencia_hz = hz < TELEMETRIA_MAXIMA_HZ ? hz : TELEMETRIA_MAXIMA_HZ;
+
+    chave_pedida.store(true, std::memory_order_relaxed); //O host recomeça do zero
+    periodo_ms.store(frequencia_hz ? 1000 / frequencia_hz : 0, std::memory_order_relaxed);
+    REGISTRA_INFO("Telemetria: %d Hz", (int32_t)frequencia_hz);
+  }
+
+  char texto[64];
+  snprintf(texto, sizeof(texto), "{\"telemetria_hz\": %lu, \"periodo_ms\": %lu}", (unsigned long)frequencia_hz,
+           (unsigned long)periodo_ms.load(std::memory_order_relaxed));
+  saida.println(texto);
+}
@@ -0,0 +1,56 @@
+//Telemetria da partida para as telas do host: relógios em ms, vez, casas e lance pendente, num ritmo configurável
+//
+//O loop() publica o estado (PublicaTelemetria) a cada varredura das casas e a cada iteração; a tarefa de
+//comunicação monta os quadros no núcleo do rádio, também enquanto o loop() espera a resposta de um lance. O relógio
+//da vez é estendido do instante da publicação até o do quadro, sem passar do segundo que o loop() ainda não
+//descontou.
+//
+//Quadro: ["t", campos, valores...], um valor por bit aceso em campos, na ordem dos bits. Cada quadro leva só os
+//campos que mudaram desde o anterior, e os relógios como diferença em ms ("["t", 1, -100]": as brancas gastaram
+//100 ms). A cada PERIODO_QUADRO_CHAVE_MS, e depois de cada reconexão, vai um quadro-chave (CAMPO_CHAVE) com todos os
+//campos em valor absoluto. Uma mudança de vez, casa ou lance pendente sai assim que aparece, sem esperar o período.
+//
+//Desligada por padrão; o host liga com "?telemetria <hz>" (0 desliga). Fora de uma partida nada é enviado, além do
+//quadro que para o relógio. O painel da página (painel.h) lê o mesmo estado publicado: com espectadores conectados o
+//loop() publica mesmo com a telemetria do host desligada.
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Print.h>
+#include "tabuleiro.h"
+
+#define TELEMETRIA_MAXIMA_HZ 50
+#define INTERVALO_MINIMO_TELEMETRIA_MS 20 //Entre dois quadros, mesmo com uma mudança de casa ou de vez
+#define PERIODO_QUADRO_CHAVE_MS 1000
+#define TAMANHO_QUADRO_TELEMETRIA 72 //["t", 127, 4294967295, 4294967295, 1, 4294967295, 1, 1]
+
+//Bits de campos, na ordem dos valores no quadro
+#define CAMPO_TEMPO_BRANCAS 0x01
+#define CAMPO_TEMPO_PRETAS 0x02
+#define CAMPO_VEZ 0x04 //1 brancas, 0 pretas
+#define CAMPO_TABULEIRO 0x08 //4 bits por casa (a Peca), casa 0 nos bits menos significativos
+#define CAMPO_PENDENTE 0x10 //1 enquanto um lance espera a resposta do host
+#define CAMPO_RELOGIO 0x20 //1 com o relógio da vez correndo
+#define CAMPO_CHAVE 0x40 //Sem valor: quadro-chave, relógios em valor absoluto
+
+struct EstadoTelemetria
+{
+  bool em_partida;
+  bool relogio_correndo;
+  bool vez_brancas;
+  bool lance_pendente;
+  uint32_t tempo_brancas_ms; //No instante da publicação
+  uint32_t tempo_pretas_ms;
+  uint16_t folga_relogio_ms; //Quanto o relógio da vez ainda pode correr antes do próximo segundo descontado
+  EstadoTabuleiro tabuleiro;
+};
+
+bool TelemetriaLigada();
+bool PublicacaoLigada(); //Telemetria ligada ou espectadores no painel
+void PedePublicacao(bool pedida); //Do painel, enquanto ele tem espectadores
+uint32_t CompactaTabuleiro(const EstadoTabuleiro &tabuleiro);
+void PublicaTelemetria(const EstadoTelemetria &estado, uint32_t agora_ms); //Do loop(); sem custo com a publicação desligada
+bool LeEstadoPublicado(uint32_t agora_ms, EstadoTelemetria &estado); //Com o relógio da vez estendido até agora_ms; false sem publicação
+size_t MontaQuadroTelemetria(uint32_t agora_ms, char *destino, size_t tamanho); //Da tarefa de comunicação; 0: nada a enviar agora
+void ConfiguraTelemetria(const char *argumentos, Print &saida); //Resposta JSON do comando "?telemetria [hz]"
@@ -0,0 +1,29 @@
+//Transportes do firmware, escolhidos na compilação
+//
+//Um só main.cpp gera as três variantes: -DTIX_TRANSPORTES=TRANSPORTES_BLUETOOTH (padrão), TRANSPORTES_WIFI ou
+//TRANSPORTES_BLUETOOTH_WIFI. O que depende de um rádio fica entre #if TIX_BLUETOOTH / #if TIX_WIFI, de forma que a
+//pilha do rádio que não entra na variante nem é incluída: a imagem fica menor, sobra RAM e o setup() não inicia o
+//rádio à toa. Com os dois rádios, o gerenciador de conexão (conexao.h) desliga o que não está em uso, sempre com o
+//rádio travado (tarefas.h), fora das linhas que o loop() escreve ao host.
+#pragma once
+
+#include <stdint.h>
+#include "latencia.h"
+
+#define TRANSPORTES_BLUETOOTH (1 << TRANSPORTE_BLUETOOTH)
+#define TRANSPORTES_WIFI (1 << TRANSPORTE_WIFI)
+#define TRANSPORTES_BLUETOOTH_WIFI (TRANSPORTES_BLUETOOTH | TRANSPORTES_WIFI)
+
+#ifndef TIX_TRANSPORTES
+#define TIX_TRANSPORTES TRANSPORTES_BLUETOOTH
+#endif
+
+#define TIX_BLUETOOTH ((TIX_TRANSPORTES & TRANSPORTES_BLUETOOTH) != 0)
+#define TIX_WIFI ((TIX_TRANSPORTES & TRANSPORTES_WIFI) != 0)
+
+#if !TIX_BLUETOOTH && !TIX_WIFI
+#error TIX_TRANSPORTES sem nenhum transporte
+#endif
+
+constexpr uint8_t TRANSPORTES_FIRMWARE = TIX_TRANSPORTES;
+constexpr uint8_t TRANSPORTE_PADRAO = TIX_BLUETOOTH ? TRANSPORTE_BLUETOOTH : TRANSPORTE_WIFI; //Sem cliente conectado
@@ -0,0 +1,9 @@
+"""Imprime a flag de compilação com o commit atual, usada pelo platformio.ini (build_flags = !python versao_git.py)."""
+import subprocess
+
+try:
+    versao = subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], stderr=subprocess.DEVNULL).decode().strip()
+except Exception:
+    versao = 'desconhecida'
+
+print(f'-DTIX_VERSAO=\\"{versao}\\"')